@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Allocator.h"
+
+AllocatorArena::Storage::Storage(const size_t blockSize) :
+m_references(1),
+m_blockSize(blockSize),
+m_cur(NULL),
+m_end(NULL),
+m_allocatedBytes(0) {
+    assert(m_blockSize > 0);
+}
+
+AllocatorArena::Storage::~Storage() {
+    for (unsigned char* block : m_blocks)
+        delete [] block;
+}
+
+void* AllocatorArena::Storage::allocate(const size_t size, const size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    
+    const size_t misalignment = reinterpret_cast<size_t>(m_cur) & (alignment - 1);
+    const size_t padding = misalignment > 0 ? alignment - misalignment : 0;
+    if (m_cur == NULL || static_cast<size_t>(m_end - m_cur) < padding + size) {
+        // blocks from new[] are suitably aligned for any fundamental type
+        const size_t blockSize = std::max(m_blockSize, size);
+        m_cur = new unsigned char[blockSize];
+        m_end = m_cur + blockSize;
+        m_blocks.push_back(m_cur);
+    } else {
+        m_cur += padding;
+    }
+    
+    unsigned char* result = m_cur;
+    m_cur += size;
+    m_allocatedBytes += size;
+    return result;
+}
+
+void AllocatorArena::Storage::acquire() {
+    m_references.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocatorArena::Storage::release() {
+    if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+size_t AllocatorArena::Storage::allocatedBytes() const {
+    return m_allocatedBytes;
+}
+
+AllocatorArena::Scope::Scope(AllocatorArena& arena) :
+m_previous(currentStorage()) {
+    currentStorage() = arena.m_storage;
+}
+
+AllocatorArena::Scope::~Scope() {
+    currentStorage() = m_previous;
+}
+
+AllocatorArena::AllocatorArena(const size_t blockSize) :
+m_storage(new Storage(blockSize)) {}
+
+AllocatorArena::~AllocatorArena() {
+    // the memory is freed once the last object created in this arena is deleted
+    m_storage->release();
+}
+
+size_t AllocatorArena::allocatedBytes() const {
+    return m_storage->allocatedBytes();
+}
+
+AllocatorArena::Storage* AllocatorArena::current() {
+    return currentStorage();
+}
+
+AllocatorArena::Storage*& AllocatorArena::currentStorage() {
+    static thread_local Storage* storage = NULL;
+    return storage;
+}
@@ -20,181 +20,201 @@
 #ifndef TrenchBroom_Allocator_h
 #define TrenchBroom_Allocator_h
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <iostream>
-#include <limits>
-#include <stack>
+#include <cstddef>
+#include <mutex>
 #include <vector>
 
 // Undefine this to prevent false positives when looking for memory leaks.
 #define TB_ENABLE_ALLOCATOR 1
 
-template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+/**
+ Contiguous memory for objects that are deleted together, such as the geometry of a brush or of a whole batch of
+ brushes. While a scope is active on a thread, all objects that derive from Allocator and that are created on that
+ thread are placed into the arena by bumping a pointer. Deleting such an object does not make its memory available
+ again; instead, the arena's memory is freed all at once when the arena and all objects created in it are gone.
+
+ An arena may only be used by one thread at a time, but the objects created in it may be deleted on any thread.
+ */
+class AllocatorArena {
+public:
+    class Storage {
+    private:
+        std::atomic<size_t> m_references;
+        size_t m_blockSize;
+        std::vector<unsigned char*> m_blocks;
+        unsigned char* m_cur;
+        unsigned char* m_end;
+        size_t m_allocatedBytes;
+    public:
+        Storage(size_t blockSize);
+        ~Storage();
+
+        void* allocate(size_t size, size_t alignment);
+        void acquire();
+        void release();
+
+        size_t allocatedBytes() const;
+    private:
+        Storage(const Storage& other);
+        Storage& operator=(const Storage& other);
+    };
+
+    class Scope {
+    private:
+        Storage* m_previous;
+    public:
+        Scope(AllocatorArena& arena);
+        ~Scope();
+    };
+
+    static const size_t DefaultBlockSize = 64 * 1024;
+private:
+    Storage* m_storage;
+public:
+    AllocatorArena(size_t blockSize = DefaultBlockSize);
+    ~AllocatorArena();
+
+    size_t allocatedBytes() const;
+
+    static Storage* current();
+private:
+    static Storage*& currentStorage();
+
+    AllocatorArena(const AllocatorArena& other);
+    AllocatorArena& operator=(const AllocatorArena& other);
+};
+
+/**
+ Pooled allocation for small objects of type T, which must derive from this class.
+
+ Freed blocks are kept in a cache that is local to the thread that freed them, so that allocations and deallocations
+ normally do not need any synchronization. If a thread's cache runs empty or overflows, a batch of blocks is moved
+ from or to a pool that is shared by all threads. Freed blocks are reused by all threads, but the chunks they are
+ carved from are never freed: once allocated, the memory stays reserved for objects of type T until the process
+ exits, even if all such objects have been deleted.
+
+ Every block is preceded by a small header which records whether the block belongs to an arena (see AllocatorArena).
+ */
+template <class T, size_t CacheSize = 256, size_t BlocksPerChunk = 256>
 class Allocator {
 private:
-    class Chunk {
+    // Chunks are only ever added. Freed blocks return to the free list, but their memory is never released.
+    class SharedPool {
     private:
-        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
-        unsigned char m_firstFreeBlock;
-        unsigned char m_numFreeBlocks;
+        std::mutex m_mutex;
+        std::vector<unsigned char*> m_freeBlocks;
+        std::vector<unsigned char*> m_chunks;
     public:
-        Chunk() :
-        m_firstFreeBlock(0),
-        m_numFreeBlocks(BlocksPerChunk - 1) {
-            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
-                m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
+        void take(std::vector<unsigned char*>& blocks, const size_t count) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_freeBlocks.empty())
+                allocateChunk();
+
+            const size_t n = std::min(count, m_freeBlocks.size());
+            blocks.insert(std::end(blocks), std::end(m_freeBlocks) - static_cast<std::ptrdiff_t>(n), std::end(m_freeBlocks));
+            m_freeBlocks.resize(m_freeBlocks.size() - n);
+        }
+
+        void give(std::vector<unsigned char*>& blocks, const size_t count) {
+            assert(count <= blocks.size());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeBlocks.insert(std::end(m_freeBlocks), std::end(blocks) - static_cast<std::ptrdiff_t>(count), std::end(blocks));
+            blocks.resize(blocks.size() - count);
         }
-        
-        bool contains(const T* t) const {
-            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
-            if (block < m_blocks)
-                return false;
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            return offset < (BlocksPerChunk - 1) * sizeof(T);
+    private:
+        void allocateChunk() {
+            unsigned char* chunk = new unsigned char[BlocksPerChunk * blockSize()];
+            m_chunks.push_back(chunk);
+
+            m_freeBlocks.reserve(m_freeBlocks.size() + BlocksPerChunk);
+            for (size_t i = 0; i < BlocksPerChunk; ++i)
+                m_freeBlocks.push_back(chunk + (BlocksPerChunk - i - 1) * blockSize());
         }
-        
-        T* allocate() {
-            if (m_numFreeBlocks == 0)
-                return NULL;
-            
-            unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
-            m_firstFreeBlock = *block;
-            m_numFreeBlocks--;
-            return reinterpret_cast<T*>(block);
+    };
+
+    class ThreadCache {
+    private:
+        std::vector<unsigned char*> m_freeBlocks;
+    public:
+        ThreadCache() {
+            m_freeBlocks.reserve(CacheSize);
         }
-        
-        void deallocate(T* t) {
-            assert(m_numFreeBlocks < BlocksPerChunk - 1);
-            assert(contains(t));
-            
-            unsigned char* block = reinterpret_cast<unsigned char*>(t);
-            assert(block >= m_blocks);
-            size_t offset = static_cast<size_t>(block - m_blocks);
-            assert(offset % sizeof(T) == 0);
-            
-            size_t index = offset / sizeof(T);
-            assert(index < BlocksPerChunk);
-            
-            *block = m_firstFreeBlock;
-            m_firstFreeBlock = static_cast<unsigned char>(index);
-            m_numFreeBlocks++;
+
+        ~ThreadCache() {
+            if (!m_freeBlocks.empty())
+                sharedPool().give(m_freeBlocks, m_freeBlocks.size());
         }
-        
-        bool empty() const {
-            return m_numFreeBlocks == BlocksPerChunk - 1;
+
+        unsigned char* allocate() {
+            if (m_freeBlocks.empty())
+                sharedPool().take(m_freeBlocks, CacheSize / 2);
+
+            unsigned char* block = m_freeBlocks.back();
+            m_freeBlocks.pop_back();
+            return block;
         }
-        
-        bool full() const {
-            return m_numFreeBlocks == 0;
+
+        void deallocate(unsigned char* block) {
+            if (m_freeBlocks.size() == CacheSize)
+                sharedPool().give(m_freeBlocks, CacheSize / 2);
+            m_freeBlocks.push_back(block);
         }
     };
-    
-    typedef std::vector<Chunk*> ChunkList;
-    typedef std::stack<T*> Pool;
-    
-    static Pool& pool() {
-        static Pool p;
-        return p;
+
+    // The pool is never destroyed because blocks may still be in use by other static objects during shutdown.
+    static SharedPool& sharedPool() {
+        static SharedPool* pool = new SharedPool();
+        return *pool;
     }
-    
-    static ChunkList& fullChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static ThreadCache& threadCache() {
+        static thread_local ThreadCache cache;
+        return cache;
     }
-    
-    static ChunkList& mixedChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static size_t headerSize() {
+        return std::max(sizeof(AllocatorArena::Storage*), alignof(T));
+    }
+
+    static size_t blockSize() {
+        return headerSize() + sizeof(T);
     }
-    
-    static ChunkList emptyChunks() {
-        static ChunkList chunks;
-        return chunks;
+
+    static AllocatorArena::Storage*& header(unsigned char* block) {
+        return *reinterpret_cast<AllocatorArena::Storage**>(block);
     }
 public:
 #ifdef TB_ENABLE_ALLOCATOR
     void* operator new(size_t size) {
         assert(size == sizeof(T));
-        
-        if (!pool().empty()) {
-            T* t = pool().top();
-            pool().pop();
-            return t;
-        }
-        
-        Chunk* chunk = NULL;
-        if (mixedChunks().empty()) {
-            if (!emptyChunks().empty()) {
-                chunk = emptyChunks().back();
-                emptyChunks().pop_back();
-            } else {
-                chunk = new Chunk();
-            }
+
+        AllocatorArena::Storage* arena = AllocatorArena::current();
+        unsigned char* block = NULL;
+        if (arena != NULL) {
+            block = static_cast<unsigned char*>(arena->allocate(blockSize(), alignof(T)));
+            arena->acquire();
         } else {
-            chunk = mixedChunks().back();
-            mixedChunks().pop_back();
+            block = threadCache().allocate();
         }
-        
-        assert(!chunk->full());
-        T* block = chunk->allocate();
-        
-        if (chunk->full())
-            fullChunks().push_back(chunk);
-            else
-                mixedChunks().push_back(chunk);
-                return block;
+
+        header(block) = arena;
+        return block + headerSize();
     }
-    
-    void operator delete(void* block) {
-        T* t = reinterpret_cast<T*>(block);
-        
-        if (PoolSize > 0 && pool().size() < PoolSize) {
-            pool().push(t);
+
+    void operator delete(void* ptr) {
+        if (ptr == NULL)
             return;
-        }
-        
-        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
-        fullIt = fullChunks().rbegin();
-        fullEnd = fullChunks().rend();
-        mixedIt = mixedChunks().rbegin();
-        mixedEnd = mixedChunks().rend();
-        
-        Chunk* chunk = NULL;
-        while (fullIt < fullEnd || mixedIt < mixedEnd) {
-            if (fullIt < fullEnd) {
-                Chunk* fullChunk = *fullIt;
-                if (fullChunk->contains(t)) {
-                    chunk = fullChunk;
-                    break;
-                }
-                ++fullIt;
-            }
-            if (mixedIt < mixedEnd) {
-                Chunk* mixedChunk = *mixedIt;
-                if (mixedChunk->contains(t)) {
-                    chunk = mixedChunk;
-                    break;
-                }
-                ++mixedIt;
-            }
-        }
-        
-        assert(chunk != NULL);
-        
-        if (chunk->full()) {
-            fullChunks().erase((fullIt + 1).base());
-            mixedChunks().push_back(chunk);
-        }
-        
-        chunk->deallocate(t);
-        
-        if (chunk->empty()) {
-            mixedChunks().erase((mixedIt + 1).base());
-            if (emptyChunks().size() < 2)
-                emptyChunks().push_back(chunk);
-                else
-                    delete chunk;
-        }
+
+        unsigned char* block = static_cast<unsigned char*>(ptr) - headerSize();
+        AllocatorArena::Storage* arena = header(block);
+        if (arena != NULL)
+            arena->release();
+        else
+            threadCache().deallocate(block);
     }
 #endif
 };
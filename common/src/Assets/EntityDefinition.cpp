@@ -173,6 +173,10 @@ namespace TrenchBroom {
             return m_modelDefinition.modelSpecification(attributes);
         }
 
+        ModelSpecification PointEntityDefinition::model(const Model::EntityAttributes& attributes, Model::EntityAttributesVariableStore::Dependencies& dependencies) const {
+            return m_modelDefinition.modelSpecification(attributes, dependencies);
+        }
+
         ModelSpecification PointEntityDefinition::defaultModel() const {
             return m_modelDefinition.defaultModelSpecification();
         }
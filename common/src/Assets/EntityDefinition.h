@@ -91,6 +91,7 @@ namespace TrenchBroom {
             Type type() const;
             const BBox3& bounds() const;
             ModelSpecification model(const Model::EntityAttributes& attributes) const;
+            ModelSpecification model(const Model::EntityAttributes& attributes, Model::EntityAttributesVariableStore::Dependencies& dependencies) const;
             ModelSpecification defaultModel() const;
             const ModelDefinition& modelDefinition() const;
         };
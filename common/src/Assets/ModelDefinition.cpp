@@ -94,6 +94,7 @@ namespace TrenchBroom {
             const size_t line = m_expression.line();
             const size_t column = m_expression.column();
             m_expression = EL::SwitchOperator::create(cases, line, column);
+            m_expression.optimize();
         }
 
         ModelSpecification ModelDefinition::modelSpecification(const Model::EntityAttributes& attributes) const {
@@ -102,6 +103,12 @@ namespace TrenchBroom {
             return convertToModel(m_expression.evaluate(context));
         }
 
+        ModelSpecification ModelDefinition::modelSpecification(const Model::EntityAttributes& attributes, Model::EntityAttributesVariableStore::Dependencies& dependencies) const {
+            const Model::EntityAttributesVariableStore store(attributes, &dependencies);
+            const EL::EvaluationContext context(store);
+            return convertToModel(m_expression.evaluate(context));
+        }
+
         ModelSpecification ModelDefinition::defaultModelSpecification() const {
             const EL::NullVariableStore store;
             const EL::EvaluationContext context(store);
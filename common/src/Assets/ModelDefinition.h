@@ -23,6 +23,7 @@
 #include "EL/Expression.h"
 #include "IO/Path.h"
 #include "Model/EntityAttributes.h"
+#include "Model/EntityAttributesVariableStore.h"
 
 namespace TrenchBroom {
     namespace Assets {
@@ -56,6 +57,11 @@ namespace TrenchBroom {
             void append(const ModelDefinition& other);
 
             ModelSpecification modelSpecification(const Model::EntityAttributes& attributes) const;
+            /**
+             Evaluates the model specification and records the attributes the evaluation read in the given
+             dependencies. The result stays valid until one of these attributes changes.
+             */
+            ModelSpecification modelSpecification(const Model::EntityAttributes& attributes, Model::EntityAttributesVariableStore::Dependencies& dependencies) const;
             ModelSpecification defaultModelSpecification() const;
         private:
             ModelSpecification convertToModel(const EL::Value& value) const;
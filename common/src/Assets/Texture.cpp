@@ -19,6 +19,7 @@
 
 #include "Texture.h"
 #include "Assets/ImageUtils.h"
+#include "Macros.h"
 #include "Assets/TextureCollection.h"
 
 #include <cassert>
@@ -34,6 +35,12 @@ namespace TrenchBroom {
             }
         }
 
+        TextureSource::~TextureSource() {}
+        
+        void TextureSource::decode(TextureBuffer::Array& buffers, Color& averageColor) const {
+            doDecode(buffers, averageColor);
+        }
+
         Texture::Texture(const String& name, const size_t width, const size_t height, const Color& averageColor, const TextureBuffer& buffer, const GLenum format) :
         m_collection(NULL),
         m_name(name),
@@ -43,7 +50,10 @@ namespace TrenchBroom {
         m_usageCount(0),
         m_overridden(false),
         m_format(format),
-        m_textureId(0) {
+        m_minFilter(0),
+        m_magFilter(0),
+        m_textureId(0),
+        m_source(NULL) {
             assert(m_width > 0);
             assert(m_height > 0);
             assert(buffer.size() >= m_width * m_height * 3);
@@ -59,8 +69,11 @@ namespace TrenchBroom {
         m_usageCount(0),
         m_overridden(false),
         m_format(format),
+        m_minFilter(0),
+        m_magFilter(0),
         m_textureId(0),
-        m_buffers(buffers) {
+        m_buffers(buffers),
+        m_source(NULL) {
             assert(m_width > 0);
             assert(m_height > 0);
             for (size_t i = 0; i < m_buffers.size(); ++i) {
@@ -77,15 +90,42 @@ namespace TrenchBroom {
         m_usageCount(0),
         m_overridden(false),
         m_format(format),
-        m_textureId(0) {}
+        m_minFilter(0),
+        m_magFilter(0),
+        m_textureId(0),
+        m_source(NULL) {}
+
+        Texture::Texture(const String& name, const size_t width, const size_t height, TextureSource* source, const GLenum format) :
+        m_collection(NULL),
+        m_name(name),
+        m_width(width),
+        m_height(height),
+        m_averageColor(Color(0.0f, 0.0f, 0.0f, 1.0f)),
+        m_usageCount(0),
+        m_overridden(false),
+        m_format(format),
+        m_minFilter(0),
+        m_magFilter(0),
+        m_textureId(0),
+        m_source(source) {
+            assert(m_width > 0);
+            assert(m_height > 0);
+            ensure(m_source != NULL, "source is null");
+        }
 
         Texture::~Texture() {
             if (m_collection == NULL && m_textureId != 0)
                 glAssert(glDeleteTextures(1, &m_textureId));
             m_textureId = 0;
+            delete m_source;
+            m_source = NULL;
         }
         
         const String& Texture::name() const {
+            return m_name.asString();
+        }
+        
+        const TextureName& Texture::internedName() const {
             return m_name;
         }
         
@@ -98,9 +138,25 @@ namespace TrenchBroom {
         }
         
         const Color& Texture::averageColor() const {
+            if (m_source != NULL)
+                decode();
             return m_averageColor;
         }
         
+        GLenum Texture::format() const {
+            return m_format;
+        }
+        
+        const TextureBuffer::Array& Texture::buffers() const {
+            if (m_source != NULL)
+                decode();
+            return m_buffers;
+        }
+        
+        bool Texture::decoded() const {
+            return m_source == NULL;
+        }
+        
         size_t Texture::usageCount() const {
             return m_usageCount;
         }
@@ -132,6 +188,58 @@ namespace TrenchBroom {
 
         void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter) {
             assert(textureId > 0);
+            assert(!m_buffers.empty() || m_source != NULL);
+            
+            m_textureId = textureId;
+            m_minFilter = minFilter;
+            m_magFilter = magFilter;
+            
+            // textures with a source are decoded and uploaded when they are first activated
+            if (m_source == NULL)
+                upload();
+        }
+        
+        void Texture::setMode(const int minFilter, const int magFilter) {
+            m_minFilter = minFilter;
+            m_magFilter = magFilter;
+            
+            // textures which have not been uploaded yet receive the mode when they are uploaded
+            if (m_source == NULL && m_buffers.empty()) {
+                activate();
+                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
+                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
+                deactivate();
+            }
+        }
+
+        void Texture::activate() const {
+            assert(isPrepared());
+            if (m_source != NULL)
+                decode();
+            
+            if (!m_buffers.empty()) {
+                upload();
+            } else {
+                glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
+            }
+        }
+        
+        void Texture::deactivate() const {
+            glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+        }
+
+        void Texture::decode() const {
+            assert(m_source != NULL);
+            
+            m_buffers.clear();
+            m_source->decode(m_buffers, m_averageColor);
+            
+            delete m_source;
+            m_source = NULL;
+        }
+        
+        void Texture::upload() const {
+            assert(isPrepared());
             assert(!m_buffers.empty());
             
             glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
@@ -141,10 +249,10 @@ namespace TrenchBroom {
             glAssert(glPixelStorei(GL_UNPACK_SKIP_ROWS, 0));
             glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
             
-            glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
+            glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
             glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_buffers.size() - 1)));
-            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
-            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_minFilter));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_magFilter));
             glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
             glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
             
@@ -169,23 +277,6 @@ namespace TrenchBroom {
             }
             
             m_buffers.clear();
-            m_textureId = textureId;
-        }
-        
-        void Texture::setMode(const int minFilter, const int magFilter) {
-            activate();
-            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
-            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
-            deactivate();
-        }
-
-        void Texture::activate() const {
-            assert(isPrepared());
-            glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
-        }
-        
-        void Texture::deactivate() const {
-            glAssert(glBindTexture(GL_TEXTURE_2D, 0));
         }
 
         void Texture::setCollection(TextureCollection* collection) {
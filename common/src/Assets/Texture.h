@@ -23,6 +23,7 @@
 #include "ByteBuffer.h"
 #include "Color.h"
 #include "StringUtils.h"
+#include "Assets/TextureName.h"
 #include "Renderer/GL.h"
 
 #include <cassert>
@@ -35,33 +36,79 @@ namespace TrenchBroom {
         typedef Buffer<unsigned char> TextureBuffer;
         void setMipBufferSize(TextureBuffer::Array& buffers, const size_t width, const size_t height);
         
+        /**
+         Provides the image data of a texture which is only decoded when the texture is first used.
+         */
+        class TextureSource {
+        public:
+            virtual ~TextureSource();
+            
+            void decode(TextureBuffer::Array& buffers, Color& averageColor) const;
+        private:
+            virtual void doDecode(TextureBuffer::Array& buffers, Color& averageColor) const = 0;
+        };
+        
+        /**
+         A texture with a source decodes its image data when it is first needed, which modifies the texture even
+         from const member functions. Such a texture must therefore only be used by one thread at a time. The
+         texture manager only passes a collection from the loader thread to the GL thread after all of its textures
+         have been created, and neither thread uses the collection's textures concurrently.
+         */
         class Texture {
         private:
             TextureCollection* m_collection;
-            String m_name;
+            TextureName m_name;
             
             size_t m_width;
             size_t m_height;
-            Color m_averageColor;
+            mutable Color m_averageColor;
 
             size_t m_usageCount;
             bool m_overridden;
 
             GLenum m_format;
+            int m_minFilter;
+            int m_magFilter;
 
             mutable GLuint m_textureId;
             mutable TextureBuffer::Array m_buffers;
+            mutable TextureSource* m_source;
         public:
             Texture(const String& name, const size_t width, const size_t height, const Color& averageColor, const TextureBuffer& buffer, GLenum format = GL_RGB);
             Texture(const String& name, const size_t width, const size_t height, const Color& averageColor, const TextureBuffer::Array& buffers, GLenum format = GL_RGB);
             Texture(const String& name, const size_t width, const size_t height, GLenum format = GL_RGB);
+            
+            /**
+             Creates a texture whose image data is decoded from the given source when the texture is first
+             activated. The texture takes ownership of the source.
+             */
+            Texture(const String& name, const size_t width, const size_t height, TextureSource* source, GLenum format = GL_RGB);
             ~Texture();
 
             const String& name() const;
+            const TextureName& internedName() const;
             
             size_t width() const;
             size_t height() const;
+            
+            /**
+             Decodes the image data if that has not happened yet because the average color depends on it. Must not
+             be called concurrently with any other member function of this texture.
+             */
             const Color& averageColor() const;
+            GLenum format() const;
+            
+            /**
+             Returns the image data which has not been uploaded yet, decoding it first if necessary. The image data
+             is released once the texture has been uploaded. Must not be called concurrently with any other member
+             function of this texture.
+             */
+            const TextureBuffer::Array& buffers() const;
+            
+            /**
+             Indicates whether the image data has been decoded. This is always the case for textures without a source.
+             */
+            bool decoded() const;
 
             size_t usageCount() const;
             void incUsageCount();
@@ -76,6 +123,9 @@ namespace TrenchBroom {
             void activate() const;
             void deactivate() const;
         private:
+            void decode() const;
+            void upload() const;
+
             void setCollection(TextureCollection* collection);
             friend class TextureCollection;
         };
@@ -24,10 +24,14 @@
 #include "Logger.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
+#include "Assets/TextureName.h"
 #include "IO/TextureLoader.h"
 
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <iterator>
+#include <mutex>
 
 namespace TrenchBroom {
     namespace Assets {
@@ -48,6 +52,96 @@ namespace TrenchBroom {
             }
         };
         
+        class TextureManager::LoadJob {
+        public:
+            struct Result {
+                IO::Path path;
+                TextureCollection* collection;
+                String error;
+            };
+            typedef std::vector<Result> ResultList;
+        private:
+            struct Request {
+                IO::Path path;
+                IO::MappedFile::List files;
+            };
+            
+            IO::TextureLoader::Ptr m_loader;
+            std::vector<Request> m_requests;
+            size_t m_pending;
+            
+            std::atomic<bool> m_cancelled;
+            std::future<void> m_future;
+            
+            std::mutex m_mutex;
+            ResultList m_results;
+        public:
+            LoadJob(IO::TextureLoader::Ptr loader) :
+            m_loader(loader),
+            m_pending(0),
+            m_cancelled(false) {}
+            
+            ~LoadJob() {
+                m_cancelled = true;
+                if (m_future.valid())
+                    m_future.wait();
+                for (const Result& result : m_results)
+                    delete result.collection;
+            }
+            
+            void add(const IO::Path& path, const IO::MappedFile::List& files) {
+                assert(!m_future.valid());
+                m_requests.push_back(Request { path, files });
+            }
+            
+            bool empty() const {
+                return m_requests.empty();
+            }
+            
+            bool finished() const {
+                return m_pending == 0;
+            }
+            
+            void start() {
+                assert(!m_future.valid());
+                m_pending = m_requests.size();
+                m_future = std::async(std::launch::async, [this]() { run(); });
+            }
+            
+            ResultList takeResults(const bool wait) {
+                if (wait)
+                    m_future.wait();
+                
+                ResultList results;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                
+                using std::swap;
+                swap(results, m_results);
+                m_pending -= results.size();
+                return results;
+            }
+        private:
+            void run() {
+                for (Request& request : m_requests) {
+                    if (m_cancelled)
+                        return;
+                    
+                    Result result = { request.path, NULL, "" };
+                    try {
+                        result.collection = m_loader->readTextureCollection(request.path, request.files);
+                    } catch (const Exception& e) {
+                        result.error = e.what();
+                    }
+                    
+                    // release the mapped files as early as possible
+                    request.files.clear();
+                    
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_results.push_back(result);
+                }
+            }
+        };
+        
         TextureManager::TextureManager(Logger* logger, int minFilter, int magFilter) :
         m_logger(logger),
         m_minFilter(minFilter),
@@ -58,24 +152,23 @@ namespace TrenchBroom {
             clear();
         }
         
-        void TextureManager::setTextureCollections(const IO::Path::Array& paths, IO::TextureLoader& loader) {
+        void TextureManager::setTextureCollections(const IO::Path::Array& paths, std::shared_ptr<IO::TextureLoader> loader) {
             TextureCollectionMap collections = collectionMap();
             m_collections.clear();
             clear();
             
+            std::unique_ptr<LoadJob> loadJob(new LoadJob(loader));
             for (const IO::Path& path : paths) {
                 const auto it = collections.find(path);
                 if (it == std::end(collections) || !it->second->loaded()) {
+                    // the collection remains empty until its textures have been decoded by the load job
                     try {
-                        Assets::TextureCollection* collection = loader.loadTextureCollection(path);
-                        m_logger->info("Loaded texture collection '" + path.asString() + "'");
-                        addTextureCollection(collection);
-                        collection->usageCountDidChange.addObserver(usageCountDidChange);
+                        loadJob->add(path, loader->findTextures(path));
                     } catch (const Exception& e) {
-                        addTextureCollection(new Assets::TextureCollection(path));
                         if (it == std::end(collections))
                             m_logger->error("Could not load texture collection '" + path.asString() + "': " + e.what());
                     }
+                    addTextureCollection(it != std::end(collections) ? it->second : new Assets::TextureCollection(path));
                 } else {
                     addTextureCollection(it->second);
                 }
@@ -85,6 +178,11 @@ namespace TrenchBroom {
             
             updateTextures();
             VectorUtils::append(m_toRemove, collections);
+            
+            if (!loadJob->empty()) {
+                loadJob->start();
+                m_loadJob = std::move(loadJob);
+            }
         }
 
         TextureManager::TextureCollectionMap TextureManager::collectionMap() const {
@@ -104,11 +202,14 @@ namespace TrenchBroom {
         }
 
         void TextureManager::clear() {
+            // cancels loading and waits for the collection that is currently being decoded
+            m_loadJob.reset();
+            
             VectorUtils::clearAndDelete(m_collections);
             VectorUtils::clearAndDelete(m_toRemove);
             
             m_toPrepare.clear();
-            m_texturesByName.clear();
+            m_texturesById.clear();
             m_textures.clear();
             
             if (m_logger != NULL)
@@ -121,17 +222,35 @@ namespace TrenchBroom {
             m_resetTextureMode = true;
         }
 
-        void TextureManager::commitChanges() {
+        bool TextureManager::finishLoading() {
+            return collectLoadedCollections(true);
+        }
+        
+        bool TextureManager::commitChanges() {
+            const bool collectionsAdded = collectLoadedCollections(false);
+            prepareChanges();
+            return collectionsAdded;
+        }
+        
+        void TextureManager::prepareChanges() {
             resetTextureMode();
             prepare();
             VectorUtils::clearAndDelete(m_toRemove);
         }
         
         Texture* TextureManager::texture(const String& name) const {
-            TextureMap::const_iterator it = m_texturesByName.find(StringUtils::toLower(name));
-            if (it == std::end(m_texturesByName))
+            // a lookup must not intern the name, and a name which was never interned has no texture anyway
+            return textureById(TextureName::findId(name));
+        }
+        
+        Texture* TextureManager::texture(const TextureName& name) const {
+            return textureById(name.id());
+        }
+        
+        Texture* TextureManager::textureById(const size_t id) const {
+            if (id >= m_texturesById.size())
                 return NULL;
-            return it->second;
+            return m_texturesById[id];
         }
         
         const TextureList& TextureManager::textures() const {
@@ -150,6 +269,41 @@ namespace TrenchBroom {
             return result;
         }
         
+        bool TextureManager::collectLoadedCollections(const bool wait) {
+            if (m_loadJob.get() == NULL)
+                return false;
+            
+            const LoadJob::ResultList results = m_loadJob->takeResults(wait);
+            if (m_loadJob->finished())
+                m_loadJob.reset();
+            
+            bool collectionsAdded = false;
+            for (const LoadJob::Result& result : results) {
+                if (result.collection == NULL) {
+                    m_logger->error("Could not load texture collection '" + result.path.asString() + "': " + result.error);
+                    continue;
+                }
+                
+                const IO::Path& path = result.path;
+                TextureCollectionList::iterator it = std::find_if(std::begin(m_collections), std::end(m_collections),
+                                                                  [&path](const TextureCollection* collection) { return !collection->loaded() && collection->path() == path; });
+                assert(it != std::end(m_collections));
+                
+                // the placeholder has neither textures nor texture objects
+                delete *it;
+                *it = result.collection;
+                
+                result.collection->usageCountDidChange.addObserver(usageCountDidChange);
+                m_toPrepare.push_back(result.collection);
+                m_logger->info("Loaded texture collection '" + path.asString() + "'");
+                collectionsAdded = true;
+            }
+            
+            if (collectionsAdded)
+                updateTextures();
+            return collectionsAdded;
+        }
+        
         void TextureManager::resetTextureMode() {
             if (m_resetTextureMode) {
                 std::for_each(std::begin(m_collections), std::end(m_collections),
@@ -165,25 +319,33 @@ namespace TrenchBroom {
         }
         
         void TextureManager::updateTextures() {
-            m_texturesByName.clear();
+            m_texturesById.clear();
             m_textures.clear();
             
             for (TextureCollection* collection : m_collections) {
                 for (Texture* texture : collection->textures()) {
-                    const String key = StringUtils::toLower(texture->name());
+                    const size_t id = texture->internedName().id();
                     texture->setOverridden(false);
                     
-                    TextureMap::iterator mIt = m_texturesByName.find(key);
-                    if (mIt != std::end(m_texturesByName)) {
-                        mIt->second->setOverridden(true);
-                        mIt->second = texture;
-                    } else {
-                        m_texturesByName.insert(std::make_pair(key, texture));
-                    }
+                    if (id >= m_texturesById.size())
+                        m_texturesById.resize(id + 1, NULL);
+                    
+                    Texture*& slot = m_texturesById[id];
+                    if (slot != NULL)
+                        slot->setOverridden(true);
+                    else
+                        m_textures.push_back(texture);
+                    slot = texture;
                 }
             }
-
-            m_textures = MapUtils::valueList(m_texturesByName);
+            
+            // the textures which have been overridden must be replaced by the ones which override them
+            for (size_t i = 0; i < m_textures.size(); ++i)
+                m_textures[i] = m_texturesById[m_textures[i]->internedName().id()];
+            
+            const StringUtils::CaseInsensitiveStringLess less;
+            std::sort(std::begin(m_textures), std::end(m_textures),
+                      [&less](const Texture* left, const Texture* right) { return less(left->name(), right->name()); });
         }
         
         TextureList TextureManager::textureList() const {
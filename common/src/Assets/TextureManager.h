@@ -22,10 +22,12 @@
 
 #include "Notifier.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/TextureName.h"
 #include "IO/Path.h"
 #include "Model/ModelTypes.h"
 
 #include <map>
+#include <memory>
 #include <vector>
 
 namespace TrenchBroom {
@@ -36,20 +38,27 @@ namespace TrenchBroom {
     }
     
     namespace Assets {
+        /**
+         Texture collections are decoded on a worker thread. Until a collection has been decoded, it is represented
+         by an empty placeholder which is replaced in commitChanges, where the textures are also uploaded.
+         */
         class TextureManager {
         private:
             typedef std::map<IO::Path, TextureCollection*> TextureCollectionMap;
             typedef std::pair<IO::Path, TextureCollection*> TextureCollectionMapEntry;
-            typedef std::map<String, Texture*> TextureMap;
+            
+            class LoadJob;
             
             Logger* m_logger;
             
             TextureCollectionList m_collections;
+            std::unique_ptr<LoadJob> m_loadJob;
             
             TextureCollectionList m_toPrepare;
             TextureCollectionList m_toRemove;
             
-            TextureMap m_texturesByName;
+            // indexed by the IDs of the texture names, contains NULL for names without a texture
+            TextureList m_texturesById;
             TextureList m_textures;
             
             int m_minFilter;
@@ -61,24 +70,46 @@ namespace TrenchBroom {
             TextureManager(Logger* logger, int minFilter, int magFilter);
             ~TextureManager();
 
-            void setTextureCollections(const IO::Path::Array& paths, IO::TextureLoader& loader);
+            void setTextureCollections(const IO::Path::Array& paths, std::shared_ptr<IO::TextureLoader> loader);
         private:
             TextureCollectionMap collectionMap() const;
             void addTextureCollection(Assets::TextureCollection* collection);
         public:
             void clear();
             
+            /**
+             Waits until all pending texture collections have been decoded and adds them without uploading their
+             textures. Returns true if any collections were added.
+             */
+            bool finishLoading();
+            
             void setTextureMode(int minFilter, int magFilter);
-            void commitChanges();
+            
+            /**
+             Adds the texture collections which have been decoded since the last call and uploads the textures of
+             all new collections. Must be called on the GL thread. Returns true if any collections were added, in
+             which case the textures of the faces must be updated.
+             */
+            bool commitChanges();
+            
+            /**
+             Uploads the textures of the collections which have already been added, but does not add any newly
+             decoded collections. For views which only display the textures, since whoever adds collections must
+             also update the textures of the faces. Must be called on the GL thread.
+             */
+            void prepareChanges();
             
             Texture* texture(const String& name) const;
+            Texture* texture(const TextureName& name) const;
             const TextureList& textures() const;
             const TextureCollectionList& collections() const;
             const StringArray collectionNames() const;
         private:
+            bool collectLoadedCollections(bool wait);
             void resetTextureMode();
             void prepare();
 
+            Texture* textureById(size_t id) const;
             void updateTextures();
             TextureList textureList() const;
         };
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureName.h"
+
+#include <atomic>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace Assets {
+        struct TextureName::Entry {
+            String name;
+            size_t id;
+            
+            Entry(const String& i_name, const size_t i_id) :
+            name(i_name),
+            id(i_id) {}
+        };
+        
+        class TextureName::Table {
+        private:
+            typedef std::unordered_map<String, const Entry*> EntryMap;
+            typedef std::unordered_map<String, size_t> IdMap;
+            
+            struct Shard {
+                std::mutex mutex;
+                EntryMap entries;
+                IdMap ids;
+            };
+            
+            static const size_t ShardCount = 64;
+            Shard m_shards[ShardCount];
+            std::atomic<size_t> m_nextId;
+        public:
+            Table() :
+            m_nextId(0) {}
+            
+            const Entry* intern(const String& name) {
+                Shard& shard = findShard(name);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                
+                EntryMap::iterator it = shard.entries.find(name);
+                if (it != std::end(shard.entries))
+                    return it->second;
+                
+                const std::pair<IdMap::iterator, bool> idResult = shard.ids.insert(std::make_pair(StringUtils::toLower(name), NoId));
+                if (idResult.second)
+                    idResult.first->second = m_nextId++;
+                
+                const Entry* entry = new Entry(name, idResult.first->second);
+                shard.entries.insert(std::make_pair(name, entry));
+                return entry;
+            }
+            
+            size_t findId(const String& name) {
+                Shard& shard = findShard(name);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                
+                EntryMap::const_iterator it = shard.entries.find(name);
+                if (it != std::end(shard.entries))
+                    return it->second->id;
+                
+                IdMap::const_iterator idIt = shard.ids.find(StringUtils::toLower(name));
+                if (idIt != std::end(shard.ids))
+                    return idIt->second;
+                return NoId;
+            }
+        private:
+            Shard& findShard(const String& name) {
+                // hash the name case insensitively so that its case variants end up in the same shard and share an ID
+                size_t hash = 0;
+                for (const char c : name)
+                    hash = 31 * hash + static_cast<size_t>(tolower(c));
+                return m_shards[hash % ShardCount];
+            }
+        };
+        
+        const size_t TextureName::NoId = static_cast<size_t>(-1);
+        
+        TextureName::TextureName() {
+            static const Entry* empty = table().intern("");
+            m_entry = empty;
+        }
+        
+        TextureName::TextureName(const String& name) :
+        m_entry(table().intern(name)) {}
+        
+        size_t TextureName::findId(const String& name) {
+            return table().findId(name);
+        }
+        
+        bool TextureName::operator==(const TextureName& other) const {
+            return m_entry == other.m_entry;
+        }
+        
+        bool TextureName::operator!=(const TextureName& other) const {
+            return m_entry != other.m_entry;
+        }
+
+        const String& TextureName::asString() const {
+            return m_entry->name;
+        }
+        
+        size_t TextureName::id() const {
+            return m_entry->id;
+        }
+
+        // The table is never destroyed because texture names may still be in use by other static objects during shutdown.
+        TextureName::Table& TextureName::table() {
+            static Table* table = new Table();
+            return *table;
+        }
+    }
+}
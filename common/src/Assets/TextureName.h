@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TextureName
+#define TrenchBroom_TextureName
+
+#include "StringUtils.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        /**
+         A texture name which is interned in a global table. The table is never cleared, so a texture name is just a
+         pointer to its table entry, and copying or comparing texture names never touches the strings.
+         
+         Every texture name has a small integer ID. Names which only differ in case share the same ID, and the IDs
+         are handed out consecutively, so that textures can be looked up by name in a flat array. The table may be
+         used from any thread. It is split into shards which are locked independently, and all case variants of a
+         name are kept in the same shard.
+         */
+        class TextureName {
+        private:
+            struct Entry;
+            class Table;
+            
+            const Entry* m_entry;
+        public:
+            static const size_t NoId;
+        public:
+            TextureName();
+            explicit TextureName(const String& name);
+            
+            /**
+             Returns the ID of the given name without interning it, or NoId if neither the name nor any of its case
+             variants has been interned yet.
+             */
+            static size_t findId(const String& name);
+            
+            bool operator==(const TextureName& other) const;
+            bool operator!=(const TextureName& other) const;
+            
+            const String& asString() const;
+            size_t id() const;
+        private:
+            static Table& table();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureName) */
@@ -133,6 +133,12 @@ namespace TrenchBroom {
         OctreeException(const std::string& str) noexcept : ExceptionStream(str) {}
     };
             
+    class AABBTreeException : public ExceptionStream<AABBTreeException> {
+    public:
+        AABBTreeException() noexcept {}
+        AABBTreeException(const std::string& str) noexcept : ExceptionStream(str) {}
+    };
+            
     class GameException : public ExceptionStream<GameException> {
     public:
         GameException() noexcept {}
@@ -0,0 +1,49 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BufferedParserStatus.h"
+
+#include <wx/string.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        BufferedParserStatus::Buffer::Message::Message(const LogLevel i_level, const String& i_str) :
+        level(i_level),
+        str(i_str) {}
+
+        void BufferedParserStatus::Buffer::doLog(const LogLevel level, const String& message) {
+            messages.push_back(Message(level, message));
+        }
+
+        void BufferedParserStatus::Buffer::doLog(const LogLevel level, const wxString& message) {
+            doLog(level, message.ToStdString());
+        }
+
+        BufferedParserStatus::BufferedParserStatus() :
+        ParserStatus(&m_buffer) {}
+
+        void BufferedParserStatus::flush(ParserStatus& status) {
+            for (const Buffer::Message& message : m_buffer.messages)
+                status.log(message.level, message.str);
+            m_buffer.messages.clear();
+        }
+
+        void BufferedParserStatus::doProgress(const double progress) {}
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BufferedParserStatus
+#define TrenchBroom_BufferedParserStatus
+
+#include "Logger.h"
+#include "Macros.h"
+#include "StringUtils.h"
+#include "IO/ParserStatus.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         Collects the messages of a parser running on a worker thread so that they can later be passed on to another
+         status in the order in which the parsed data appears in the file.
+         */
+        class BufferedParserStatus : public ParserStatus {
+        private:
+            class Buffer : public Logger {
+            public:
+                struct Message {
+                public:
+                    LogLevel level;
+                    String str;
+
+                    Message(LogLevel i_level, const String& i_str);
+                };
+
+                typedef std::vector<Message> MessageList;
+
+                MessageList messages;
+            private:
+                void doLog(LogLevel level, const String& message);
+                void doLog(LogLevel level, const wxString& message);
+            };
+
+            Buffer m_buffer;
+        public:
+            BufferedParserStatus();
+
+            void flush(ParserStatus& status);
+        private:
+            void doProgress(double progress);
+
+            deleteCopyAndAssignment(BufferedParserStatus)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_BufferedParserStatus) */
@@ -20,11 +20,11 @@
 #include "DkPakFileSystem.h"
 
 #include "CollectionUtils.h"
+#include "Exceptions.h"
 #include "IO/CharArrayReader.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/IOUtils.h"
-
-#include <cassert>
+#include "IO/MappedFileCache.h"
 
 namespace TrenchBroom {
     namespace IO {
@@ -35,39 +35,62 @@ namespace TrenchBroom {
             static const String HeaderMagic       = "PACK";
         }
         
+        static const size_t DecompressedFileCacheCapacity = 64 * 1024 * 1024;
+        
+        static void checkDecompressedLength(const Path& path, const size_t written, const size_t length, const size_t size) {
+            if (length > size - written)
+                throw FileFormatException("Compressed pak entry '" + path.asString() + "' is larger than its uncompressed size");
+        }
+        
         DkPakFileSystem::CompressedFile::CompressedFile(MappedFile::Ptr file, const size_t uncompressedSize) :
         m_file(file),
         m_uncompressedSize(uncompressedSize) {}
 
+        DkPakFileSystem::CompressedFile::~CompressedFile() {
+            decompressedFiles().remove(this);
+        }
+        
         MappedFile::Ptr DkPakFileSystem::CompressedFile::doOpen() {
-            const char* data = decompress();
-            return MappedFile::Ptr(new MappedFileBuffer(m_file->path(), data, m_uncompressedSize));
+            MappedFile::Ptr result = decompressedFiles().get(this);
+            if (result.get() == NULL) {
+                std::unique_ptr<char[]> data = decompress();
+                MappedFileBuffer* buffer = new MappedFileBuffer(m_file->path(), data.get(), m_uncompressedSize);
+                data.release();
+                result = MappedFile::Ptr(buffer);
+                decompressedFiles().put(this, result);
+            }
+            return result;
         }
 
-        char* DkPakFileSystem::CompressedFile::decompress() const {
+        std::unique_ptr<char[]> DkPakFileSystem::CompressedFile::decompress() const {
             CharArrayReader reader(m_file->begin(), m_file->end());
+            const Path& path = m_file->path();
             
-            char* result = new char[m_uncompressedSize];
-            char* curTarget = result;
+            std::unique_ptr<char[]> result(new char[m_uncompressedSize]());
+            size_t written = 0;
             
             unsigned char x;
             while (!reader.eof() && (x = reader.readUnsignedChar<unsigned char>()) < 0xFF) {
+                char* curTarget = result.get() + written;
                 if (x < 0x40) {
                     // x+1 bytes of uncompressed data follow (just read+write them as they are)
                     const size_t len = static_cast<size_t>(x) + 1;
+                    checkDecompressedLength(path, written, len, m_uncompressedSize);
                     reader.read(curTarget, len);
-                    curTarget += len;
+                    written += len;
                 } else if (x < 0x80) {
                     // run-length encoded zeros, write (x - 62) zero-bytes to output
                     const size_t len = static_cast<size_t>(x) - 62;
+                    checkDecompressedLength(path, written, len, m_uncompressedSize);
                     memset(curTarget, 0, len);
-                    curTarget += len;
+                    written += len;
                 } else if (x < 0xC0) {
                     // run-length encoded data, read one byte, write it (x-126) times to output
                     const size_t len = static_cast<size_t>(x) - 126;
                     const int data = reader.readInt<unsigned char>();
+                    checkDecompressedLength(path, written, len, m_uncompressedSize);
                     memset(curTarget, data, len);
-                    curTarget += len;
+                    written += len;
                 } else if (x < 0xFE) {
                     // this references previously uncompressed data
                     // read one byte to get _offset_
@@ -75,16 +98,16 @@ namespace TrenchBroom {
                     // starting at (offset+2) bytes before the current write position (and add them to output, of course)
                     const size_t len = static_cast<size_t>(x) - 190;
                     const size_t offset = reader.readSize<unsigned char>();
-                    char* from = curTarget - offset + 2;
+                    checkDecompressedLength(path, written, len, m_uncompressedSize);
+                    if (offset + 2 > written)
+                        throw FileFormatException("Compressed pak entry '" + path.asString() + "' refers to data before its beginning");
                     
-                    assert(from >= result);
-                    assert(from <  curTarget - len);
-                    
-                    memcpy(from, curTarget, len);
-                    curTarget += len;
+                    // the ranges may overlap, so the bytes must be copied one by one
+                    const char* from = curTarget - (offset + 2);
+                    for (size_t i = 0; i < len; ++i)
+                        curTarget[i] = from[i];
+                    written += len;
                 }
-
-                x = reader.readUnsignedChar<unsigned char>();
             }
             
             return result;
@@ -118,10 +141,15 @@ namespace TrenchBroom {
                 MappedFile::Ptr entryFile(new MappedFileView(m_file, filePath, entryBegin, entryEnd));
                 
                 if (compressed)
-                    m_root.addFile(filePath, new SimpleFile(entryFile));
-                else
                     m_root.addFile(filePath, new CompressedFile(entryFile, uncompressedSize));
+                else
+                    m_root.addFile(filePath, new SimpleFile(entryFile));
             }
         }
+        
+        MappedFileCache& DkPakFileSystem::decompressedFiles() {
+            static MappedFileCache cache(DecompressedFileCacheCapacity);
+            return cache;
+        }
     }
 }
@@ -25,9 +25,12 @@
 #include "IO/Path.h"
 
 #include <map>
+#include <memory>
 
 namespace TrenchBroom {
     namespace IO {
+        class MappedFileCache;
+        
         class DkPakFileSystem : public ImageFileSystem {
         private:
             class CompressedFile : public File {
@@ -36,15 +39,21 @@ namespace TrenchBroom {
                 const size_t m_uncompressedSize;
             public:
                 CompressedFile(MappedFile::Ptr file, size_t uncompressedSize);
+                ~CompressedFile();
             private:
                 MappedFile::Ptr doOpen();
-                char* decompress() const;
+                std::unique_ptr<char[]> decompress() const;
             };
         public:
             DkPakFileSystem(const Path& path, MappedFile::Ptr file);
         private:
             void doReadDirectory();
             
+            /**
+             The decompressed files of all archives share one cache so that reopening a compressed file does not
+             decompress it again.
+             */
+            static MappedFileCache& decompressedFiles();
         };
     }
 }
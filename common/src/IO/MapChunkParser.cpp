@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapChunkParser.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "IO/ParserStatus.h"
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/ModelFactory.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        MapChunkParser::Event::Event(const Type i_type, const size_t i_line, const size_t i_lineCount, const ExtraAttributes& i_extraAttributes) :
+        type(i_type),
+        line(i_line),
+        lineCount(i_lineCount),
+        extraAttributes(i_extraAttributes),
+        brush(NULL) {}
+
+        MapChunkParser::MapChunkParser(const char* begin, const char* end, const size_t firstLine, const Model::ModelFactory* factory, const BBox3& worldBounds, EventList& events) :
+        StandardMapParser(begin, end, firstLine),
+        m_factory(factory),
+        m_worldBounds(worldBounds),
+        m_events(events) {
+            ensure(m_factory != NULL, "factory is null");
+        }
+
+        MapChunkParser::~MapChunkParser() {
+            VectorUtils::clearAndDelete(m_faces);
+        }
+
+        void MapChunkParser::readEntityHeader(const Model::MapFormat::Type format, ParserStatus& status) {
+            parseEntities(format, status);
+        }
+
+        void MapChunkParser::readBrushes(const Model::MapFormat::Type format, ParserStatus& status) {
+            parseBrushes(format, status);
+        }
+
+        void MapChunkParser::clearEvents(EventList& events) {
+            for (Event& event : events)
+                delete event.brush;
+            events.clear();
+        }
+
+        void MapChunkParser::onFormatSet(const Model::MapFormat::Type format) {}
+
+        void MapChunkParser::onBeginEntity(const size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            m_events.push_back(Event(Event::Type_BeginEntity, line, 0, extraAttributes));
+            m_events.back().attributes = attributes;
+        }
+
+        void MapChunkParser::onEndEntity(const size_t startLine, const size_t lineCount, ParserStatus& status) {
+            // the position of the closing brace is known from the chunk, not from the parser
+        }
+
+        void MapChunkParser::onBeginBrush(const size_t line, ParserStatus& status) {
+            assert(m_faces.empty());
+        }
+
+        void MapChunkParser::onEndBrush(const size_t startLine, const size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status) {
+            try {
+                // sort the faces by the weight of their plane normals like QBSP does
+                Model::BrushFace::sortFaces(m_faces);
+
+                Model::Brush* brush = m_factory->createBrush(m_worldBounds, m_faces);
+                m_faces.clear();
+
+                m_events.push_back(Event(Event::Type_Brush, startLine, lineCount, extraAttributes));
+                m_events.back().brush = brush;
+            } catch (GeometryException& e) {
+                StringStream msg;
+                msg << "Skipping brush: " << e.what();
+                status.error(startLine, msg.str());
+                m_faces.clear(); // the faces will have been deleted by the brush's constructor
+            }
+        }
+
+        void MapChunkParser::onBrushFace(const size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status) {
+            m_faces.push_back(m_factory->createFace(point1, point2, point3, attribs, texAxisX, texAxisY));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapChunkParser
+#define TrenchBroom_MapChunkParser
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "IO/StandardMapParser.h"
+#include "Model/EntityAttributes.h"
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class ModelFactory;
+    }
+
+    namespace IO {
+        class ParserStatus;
+
+        /**
+         Parses a single chunk of a map file and builds the brushes it contains. Instead of modifying a map, the
+         parser records what it has found as a list of events which can be replayed in file order later. Since the
+         parser only reads from the given factory, several parsers can run on different threads at the same time.
+         */
+        class MapChunkParser : public StandardMapParser {
+        public:
+            struct Event {
+            public:
+                typedef enum {
+                    Type_BeginEntity,
+                    Type_Brush
+                } Type;
+
+                Type type;
+                size_t line;
+                size_t lineCount;
+                Model::EntityAttribute::List attributes;
+                ExtraAttributes extraAttributes;
+                Model::Brush* brush;
+
+                Event(Type i_type, size_t i_line, size_t i_lineCount, const ExtraAttributes& i_extraAttributes);
+            };
+
+            typedef std::vector<Event> EventList;
+        private:
+            const Model::ModelFactory* m_factory;
+            BBox3 m_worldBounds;
+            Model::BrushFaceArray m_faces;
+            EventList& m_events;
+        public:
+            MapChunkParser(const char* begin, const char* end, size_t firstLine, const Model::ModelFactory* factory, const BBox3& worldBounds, EventList& events);
+            ~MapChunkParser();
+
+            void readEntityHeader(Model::MapFormat::Type format, ParserStatus& status);
+            void readBrushes(Model::MapFormat::Type format, ParserStatus& status);
+
+            static void clearEvents(EventList& events);
+        private: // implement MapParser interface
+            void onFormatSet(Model::MapFormat::Type format);
+            void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
+            void onEndEntity(size_t startLine, size_t lineCount, ParserStatus& status);
+            void onBeginBrush(size_t line, ParserStatus& status);
+            void onEndBrush(size_t startLine, size_t lineCount, const ExtraAttributes& extraAttributes, ParserStatus& status);
+            void onBrushFace(size_t line, const Vec3& point1, const Vec3& point2, const Vec3& point3, const Model::BrushFaceAttributes& attribs, const Vec3& texAxisX, const Vec3& texAxisY, ParserStatus& status);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapChunkParser) */
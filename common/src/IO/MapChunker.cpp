@@ -0,0 +1,206 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapChunker.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        MapChunk::MapChunk(const Type type, const char* begin, const char* end, const size_t line, const size_t lineCount) :
+        m_type(type),
+        m_begin(begin),
+        m_end(end),
+        m_line(line),
+        m_lineCount(lineCount) {}
+
+        MapChunk::Type MapChunk::type() const {
+            return m_type;
+        }
+
+        const char* MapChunk::begin() const {
+            return m_begin;
+        }
+
+        const char* MapChunk::end() const {
+            return m_end;
+        }
+
+        size_t MapChunk::line() const {
+            return m_line;
+        }
+
+        size_t MapChunk::lineCount() const {
+            return m_lineCount;
+        }
+
+        MapChunker::MapChunker(const char* begin, const char* end, const size_t brushesPerChunk) :
+        m_cur(begin),
+        m_end(end),
+        m_line(1),
+        m_brushesPerChunk(brushesPerChunk) {
+            assert(m_brushesPerChunk > 0);
+        }
+
+        bool MapChunker::split(MapChunk::Array& result) {
+            while (skipWhitespaceAndComments()) {
+                if (*m_cur != '{' || !splitEntity(result))
+                    return false;
+            }
+            return true;
+        }
+
+        bool MapChunker::splitEntity(MapChunk::Array& result) {
+            assert(*m_cur == '{');
+
+            const char* entityBegin = m_cur;
+            const size_t entityLine = m_line;
+            advance();
+
+            // attributes and extra attribute comments up to the first brush or the end of the entity
+            while (!eof() && *m_cur != '{' && *m_cur != '}') {
+                if (*m_cur == '"') {
+                    if (!skipQuotedString())
+                        return false;
+                } else if (*m_cur == '/' && m_cur + 1 < m_end && *(m_cur + 1) == '/') {
+                    skipComment();
+                } else {
+                    advance();
+                }
+            }
+
+            if (eof())
+                return false;
+            result.push_back(MapChunk(MapChunk::Type_EntityHeader, entityBegin, m_cur, entityLine, m_line - entityLine));
+
+            const char* runBegin = NULL;
+            size_t runLine = 0;
+            size_t runCount = 0;
+            while (*m_cur == '{') {
+                if (runCount == 0) {
+                    runBegin = m_cur;
+                    runLine = m_line;
+                }
+
+                if (!skipBrush())
+                    return false;
+
+                if (++runCount == m_brushesPerChunk) {
+                    result.push_back(MapChunk(MapChunk::Type_Brushes, runBegin, m_cur, runLine, m_line - runLine));
+                    runCount = 0;
+                }
+
+                if (!skipWhitespaceAndComments())
+                    return false;
+            }
+
+            if (runCount > 0)
+                result.push_back(MapChunk(MapChunk::Type_Brushes, runBegin, m_cur, runLine, m_line - runLine));
+
+            // attributes following the brushes or stray extra attribute comments are left to the sequential parser
+            if (*m_cur != '}')
+                return false;
+
+            result.push_back(MapChunk(MapChunk::Type_EntityEnd, m_cur, m_cur + 1, entityLine, m_line - entityLine));
+            advance();
+            return true;
+        }
+
+        bool MapChunker::skipBrush() {
+            assert(*m_cur == '{');
+            advance();
+
+            // Texture names are not quoted and may contain braces, so a closing brace only ends the brush if it
+            // starts a token.
+            bool tokenStart = true;
+            while (!eof()) {
+                const char c = *m_cur;
+                if (tokenStart) {
+                    if (c == '}') {
+                        advance();
+                        return true;
+                    }
+                    if (c == '"') {
+                        if (!skipQuotedString())
+                            return false;
+                        tokenStart = false;
+                        continue;
+                    }
+                    if (c == '/' && m_cur + 1 < m_end && *(m_cur + 1) == '/') {
+                        skipComment();
+                        continue;
+                    }
+                }
+                tokenStart = whitespace(c);
+                advance();
+            }
+            return false;
+        }
+
+        bool MapChunker::skipWhitespaceAndComments() {
+            while (!eof()) {
+                if (whitespace(*m_cur)) {
+                    advance();
+                } else if (*m_cur == '/' && m_cur + 1 < m_end && *(m_cur + 1) == '/' &&
+                           (m_cur + 2 == m_end || *(m_cur + 2) != '/')) {
+                    // extra attribute comments (///) are not skipped
+                    skipComment();
+                } else {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool MapChunker::skipQuotedString() {
+            assert(*m_cur == '"');
+            advance();
+
+            bool escaped = false;
+            while (!eof()) {
+                const char c = *m_cur;
+                advance();
+                if (c == '"' && !escaped)
+                    return true;
+                escaped = (c == '\\' && !escaped);
+            }
+            return false;
+        }
+
+        void MapChunker::skipComment() {
+            while (!eof() && *m_cur != '\n')
+                advance();
+        }
+
+        bool MapChunker::eof() const {
+            return m_cur >= m_end;
+        }
+
+        bool MapChunker::whitespace(const char c) const {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        void MapChunker::advance() {
+            assert(!eof());
+            if (*m_cur == '\n')
+                ++m_line;
+            ++m_cur;
+        }
+    }
+}
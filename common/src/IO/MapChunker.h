@@ -0,0 +1,91 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapChunker
+#define TrenchBroom_MapChunker
+
+#include <cstddef>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         A contiguous piece of a map file that can be parsed independently of the other pieces.
+
+         An entity is split into a header chunk containing its opening brace and its attributes, any number of
+         brush chunks containing runs of complete brushes, and an end chunk which only records the position of the
+         entity's closing brace.
+         */
+        class MapChunk {
+        public:
+            typedef enum {
+                Type_EntityHeader,
+                Type_Brushes,
+                Type_EntityEnd
+            } Type;
+
+            typedef std::vector<MapChunk> Array;
+        private:
+            Type m_type;
+            const char* m_begin;
+            const char* m_end;
+            size_t m_line;
+            size_t m_lineCount;
+        public:
+            MapChunk(Type type, const char* begin, const char* end, size_t line, size_t lineCount);
+
+            Type type() const;
+            const char* begin() const;
+            const char* end() const;
+            size_t line() const;
+            size_t lineCount() const;
+        };
+
+        /**
+         Splits a map file into chunks without tokenizing it. The scan only tracks quoted strings, comments and brace
+         nesting, so it is much faster than a full parse. If the file contains anything the scan does not understand,
+         it gives up and the file must be parsed sequentially instead; the sequential parser will then report any
+         actual syntax errors.
+         */
+        class MapChunker {
+        private:
+            const char* m_cur;
+            const char* m_end;
+            size_t m_line;
+            size_t m_brushesPerChunk;
+        public:
+            MapChunker(const char* begin, const char* end, size_t brushesPerChunk);
+
+            bool split(MapChunk::Array& result);
+        private:
+            bool splitEntity(MapChunk::Array& result);
+            bool skipBrush();
+
+            bool skipWhitespaceAndComments();
+            bool skipQuotedString();
+            void skipComment();
+
+            bool eof() const;
+            bool whitespace(char c) const;
+            void advance();
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapChunker) */
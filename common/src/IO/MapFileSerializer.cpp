@@ -19,187 +19,117 @@
 
 #include "MapFileSerializer.h"
 #include "Exceptions.h"
+#include "ParallelUtils.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/Path.h"
 #include "Model/BrushFace.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 namespace TrenchBroom {
     namespace IO {
         class StandardFileSerializer : public MapFileSerializer {
         private:
             bool m_longFormat;
-            String FaceFormat;
         public:
             StandardFileSerializer(FILE* stream, const bool longFormat) :
             MapFileSerializer(stream),
-            m_longFormat(longFormat) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g";
-                if (m_longFormat)
-                    str << " %d %d %.6g";
-                FaceFormat = str.str();
-            }
+            m_longFormat(longFormat) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
+            size_t doWriteBrushFace(String& str, const Model::BrushFace* face) const {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
+                
+                appendPoints(str, face);
+                str.append(textureName);
+                str.push_back(' ');
+                appendFloat(str, face->xOffset(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yOffset(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->rotation(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->xScale(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yScale(), 6);
                 
                 if (m_longFormat) {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale(),
-                                 face->surfaceContents(),
-                                 face->surfaceFlags(),
-                                 face->surfaceValue());
-                } else {
-                    std::fprintf(stream, FaceFormat.c_str(),
-                                 points[0].x(),
-                                 points[0].y(),
-                                 points[0].z(),
-                                 points[1].x(),
-                                 points[1].y(),
-                                 points[1].z(),
-                                 points[2].x(),
-                                 points[2].y(),
-                                 points[2].z(),
-                                 textureName.c_str(),
-                                 face->xOffset(),
-                                 face->yOffset(),
-                                 face->rotation(),
-                                 face->xScale(),
-                                 face->yScale());
+                    str.push_back(' ');
+                    appendInteger(str, face->surfaceContents());
+                    str.push_back(' ');
+                    appendInteger(str, face->surfaceFlags());
+                    str.push_back(' ');
+                    appendFloat(str, face->surfaceValue(), 6);
                 }
-                std::fprintf(stream, "\n");
+                str.push_back('\n');
                 return 1;
             }
         };
         
         class Hexen2FileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
             Hexen2FileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s %.6g %.6g %.6g %.6g %.6g 0\n"; // the extra value is written here
-                
-                FaceFormat = str.str();
-            }
+            MapFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
+            size_t doWriteBrushFace(String& str, const Model::BrushFace* face) const {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
-                const Model::BrushFace::Points& points = face->points();
                 
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             textureName.c_str(),
-                             face->xOffset(),
-                             face->yOffset(),
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+                appendPoints(str, face);
+                str.append(textureName);
+                str.push_back(' ');
+                appendFloat(str, face->xOffset(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yOffset(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->rotation(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->xScale(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yScale(), 6);
+                str.append(" 0\n"); // the extra value is written here
                 return 1;
             }
         };
         
         class ValveFileSerializer : public MapFileSerializer {
-        private:
-            String FaceFormat;
         public:
             ValveFileSerializer(FILE* stream) :
-            MapFileSerializer(stream) {
-                StringStream str;
-                str <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "( %." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g " <<
-                "%." << FloatPrecision << "g ) " <<
-                "%s " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "[ %.6g %.6g %.6g %.6g ] " <<
-                "%.6g %.6g %.6g\n";
-                
-                FaceFormat = str.str();
-            }
+            MapFileSerializer(stream) {}
         private:
-            size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) {
+            size_t doWriteBrushFace(String& str, const Model::BrushFace* face) const {
                 const String& textureName = face->textureName().empty() ? Model::BrushFace::NoTextureName : face->textureName();
                 const Vec3 xAxis = face->textureXAxis();
                 const Vec3 yAxis = face->textureYAxis();
-                const Model::BrushFace::Points& points = face->points();
                 
-                std::fprintf(stream, FaceFormat.c_str(),
-                             points[0].x(),
-                             points[0].y(),
-                             points[0].z(),
-                             points[1].x(),
-                             points[1].y(),
-                             points[1].z(),
-                             points[2].x(),
-                             points[2].y(),
-                             points[2].z(),
-                             
-                             textureName.c_str(),
-                             
-                             xAxis.x(),
-                             xAxis.y(),
-                             xAxis.z(),
-                             face->xOffset(),
-                             
-                             yAxis.x(),
-                             yAxis.y(),
-                             yAxis.z(),
-                             face->yOffset(),
-                             
-                             face->rotation(),
-                             face->xScale(),
-                             face->yScale());
+                appendPoints(str, face);
+                str.append(textureName);
+                
+                str.append(" [ ");
+                appendFloat(str, xAxis.x(), 6);
+                str.push_back(' ');
+                appendFloat(str, xAxis.y(), 6);
+                str.push_back(' ');
+                appendFloat(str, xAxis.z(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->xOffset(), 6);
+                
+                str.append(" ] [ ");
+                appendFloat(str, yAxis.x(), 6);
+                str.push_back(' ');
+                appendFloat(str, yAxis.y(), 6);
+                str.push_back(' ');
+                appendFloat(str, yAxis.z(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yOffset(), 6);
+                
+                str.append(" ] ");
+                appendFloat(str, face->rotation(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->xScale(), 6);
+                str.push_back(' ');
+                appendFloat(str, face->yScale(), 6);
+                str.push_back('\n');
                 return 1;
             }
         };
@@ -224,53 +154,188 @@ namespace TrenchBroom {
         m_line(1),
         m_stream(stream) {
             ensure(m_stream != NULL, "stream is null");
+            m_buffer.reserve(BufferSize);
         }
         
+        void MapFileSerializer::appendPoints(String& str, const Model::BrushFace* face) {
+            const Model::BrushFace::Points& points = face->points();
+            for (size_t i = 0; i < 3; ++i) {
+                str.append("( ");
+                appendFloat(str, points[i].x(), FloatPrecision);
+                str.push_back(' ');
+                appendFloat(str, points[i].y(), FloatPrecision);
+                str.push_back(' ');
+                appendFloat(str, points[i].z(), FloatPrecision);
+                str.append(" ) ");
+            }
+        }
+
+        void MapFileSerializer::appendFloat(String& str, const double value, const int precision) {
+            static const double Limits[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,
+                1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17
+            };
+            assert(precision > 0 && precision <= 17);
+            
+            if (value == std::floor(value) && std::abs(value) < Limits[precision]) {
+                if (value == 0.0 && std::signbit(value))
+                    str.append("-0");
+                else
+                    appendInteger(str, static_cast<long long>(value));
+            } else {
+                char buffer[32];
+                const int length = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+                assert(length > 0 && static_cast<size_t>(length) < sizeof(buffer));
+                str.append(buffer, static_cast<size_t>(length));
+            }
+        }
+        
+        void MapFileSerializer::appendInteger(String& str, const long long value) {
+            char buffer[24];
+            char* end = buffer + sizeof(buffer);
+            char* cur = end;
+            
+            unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+            do {
+                *--cur = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude > 0);
+            
+            if (value < 0)
+                *--cur = '-';
+            str.append(cur, static_cast<size_t>(end - cur));
+        }
+
         void MapFileSerializer::doBeginFile() {}
-        void MapFileSerializer::doEndFile() {}
+        
+        void MapFileSerializer::doEndFile() {
+            flush(0);
+        }
 
         void MapFileSerializer::doBeginEntity(const Model::Node* node) {
-            std::fprintf(m_stream, "// entity %u\n", entityNo());
+            m_buffer.append("// entity ");
+            appendInteger(m_buffer, entityNo());
+            m_buffer.push_back('\n');
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            m_buffer.append("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndEntity(Model::Node* node) {
-            std::fprintf(m_stream, "}\n");
+            m_buffer.append("}\n");
             ++m_line;
             setFilePosition(node);
+            flush(BufferSize);
         }
         
-        void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) { 
-            std::fprintf(m_stream, "\"%s\" \"%s\"\n", attribute.name().c_str(), attribute.value().c_str());
+        void MapFileSerializer::doEntityAttribute(const Model::EntityAttribute& attribute) {
+            m_buffer.push_back('"');
+            m_buffer.append(attribute.name());
+            m_buffer.append("\" \"");
+            m_buffer.append(attribute.value());
+            m_buffer.append("\"\n");
             ++m_line;
         }
         
         void MapFileSerializer::doBeginBrush(const Model::Brush* brush) {
-            std::fprintf(m_stream, "// brush %u\n", brushNo());
+            m_buffer.append("// brush ");
+            appendInteger(m_buffer, brushNo());
+            m_buffer.push_back('\n');
             ++m_line;
             m_startLineStack.push_back(m_line);
-            std::fprintf(m_stream, "{\n");
+            m_buffer.append("{\n");
             ++m_line;
         }
         
         void MapFileSerializer::doEndBrush(Model::Brush* brush) {
-            std::fprintf(m_stream, "}\n");
+            m_buffer.append("}\n");
             ++m_line;
             setFilePosition(brush);
+            flush(BufferSize);
         }
         
         void MapFileSerializer::doBrushFace(Model::BrushFace* face) {
-            const size_t lines = doWriteBrushFace(m_stream, face);
+            const size_t lines = doWriteBrushFace(m_buffer, face);
             face->setFilePosition(m_line, lines);
             m_line += lines;
+            flush(BufferSize);
+        }
+        
+        void MapFileSerializer::doBrushes(const Model::BrushArray& brushes) {
+            const size_t chunkCount = (brushes.size() + BrushesPerChunk - 1) / BrushesPerChunk;
+            
+            // only a few chunks per thread are formatted at once to limit the memory used for large entities
+            const size_t batchSize = std::min(chunkCount, 4 * ParallelUtils::threadCount());
+            if (m_brushChunks.size() < batchSize)
+                m_brushChunks.resize(batchSize);
+
+            const ObjectNo firstBrushNo = brushNo();
+            for (size_t batchStart = 0; batchStart < chunkCount; batchStart += batchSize) {
+                const size_t batchCount = std::min(batchSize, chunkCount - batchStart);
+                
+                ParallelUtils::parallelFor(batchCount, [&](const size_t i) {
+                    const size_t first = (batchStart + i) * BrushesPerChunk;
+                    const size_t count = std::min(BrushesPerChunk, brushes.size() - first);
+                    formatBrushes(brushes, first, count, firstBrushNo, m_brushChunks[i]);
+                });
+                
+                for (size_t i = 0; i < batchCount; ++i) {
+                    const size_t first = (batchStart + i) * BrushesPerChunk;
+                    const size_t count = std::min(BrushesPerChunk, brushes.size() - first);
+                    writeBrushes(brushes, first, count, m_brushChunks[i]);
+                }
+            }
+            
+            brushesWritten(brushes.size());
+        }
+        
+        void MapFileSerializer::formatBrushes(const Model::BrushArray& brushes, const size_t first, const size_t count, const ObjectNo firstBrushNo, BrushChunk& chunk) const {
+            chunk.text.clear();
+            chunk.faceLines.clear();
+            
+            for (size_t i = first; i < first + count; ++i) {
+                chunk.text.append("// brush ");
+                appendInteger(chunk.text, firstBrushNo + i);
+                chunk.text.append("\n{\n");
+                
+                const Model::BrushFaceArray& faces = brushes[i]->faces();
+                for (const Model::BrushFace* face : faces)
+                    chunk.faceLines.push_back(doWriteBrushFace(chunk.text, face));
+                
+                chunk.text.append("}\n");
+            }
+        }
+        
+        void MapFileSerializer::writeBrushes(const Model::BrushArray& brushes, const size_t first, const size_t count, const BrushChunk& chunk) {
+            m_buffer.append(chunk.text);
+            
+            // the line numbers are assigned exactly as if the brushes had been written one by one
+            size_t faceIndex = 0;
+            for (size_t i = first; i < first + count; ++i) {
+                Model::Brush* brush = brushes[i];
+                ++m_line;
+                const size_t brushLine = m_line;
+                ++m_line;
+                
+                const Model::BrushFaceArray& faces = brush->faces();
+                for (Model::BrushFace* face : faces) {
+                    const size_t lines = chunk.faceLines[faceIndex++];
+                    face->setFilePosition(m_line, lines);
+                    m_line += lines;
+                }
+                
+                ++m_line;
+                brush->setFilePosition(brushLine, m_line - brushLine);
+            }
+            
+            flush(BufferSize);
         }
         
         void MapFileSerializer::setFilePosition(Model::Node* node) {
             const size_t start = startLine();
-            node->setFilePosition(start, m_line - start);
+            if (node != NULL)
+                node->setFilePosition(start, m_line - start);
         }
 
         size_t MapFileSerializer::startLine() {
@@ -279,5 +344,12 @@ namespace TrenchBroom {
             m_startLineStack.pop_back();
             return result;
         }
+
+        void MapFileSerializer::flush(const size_t threshold) {
+            if (m_buffer.size() >= threshold && !m_buffer.empty()) {
+                std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_stream);
+                m_buffer.clear();
+            }
+        }
     }
 }
@@ -26,21 +26,47 @@
 #include "Model/Node.h"
 
 #include <cstdio>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
         class Path;
         
+        /**
+         Writes map files. The output is formatted into a buffer which is written to the file in large blocks.
+         The brushes of an entity are formatted in parallel, in chunks of consecutive brushes, and the chunks
+         are then appended to the buffer in order.
+         */
         class MapFileSerializer : public NodeSerializer {
         private:
+            static const size_t BufferSize = 1024 * 1024;
+            static const size_t BrushesPerChunk = 64;
+
+            struct BrushChunk {
+                String text;
+                std::vector<size_t> faceLines;
+            };
+            typedef std::vector<BrushChunk> BrushChunkArray;
+
             typedef std::vector<size_t> LineStack;
             LineStack m_startLineStack;
             size_t m_line;
             FILE* m_stream;
+            String m_buffer;
+            BrushChunkArray m_brushChunks;
         public:
             static Ptr create(Model::MapFormat::Type format, FILE* stream);
         protected:
             MapFileSerializer(FILE* file);
+
+            static void appendPoints(String& str, const Model::BrushFace* face);
+            
+            /**
+             Appends the given value as formatted by printf's %g conversion with the given precision. Integral values
+             with at most precision digits are formatted directly since %g writes them like integers.
+             */
+            static void appendFloat(String& str, double value, int precision);
+            static void appendInteger(String& str, long long value);
         private:
             void doBeginFile();
             void doEndFile();
@@ -51,11 +77,17 @@ namespace TrenchBroom {
             void doBeginBrush(const Model::Brush* brush);
             void doEndBrush(Model::Brush* brush);
             void doBrushFace(Model::BrushFace* face);
+            void doBrushes(const Model::BrushArray& brushes);
         private:
+            void formatBrushes(const Model::BrushArray& brushes, size_t first, size_t count, ObjectNo firstBrushNo, BrushChunk& chunk) const;
+            void writeBrushes(const Model::BrushArray& brushes, size_t first, size_t count, const BrushChunk& chunk);
+            
             void setFilePosition(Model::Node* node);
             size_t startLine();
+            
+            void flush(size_t threshold);
         private:
-            virtual size_t doWriteBrushFace(FILE* stream, Model::BrushFace* face) = 0;
+            virtual size_t doWriteBrushFace(String& str, const Model::BrushFace* face) const = 0;
         };
     }
 }
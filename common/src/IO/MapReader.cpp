@@ -21,6 +21,10 @@
 
 #include "CollectionUtils.h"
 #include "Logger.h"
+#include "ParallelUtils.h"
+#include "IO/BufferedParserStatus.h"
+#include "IO/MapChunkParser.h"
+#include "IO/MapChunker.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/Entity.h"
@@ -55,14 +59,30 @@ namespace TrenchBroom {
             return m_id;
         }
 
+        class MapReader::ParsedChunk {
+        public:
+            MapChunkParser::EventList events;
+            BufferedParserStatus status;
+            
+            ~ParsedChunk() {
+                MapChunkParser::clearEvents(events);
+            }
+        };
+        
         MapReader::MapReader(const char* begin, const char* end) :
         StandardMapParser(begin, end),
+        m_begin(begin),
+        m_end(end),
+        m_parallel(false),
         m_factory(NULL),
         m_brushParent(NULL),
         m_currentNode(NULL) {}
         
         MapReader::MapReader(const String& str) :
         StandardMapParser(str),
+        m_begin(str.c_str()),
+        m_end(str.c_str() + str.size()),
+        m_parallel(false),
         m_factory(NULL),
         m_brushParent(NULL),
         m_currentNode(NULL) {}
@@ -71,9 +91,14 @@ namespace TrenchBroom {
             VectorUtils::clearAndDelete(m_faces);
         }
 
+        void MapReader::setParallel(const bool parallel) {
+            m_parallel = parallel;
+        }
+
         void MapReader::readEntities(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status) {
             m_worldBounds = worldBounds;
-            parseEntities(format, status);
+            if (!m_parallel || !parseEntitiesInParallel(format, status))
+                parseEntities(format, status);
             resolveNodes(status);
         }
         
@@ -87,8 +112,81 @@ namespace TrenchBroom {
             parseBrushFaces(format, status);
         }
 
+        bool MapReader::parseEntitiesInParallel(const Model::MapFormat::Type format, ParserStatus& status) {
+            MapChunk::Array chunks;
+            MapChunker chunker(m_begin, m_end, BrushesPerChunk);
+            if (!chunker.split(chunks))
+                return false;
+            
+            // the workers need the factory, so it must be created up front
+            formatSet(format);
+            
+            std::vector<ParsedChunk> parsedChunks(chunks.size());
+            try {
+                ParallelUtils::parallelFor(chunks.size(), [&](const size_t i) {
+                    parseChunk(chunks[i], format, parsedChunks[i]);
+                });
+            } catch (const ParserException&) {
+                // let the sequential parser report the error
+                return false;
+            }
+            
+            for (size_t i = 0; i < chunks.size(); ++i)
+                addChunk(chunks[i], parsedChunks[i], status);
+            return true;
+        }
+        
+        void MapReader::parseChunk(const MapChunk& chunk, const Model::MapFormat::Type format, ParsedChunk& result) const {
+            switch (chunk.type()) {
+                case MapChunk::Type_EntityHeader: {
+                    // close the entity so that the header can be parsed on its own
+                    const String header = String(chunk.begin(), chunk.end()) + "}";
+                    MapChunkParser parser(header.c_str(), header.c_str() + header.size(), chunk.line(), m_factory, m_worldBounds, result.events);
+                    parser.readEntityHeader(format, result.status);
+                    break;
+                }
+                case MapChunk::Type_Brushes: {
+                    MapChunkParser parser(chunk.begin(), chunk.end(), chunk.line(), m_factory, m_worldBounds, result.events);
+                    parser.readBrushes(format, result.status);
+                    break;
+                }
+                case MapChunk::Type_EntityEnd:
+                    break;
+                switchDefault()
+            }
+        }
+        
+        void MapReader::addChunk(const MapChunk& chunk, ParsedChunk& parsedChunk, ParserStatus& status) {
+            parsedChunk.status.flush(status);
+            
+            if (chunk.type() == MapChunk::Type_EntityEnd) {
+                onEndEntity(chunk.line(), chunk.lineCount(), status);
+                return;
+            }
+            
+            for (MapChunkParser::Event& event : parsedChunk.events) {
+                switch (event.type) {
+                    case MapChunkParser::Event::Type_BeginEntity:
+                        onBeginEntity(event.line, event.attributes, event.extraAttributes, status);
+                        break;
+                    case MapChunkParser::Event::Type_Brush: {
+                        Model::Brush* brush = event.brush;
+                        event.brush = NULL;
+                        
+                        setFilePosition(brush, event.line, event.lineCount);
+                        setExtraAttributes(brush, event.extraAttributes);
+                        onBrush(m_brushParent, brush, status);
+                        break;
+                    }
+                    switchDefault()
+                }
+            }
+        }
+
         void MapReader::onFormatSet(const Model::MapFormat::Type format) {
-            m_factory = initialize(format, m_worldBounds);
+            // the factory may already have been created by an attempt to read the file in parallel
+            if (m_factory == NULL)
+                m_factory = initialize(format, m_worldBounds);
             ensure(m_factory != NULL, "factory is null");
         }
         
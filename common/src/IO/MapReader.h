@@ -31,6 +31,7 @@ namespace TrenchBroom {
     }
     
     namespace IO {
+        class MapChunk;
         class ParserStatus;
         
         class MapReader : public StandardMapParser {
@@ -69,6 +70,14 @@ namespace TrenchBroom {
             typedef std::pair<Model::Node*, ParentInfo> NodeParentPair;
             typedef std::vector<NodeParentPair> NodeParentArray;
             
+            class ParsedChunk;
+            
+            static const size_t BrushesPerChunk = 256;
+            
+            const char* m_begin;
+            const char* m_end;
+            bool m_parallel;
+            
             BBox3 m_worldBounds;
             Model::ModelFactory* m_factory;
             
@@ -88,6 +97,18 @@ namespace TrenchBroom {
             void readBrushFaces(Model::MapFormat::Type format, const BBox3& worldBounds, ParserStatus& status);
         public:
             virtual ~MapReader();
+            
+            /**
+             Enables or disables parallel loading. When enabled, readEntities splits the file into chunks which are
+             parsed and whose brushes are built on several threads. The results are added to the map in file order,
+             so the resulting map is the same as if it had been read sequentially. Files which cannot be split are
+             always read sequentially.
+             */
+            void setParallel(bool parallel);
+        private:
+            bool parseEntitiesInParallel(Model::MapFormat::Type format, ParserStatus& status);
+            void parseChunk(const MapChunk& chunk, Model::MapFormat::Type format, ParsedChunk& result) const;
+            void addChunk(const MapChunk& chunk, ParsedChunk& parsedChunk, ParserStatus& status);
         private: // implement MapParser interface
             void onFormatSet(Model::MapFormat::Type format);
             void onBeginEntity(size_t line, const Model::EntityAttribute::List& attributes, const ExtraAttributes& extraAttributes, ParserStatus& status);
@@ -0,0 +1,91 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapSnapshot.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "IO/IOUtils.h"
+#include "IO/MapFileSerializer.h"
+#include "IO/NodeSerializer.h"
+#include "IO/NodeWriter.h"
+#include "Model/BrushFace.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapSnapshot::Recorder : public NodeSerializer {
+        private:
+            EntityList& m_entities;
+        public:
+            Recorder(EntityList& entities) :
+            m_entities(entities) {}
+        private:
+            void doBeginFile() {}
+            void doEndFile() {}
+            
+            void doBeginEntity(const Model::Node* node) {
+                m_entities.push_back(Entity());
+            }
+            
+            void doEndEntity(Model::Node* node) {}
+            
+            void doEntityAttribute(const Model::EntityAttribute& attribute) {
+                m_entities.back().attributes.push_back(attribute);
+            }
+            
+            void doBeginBrush(const Model::Brush* brush) {
+                m_entities.back().brushes.push_back(Model::BrushFaceArray());
+            }
+            
+            void doEndBrush(Model::Brush* brush) {}
+            
+            void doBrushFace(Model::BrushFace* face) {
+                m_entities.back().brushes.back().push_back(face->cloneWithoutTexture());
+            }
+        };
+        
+        MapSnapshot::MapSnapshot(const String& gameName, Model::World* world) :
+        m_gameName(gameName),
+        m_format(world->format()) {
+            NodeWriter writer(world, new Recorder(m_entities));
+            writer.writeMap();
+        }
+        
+        MapSnapshot::~MapSnapshot() {
+            for (Entity& entity : m_entities) {
+                for (Model::BrushFaceArray& faces : entity.brushes)
+                    VectorUtils::clearAndDelete(faces);
+            }
+        }
+        
+        void MapSnapshot::write(FILE* stream) const {
+            writeGameComment(stream, m_gameName, Model::formatName(m_format));
+            
+            NodeSerializer::Ptr serializer = MapFileSerializer::create(m_format, stream);
+            serializer->beginFile();
+            for (const Entity& entity : m_entities)
+                serializer->entity(entity.attributes, entity.brushes);
+            serializer->endFile();
+            
+            if (std::fflush(stream) != 0 || std::ferror(stream) != 0)
+                throw FileSystemException("Cannot write map snapshot");
+        }
+    }
+}
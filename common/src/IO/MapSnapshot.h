@@ -0,0 +1,66 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapSnapshot
+#define TrenchBroom_MapSnapshot
+
+#include "Macros.h"
+#include "StringUtils.h"
+#include "Model/EntityAttributes.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelTypes.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         A copy of a world as it is written to a map file. Taking a snapshot copies the entity attributes and clones
+         the brush faces, but it does not copy any brush geometry. The snapshot does not refer to the world, so it can
+         be written on another thread while the world is being edited.
+         */
+        class MapSnapshot {
+        private:
+            class Recorder;
+
+            struct Entity {
+                Model::EntityAttribute::List attributes;
+                std::vector<Model::BrushFaceArray> brushes;
+            };
+            typedef std::vector<Entity> EntityList;
+
+            String m_gameName;
+            Model::MapFormat::Type m_format;
+            EntityList m_entities;
+        public:
+            MapSnapshot(const String& gameName, Model::World* world);
+            ~MapSnapshot();
+
+            /**
+             Writes the snapshot to the given stream. Throws a FileSystemException if the data could not be written.
+             */
+            void write(FILE* stream) const;
+
+            deleteCopyAndAssignment(MapSnapshot)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MapSnapshot) */
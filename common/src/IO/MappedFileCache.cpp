@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFileCache.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        MappedFileCache::MappedFileCache(const size_t capacity) :
+        m_capacity(capacity),
+        m_size(0) {}
+        
+        MappedFile::Ptr MappedFileCache::get(const void* key) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            
+            EntryMap::iterator it = m_index.find(key);
+            if (it == std::end(m_index))
+                return MappedFile::Ptr();
+            
+            // move the entry to the front of the list
+            m_entries.splice(std::begin(m_entries), m_entries, it->second);
+            return it->second->second;
+        }
+        
+        void MappedFileCache::put(const void* key, MappedFile::Ptr file) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            
+            EntryMap::iterator it = m_index.find(key);
+            if (it != std::end(m_index))
+                doRemove(it);
+            
+            if (file->size() > m_capacity)
+                return;
+            
+            while (m_size + file->size() > m_capacity) {
+                assert(!m_entries.empty());
+                doRemove(m_index.find(m_entries.back().first));
+            }
+            
+            m_entries.push_front(std::make_pair(key, file));
+            m_index.insert(std::make_pair(key, std::begin(m_entries)));
+            m_size += file->size();
+        }
+        
+        void MappedFileCache::remove(const void* key) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            
+            EntryMap::iterator it = m_index.find(key);
+            if (it != std::end(m_index))
+                doRemove(it);
+        }
+        
+        size_t MappedFileCache::size() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_size;
+        }
+
+        void MappedFileCache::doRemove(EntryMap::iterator it) {
+            assert(it != std::end(m_index));
+            
+            m_size -= it->second->second->size();
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MappedFileCache
+#define TrenchBroom_MappedFileCache
+
+#include "Macros.h"
+#include "IO/MappedFile.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         Keeps the most recently used files up to the given total size in memory. The cache may be used from
+         several threads at once.
+         */
+        class MappedFileCache {
+        private:
+            typedef std::pair<const void*, MappedFile::Ptr> Entry;
+            typedef std::list<Entry> EntryList;
+            typedef std::map<const void*, EntryList::iterator> EntryMap;
+            
+            size_t m_capacity;
+            size_t m_size;
+            EntryList m_entries;
+            EntryMap m_index;
+            mutable std::mutex m_mutex;
+        public:
+            MappedFileCache(size_t capacity);
+            
+            /**
+             Returns the file cached for the given key or a null pointer if no such file is cached.
+             */
+            MappedFile::Ptr get(const void* key);
+            
+            /**
+             Caches the given file for the given key and evicts the least recently used files until the total
+             size of the cached files does not exceed the capacity. Files which are larger than the capacity are
+             not cached.
+             */
+            void put(const void* key, MappedFile::Ptr file);
+            void remove(const void* key);
+            
+            size_t size() const;
+        private:
+            void doRemove(EntryMap::iterator it);
+            
+            deleteCopyAndAssignment(MappedFileCache)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_MappedFileCache) */
@@ -30,8 +30,55 @@ namespace TrenchBroom {
     namespace IO {
         namespace MipLayout {
             static const size_t TextureNameLength = 16;
+            static const size_t MipLevels = 4;
         }
         
+        static void readMipHeader(CharArrayReader& reader, String& name, size_t& width, size_t& height, size_t offset[]) {
+            name = reader.readString(MipLayout::TextureNameLength);
+            width = reader.readSize<int32_t>();
+            height = reader.readSize<int32_t>();
+            for (size_t i = 0; i < MipLayout::MipLevels; ++i)
+                offset[i] = reader.readSize<int32_t>();
+        }
+        
+        static void decodeMips(const char* const begin, const Assets::Palette& palette, const size_t width, const size_t height, const size_t offset[], Assets::TextureBuffer::Array& buffers, Color& averageColor) {
+            Color tempColor;
+            
+            buffers.resize(MipLayout::MipLevels);
+            Assets::setMipBufferSize(buffers, width, height);
+            
+            for (size_t i = 0; i < MipLayout::MipLevels; ++i) {
+                const char* data = begin + offset[i];
+                const size_t size = TextureReader::mipSize(width, height, i);
+                
+                palette.indexedToRgb(data, size, buffers[i], tempColor);
+                if (i == 0)
+                    averageColor = tempColor;
+            }
+        }
+        
+        class MipTextureReader::MipTextureSource : public Assets::TextureSource {
+        private:
+            MappedFile::Ptr m_file;
+            Assets::Palette m_palette;
+            size_t m_width;
+            size_t m_height;
+            size_t m_offset[MipLayout::MipLevels];
+        public:
+            MipTextureSource(MappedFile::Ptr file, const Assets::Palette& palette, const size_t width, const size_t height, const size_t offset[]) :
+            m_file(file),
+            m_palette(palette),
+            m_width(width),
+            m_height(height) {
+                for (size_t i = 0; i < MipLayout::MipLevels; ++i)
+                    m_offset[i] = offset[i];
+            }
+        private:
+            void doDecode(Assets::TextureBuffer::Array& buffers, Color& averageColor) const {
+                decodeMips(m_file->begin(), m_palette, m_width, m_height, m_offset, buffers, averageColor);
+            }
+        };
+        
         MipTextureReader::MipTextureReader(const NameStrategy& nameStrategy) :
         TextureReader(nameStrategy) {}
         
@@ -45,33 +92,34 @@ namespace TrenchBroom {
         }
         
         Assets::Texture* MipTextureReader::doReadTexture(const char* const begin, const char* const end, const Path& path) const {
-            static const size_t MipLevels = 4;
-            
-            static Color tempColor, averageColor;
-            static Assets::TextureBuffer::Array buffers(MipLevels);
-            static size_t offset[MipLevels];
+            size_t offset[MipLayout::MipLevels];
             
             CharArrayReader reader(begin, end);
-            const String name = reader.readString(MipLayout::TextureNameLength);
-            const size_t width = reader.readSize<int32_t>();
-            const size_t height = reader.readSize<int32_t>();
-            for (size_t i = 0; i < MipLevels; ++i)
-                offset[i] = reader.readSize<int32_t>();
+            String name;
+            size_t width, height;
+            readMipHeader(reader, name, width, height, offset);
             
-            Assets::setMipBufferSize(buffers, width, height);
-            Assets::Palette palette = doGetPalette(reader, offset, width, height);
+            const Assets::Palette palette = doGetPalette(reader, offset, width, height);
             
-            for (size_t i = 0; i < MipLevels; ++i) {
-                const char* data = begin + offset[i];
-                const size_t size = mipSize(width, height, i);
-                
-                palette.indexedToRgb(data, size, buffers[i], tempColor);
-                if (i == 0)
-                    averageColor = tempColor;
-                
-            }
+            Color averageColor;
+            Assets::TextureBuffer::Array buffers;
+            decodeMips(begin, palette, width, height, offset, buffers, averageColor);
             
             return new Assets::Texture(textureName(name, path), width, height, averageColor, buffers);
         }
+        
+        Assets::Texture* MipTextureReader::doReadTextureFromFile(MappedFile::Ptr file) const {
+            size_t offset[MipLayout::MipLevels];
+            
+            CharArrayReader reader(file->begin(), file->end());
+            String name;
+            size_t width, height;
+            readMipHeader(reader, name, width, height, offset);
+            
+            const Assets::Palette palette = doGetPalette(reader, offset, width, height);
+            
+            // the mip levels are converted when the texture is first used, the file stays mapped until then
+            return new Assets::Texture(textureName(name, file->path()), width, height, new MipTextureSource(file, palette, width, height, offset));
+        }
     }
 }
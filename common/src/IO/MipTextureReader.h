@@ -29,6 +29,8 @@ namespace TrenchBroom {
         class CharArrayReader;
         
         class MipTextureReader : public TextureReader {
+        private:
+            class MipTextureSource;
         protected:
             MipTextureReader(const NameStrategy& nameStrategy);
         public:
@@ -37,6 +39,7 @@ namespace TrenchBroom {
             static size_t mipFileSize(size_t width, size_t height, size_t mipLevels);
         protected:
             Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const;
+            Assets::Texture* doReadTextureFromFile(MappedFile::Ptr file) const;
             virtual Assets::Palette doGetPalette(CharArrayReader& reader, const size_t offset[], size_t width, size_t height) const = 0;
         };
     }
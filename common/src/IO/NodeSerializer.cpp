@@ -27,17 +27,19 @@
 
 namespace TrenchBroom {
     namespace IO {
-        class NodeSerializer::BrushSerializer : public Model::NodeVisitor {
+        class NodeSerializer::CollectBrushes : public Model::NodeVisitor {
         private:
-            NodeSerializer& m_serializer;
+            Model::BrushArray m_brushes;
         public:
-            BrushSerializer(NodeSerializer& serializer) : m_serializer(serializer) {}
-            
+            const Model::BrushArray& brushes() const {
+                return m_brushes;
+            }
+        private:
             void doVisit(Model::World* world)   {}
             void doVisit(Model::Layer* layer)   {}
             void doVisit(Model::Group* group)   {}
             void doVisit(Model::Entity* entity) {}
-            void doVisit(Model::Brush* brush)   { m_serializer.brush(brush); }
+            void doVisit(Model::Brush* brush)   { m_brushes.push_back(brush); }
         };
 
         NodeSerializer::NodeSerializer() :
@@ -54,6 +56,10 @@ namespace TrenchBroom {
             return m_brushNo;
         }
 
+        void NodeSerializer::brushesWritten(const size_t count) {
+            m_brushNo += static_cast<ObjectNo>(count);
+        }
+
         void NodeSerializer::beginFile() {
             m_entityNo = 0;
             m_brushNo = 0;
@@ -79,8 +85,9 @@ namespace TrenchBroom {
         void NodeSerializer::entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, Model::Node* brushParent) {
             beginEntity(node, attributes, parentAttributes);
             
-            BrushSerializer brushSerializer(*this);
-            brushParent->iterate(brushSerializer);
+            CollectBrushes collectBrushes;
+            brushParent->iterate(collectBrushes);
+            brushes(collectBrushes.brushes());
             
             endEntity(node);
         }
@@ -91,6 +98,19 @@ namespace TrenchBroom {
             endEntity(node);
         }
 
+        void NodeSerializer::entity(const Model::EntityAttribute::List& attributes, const std::vector<Model::BrushFaceArray>& brushFaces) {
+            beginEntity(NULL);
+            entityAttributes(attributes);
+            
+            for (const Model::BrushFaceArray& faces : brushFaces) {
+                beginBrush(NULL);
+                this->brushFaces(faces);
+                endBrush(NULL);
+            }
+            
+            endEntity(NULL);
+        }
+
         void NodeSerializer::beginEntity(const Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& extraAttributes) {
             beginEntity(node);
             entityAttributes(attributes);
@@ -117,8 +137,7 @@ namespace TrenchBroom {
         }
         
         void NodeSerializer::brushes(const Model::BrushArray& brushes) {
-            std::for_each(std::begin(brushes), std::end(brushes),
-                          [this](Model::Brush* brush) { this->brush(brush); });
+            doBrushes(brushes);
         }
         
         void NodeSerializer::brush(Model::Brush* brush) {
@@ -145,6 +164,11 @@ namespace TrenchBroom {
             doBrushFace(face);
         }
         
+        void NodeSerializer::doBrushes(const Model::BrushArray& brushes) {
+            std::for_each(std::begin(brushes), std::end(brushes),
+                          [this](Model::Brush* brush) { this->brush(brush); });
+        }
+
         class NodeSerializer::GetParentAttributes : public Model::ConstNodeVisitor {
         private:
             const LayerIds& m_layerIds;
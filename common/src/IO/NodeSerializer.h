@@ -25,6 +25,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace TrenchBroom {
     namespace IO {
@@ -32,7 +33,7 @@ namespace TrenchBroom {
         
         class NodeSerializer {
         private:
-            class BrushSerializer;
+            class CollectBrushes;
         protected:
             static const int FloatPrecision = 17;
             typedef unsigned int ObjectNo;
@@ -78,6 +79,7 @@ namespace TrenchBroom {
         protected:
             ObjectNo entityNo() const;
             ObjectNo brushNo() const;
+            void brushesWritten(size_t count);
         public:
             void beginFile();
             void endFile();
@@ -88,6 +90,12 @@ namespace TrenchBroom {
             
             void entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, Model::Node* brushParent);
             void entity(Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& parentAttributes, const Model::BrushArray& entityBrushes);
+            
+            /**
+             Writes an entity which is not part of a world, such as a copy of an entity taken earlier. The entity
+             and its brushes are passed to the subclass as null nodes.
+             */
+            void entity(const Model::EntityAttribute::List& attributes, const std::vector<Model::BrushFaceArray>& brushFaces);
         private:
             void beginEntity(const Model::Node* node, const Model::EntityAttribute::List& attributes, const Model::EntityAttribute::List& extraAttributes);
             void beginEntity(const Model::Node* node);
@@ -123,6 +131,13 @@ namespace TrenchBroom {
             virtual void doBeginBrush(const Model::Brush* brush) = 0;
             virtual void doEndBrush(Model::Brush* brush) = 0;
             virtual void doBrushFace(Model::BrushFace* face) = 0;
+
+            /**
+             Writes the given brushes of the current entity. By default, every brush is written by calling
+             doBeginBrush, doBrushFace and doEndBrush. Overrides which write the brushes differently must call
+             brushesWritten to advance the brush numbers.
+             */
+            virtual void doBrushes(const Model::BrushArray& brushes);
         };
     }
 }
@@ -74,9 +74,13 @@ namespace TrenchBroom {
             throw ParserException(buildMessage(line, str));
         }
 
-        void ParserStatus::log(const Logger::LogLevel level, const size_t line, const size_t column, const String& str) {
+        void ParserStatus::log(const Logger::LogLevel level, const String& str) {
             if (m_logger != NULL)
-                m_logger->log(level, buildMessage(line, column, str));
+                m_logger->log(level, str);
+        }
+
+        void ParserStatus::log(const Logger::LogLevel level, const size_t line, const size_t column, const String& str) {
+            log(level, buildMessage(line, column, str));
         }
 
         String ParserStatus::buildMessage(const size_t line, const size_t column, const String& str) const {
@@ -86,8 +90,7 @@ namespace TrenchBroom {
         }
 
         void ParserStatus::log(const Logger::LogLevel level, const size_t line, const String& str) {
-            if (m_logger != NULL)
-                m_logger->log(level, buildMessage(line, str));
+            log(level, buildMessage(line, str));
         }
         
         String ParserStatus::buildMessage(const size_t line, const String& str) const {
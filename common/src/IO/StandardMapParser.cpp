@@ -23,40 +23,43 @@
 #include "SetAny.h"
 #include "Model/BrushFace.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace TrenchBroom {
     namespace IO {
-        const String& QuakeMapTokenizer::NumberDelim() {
-            static const String numberDelim(Whitespace() + ")");
-            return numberDelim;
-        }
-
         QuakeMapTokenizer::QuakeMapTokenizer(const char* begin, const char* end) :
         Tokenizer(begin, end),
         m_skipEol(true) {}
         
+        QuakeMapTokenizer::QuakeMapTokenizer(const char* begin, const char* end, const size_t firstLine) :
+        Tokenizer(begin, end, firstLine),
+        m_skipEol(true) {}
+        
         QuakeMapTokenizer::QuakeMapTokenizer(const String& str) :
         Tokenizer(str),
         m_skipEol(true) {}
         
         void QuakeMapTokenizer::setSkipEol(bool skipEol) {
             m_skipEol = skipEol;
+            discardLookahead();
         }
         
         QuakeMapTokenizer::Token QuakeMapTokenizer::emitToken() {
             while (!eof()) {
-                size_t startLine = line();
-                size_t startColumn = column();
+                const size_t startLine = line();
+                const size_t startColumn = column();
                 const char* c = curPos();
                 switch (*c) {
                     case '/':
-                        advance();
-                        if (curChar() == '/') {
-                            advance();
-                            if (curChar() == '/') {
-                                advance();
+                        if (lookAhead() == '/') {
+                            if (lookAhead(2) == '/') {
+                                advance(3);
                                 return Token(QuakeMapToken::Comment, c, c+3, offset(c), startLine, startColumn);
                             }
-                            discardUntil("\n\r");
+                            advance(static_cast<size_t>(findLineEnd(c + 2, endPos()) - c));
+                        } else {
+                            advance();
                         }
                         break;
                     case '{':
@@ -77,12 +80,8 @@ namespace TrenchBroom {
                     case ']':
                         advance();
                         return Token(QuakeMapToken::CBracket, c, c+1, offset(c), startLine, startColumn);
-                    case '"': { // quoted string
-                        advance();
-                        c = curPos();
-                        const char* e = readQuotedString();
-                        return Token(QuakeMapToken::String, c, e, offset(c), startLine, startColumn);
-                    }
+                    case '"':
+                        return emitQuotedString(c, startLine, startColumn);
                     case '\n':
                         if (!m_skipEol) {
                             advance();
@@ -91,31 +90,119 @@ namespace TrenchBroom {
                     case '\r':
                     case ' ':
                     case '\t':
-                        discardWhile(Whitespace());
+                        advance(static_cast<size_t>(skipWhitespace(c, endPos()) - c));
                         break;
-                    default: { // whitespace, integer, decimal or word
-                        const char* e = readInteger(NumberDelim());
-                        if (e != NULL)
-                            return Token(QuakeMapToken::Integer, c, e, offset(c), startLine, startColumn);
-                        
-                        e = readDecimal(NumberDelim());
-                        if (e != NULL)
-                            return Token(QuakeMapToken::Decimal, c, e, offset(c), startLine, startColumn);
-                        
-                        e = readUntil(Whitespace());
-                        if (e == NULL)
-                            throw ParserException(startLine, startColumn, "Unexpected character: " + String(c, 1));
-                        return Token(QuakeMapToken::String, c, e, offset(c), startLine, startColumn);
-                    }
+                    default: // integer, decimal or word
+                        return emitNumberOrString(c, startLine, startColumn);
                 }
             }
             return Token(QuakeMapToken::Eof, NULL, NULL, length(), line(), column());
         }
 
+        QuakeMapTokenizer::Token QuakeMapTokenizer::emitNumberOrString(const char* begin, const size_t line, const size_t column) {
+            // Numbers are recognized in a single pass. If the characters read so far turn out not to be a number,
+            // reading continues at the current position as a word.
+            const char* end = endPos();
+            const char* cur = begin;
+            
+            const bool signOrDigit = *cur == '+' || *cur == '-' || (*cur >= '0' && *cur <= '9');
+            if (signOrDigit) {
+                cur = skipDigits(cur + 1, end);
+                if (cur == end || isNumberDelimiter(*cur)) {
+                    advance(static_cast<size_t>(cur - begin));
+                    return Token(QuakeMapToken::Integer, begin, cur, offset(begin), line, column);
+                }
+            }
+            
+            if (signOrDigit || *cur == '.') {
+                if (*cur == '.')
+                    cur = skipDigits(cur + 1, end);
+                if (cur < end && *cur == 'e') {
+                    ++cur;
+                    if (cur < end && (*cur == '+' || *cur == '-' || (*cur >= '0' && *cur <= '9')))
+                        cur = skipDigits(cur + 1, end);
+                }
+                if (cur == end || isNumberDelimiter(*cur)) {
+                    advance(static_cast<size_t>(cur - begin));
+                    return Token(QuakeMapToken::Decimal, begin, cur, offset(begin), line, column);
+                }
+            }
+            
+            while (cur < end && !isWhitespace(*cur))
+                ++cur;
+            advance(static_cast<size_t>(cur - begin));
+            return Token(QuakeMapToken::String, begin, cur, offset(begin), line, column);
+        }
+
+        QuakeMapTokenizer::Token QuakeMapTokenizer::emitQuotedString(const char* begin, const size_t line, const size_t column) {
+            assert(*begin == '"');
+            
+            const char* end = endPos();
+            const char* cur = begin + 1;
+            bool escaped = false;
+            while (cur < end && (*cur != '"' || escaped)) {
+                escaped = *cur == '\\' && !escaped;
+                ++cur;
+            }
+            
+            if (cur == end)
+                throw ParserException("Unexpected end of file");
+            
+            advance(static_cast<size_t>(cur + 1 - begin));
+            return Token(QuakeMapToken::String, begin + 1, cur, offset(begin + 1), line, column);
+        }
+
+        const char* QuakeMapTokenizer::skipWhitespace(const char* cur, const char* end) {
+            while (cur < end && isWhitespace(*cur))
+                ++cur;
+            return cur;
+        }
+
+        const char* QuakeMapTokenizer::findLineEnd(const char* cur, const char* end) {
+            // Comments can be long, so look at eight characters at a time until we find a word which contains a
+            // line break.
+            static const uint64_t Ones  = 0x0101010101010101ULL;
+            static const uint64_t Highs = 0x8080808080808080ULL;
+            static const uint64_t LF = Ones * static_cast<uint64_t>('\n');
+            static const uint64_t CR = Ones * static_cast<uint64_t>('\r');
+            
+            while (end - cur >= 8) {
+                uint64_t word;
+                std::memcpy(&word, cur, sizeof(word));
+                const uint64_t lf = word ^ LF;
+                const uint64_t cr = word ^ CR;
+                if ((((lf - Ones) & ~lf) | ((cr - Ones) & ~cr)) & Highs)
+                    break;
+                cur += 8;
+            }
+            
+            while (cur < end && *cur != '\n' && *cur != '\r')
+                ++cur;
+            return cur;
+        }
+
+        const char* QuakeMapTokenizer::skipDigits(const char* cur, const char* end) {
+            while (cur < end && *cur >= '0' && *cur <= '9')
+                ++cur;
+            return cur;
+        }
+
+        bool QuakeMapTokenizer::isWhitespace(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        bool QuakeMapTokenizer::isNumberDelimiter(const char c) {
+            return isWhitespace(c) || c == ')';
+        }
+
         StandardMapParser::StandardMapParser(const char* begin, const char* end) :
         m_tokenizer(QuakeMapTokenizer(begin, end)),
         m_format(Model::MapFormat::Unknown) {}
         
+        StandardMapParser::StandardMapParser(const char* begin, const char* end, const size_t firstLine) :
+        m_tokenizer(QuakeMapTokenizer(begin, end, firstLine)),
+        m_format(Model::MapFormat::Unknown) {}
+        
         StandardMapParser::StandardMapParser(const String& str) :
         m_tokenizer(QuakeMapTokenizer(str)),
         m_format(Model::MapFormat::Unknown) {}
@@ -48,17 +48,29 @@ namespace TrenchBroom {
         
         class ParserStatus;
 
+        /**
+         Hand written tokenizer for the standard, Valve, Quake 2 and Hexen 2 map formats. Tokens are recognized by
+         scanning the input directly, and the tokenizer state is only advanced once per token.
+         */
         class QuakeMapTokenizer : public Tokenizer<QuakeMapToken::Type> {
         private:
-            static const String& NumberDelim();
             bool m_skipEol;
         public:
             QuakeMapTokenizer(const char* begin, const char* end);
+            QuakeMapTokenizer(const char* begin, const char* end, size_t firstLine);
             QuakeMapTokenizer(const String& str);
             
             void setSkipEol(bool skipEol);
         private:
             Token emitToken();
+            Token emitNumberOrString(const char* begin, size_t line, size_t column);
+            Token emitQuotedString(const char* begin, size_t line, size_t column);
+
+            static const char* skipWhitespace(const char* cur, const char* end);
+            static const char* findLineEnd(const char* cur, const char* end);
+            static const char* skipDigits(const char* cur, const char* end);
+            static bool isWhitespace(char c);
+            static bool isNumberDelimiter(char c);
         };
 
         class StandardMapParser : public MapParser, public Parser<QuakeMapToken::Type> {
@@ -70,6 +82,7 @@ namespace TrenchBroom {
             Model::MapFormat::Type m_format;
         public:
             StandardMapParser(const char* begin, const char* end);
+            StandardMapParser(const char* begin, const char* end, size_t firstLine);
             StandardMapParser(const String& str);
             
             virtual ~StandardMapParser();
@@ -0,0 +1,245 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCache.h"
+
+#include "CollectionUtils.h"
+#include "Exceptions.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "IO/CharArrayReader.h"
+#include "IO/DiskIO.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace TextureCacheLayout {
+            static const String Magic = "TBTC";
+            static const uint32_t Version = 2;
+            static const String Extension = "tbtc";
+        }
+        
+        template <typename T>
+        static T readValue(CharArrayReader& reader) {
+            if (!reader.canRead(sizeof(T)))
+                throw FileFormatException("Unexpected end of texture cache file");
+            return reader.read<T, T>();
+        }
+        
+        static String readString(CharArrayReader& reader) {
+            const size_t length = static_cast<size_t>(readValue<uint64_t>(reader));
+            if (!reader.canRead(length))
+                throw FileFormatException("Unexpected end of texture cache file");
+            
+            String result(length, 0);
+            reader.read(&result[0], length);
+            return result;
+        }
+        
+        static Assets::Texture* readTexture(CharArrayReader& reader) {
+            const String name = readString(reader);
+            const size_t width = static_cast<size_t>(readValue<uint64_t>(reader));
+            const size_t height = static_cast<size_t>(readValue<uint64_t>(reader));
+            const GLenum format = static_cast<GLenum>(readValue<uint32_t>(reader));
+            
+            Color averageColor;
+            for (size_t i = 0; i < 4; ++i)
+                averageColor[i] = readValue<float>(reader);
+            
+            // every buffer is preceded by its size, which bounds the number of buffers
+            const size_t bufferCount = static_cast<size_t>(readValue<uint64_t>(reader));
+            if (bufferCount > reader.size() / sizeof(uint64_t) || !reader.canRead(bufferCount * sizeof(uint64_t)))
+                throw FileFormatException("Unexpected end of texture cache file");
+            
+            Assets::TextureBuffer::Array buffers(bufferCount);
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                const size_t size = static_cast<size_t>(readValue<uint64_t>(reader));
+                if (!reader.canRead(size))
+                    throw FileFormatException("Unexpected end of texture cache file");
+                
+                buffers[i] = Assets::TextureBuffer(size);
+                reader.read(buffers[i].ptr(), size);
+            }
+            
+            return new Assets::Texture(name, width, height, averageColor, buffers, format);
+        }
+        
+        template <typename T>
+        static void writeValue(std::ostream& stream, const T value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+        
+        static void writeString(std::ostream& stream, const String& str) {
+            writeValue<uint64_t>(stream, str.size());
+            stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+        
+        static void writeTexture(std::ostream& stream, const Assets::Texture& texture) {
+            writeString(stream, texture.name());
+            writeValue<uint64_t>(stream, texture.width());
+            writeValue<uint64_t>(stream, texture.height());
+            writeValue<uint32_t>(stream, texture.format());
+            
+            const Color& averageColor = texture.averageColor();
+            for (size_t i = 0; i < 4; ++i)
+                writeValue<float>(stream, averageColor[i]);
+            
+            const Assets::TextureBuffer::Array& buffers = texture.buffers();
+            writeValue<uint64_t>(stream, buffers.size());
+            for (const Assets::TextureBuffer& buffer : buffers) {
+                writeValue<uint64_t>(stream, buffer.size());
+                stream.write(reinterpret_cast<const char*>(buffer.ptr()), static_cast<std::streamsize>(buffer.size()));
+            }
+        }
+        
+        TextureCache::TextureCache(const Path& directory, const String& key) :
+        m_directory(directory),
+        m_key(key) {}
+        
+        Assets::TextureCollection* TextureCache::readTextureCollection(const Path& path, const MappedFile::List& files) const {
+            if (m_directory.isEmpty())
+                return NULL;
+            
+            const Path filePath = cacheFilePath(path);
+            if (!Disk::fileExists(filePath))
+                return NULL;
+            
+            Assets::TextureList textures;
+            try {
+                const MappedFile::Ptr file = Disk::openFile(filePath);
+                CharArrayReader reader(file->begin(), file->end());
+                
+                if (readString(reader) != TextureCacheLayout::Magic || readValue<uint32_t>(reader) != TextureCacheLayout::Version)
+                    return NULL;
+                if (readString(reader) != m_key || readValue<uint64_t>(reader) != files.size())
+                    return NULL;
+                
+                for (const MappedFile::Ptr& textureFile : files) {
+                    const String sourcePath = readString(reader);
+                    const uint64_t sourceSize = readValue<uint64_t>(reader);
+                    const uint64_t sourceHash = readValue<uint64_t>(reader);
+                    
+                    if (sourcePath != textureFile->path().asString() ||
+                        sourceSize != textureFile->size() ||
+                        sourceHash != hash(textureFile->begin(), textureFile->end())) {
+                        VectorUtils::clearAndDelete(textures);
+                        return NULL;
+                    }
+                    
+                    textures.push_back(readTexture(reader));
+                }
+            } catch (const std::exception&) {
+                // a corrupt cache file may also cause allocation failures
+                VectorUtils::clearAndDelete(textures);
+                return NULL;
+            }
+            
+            return new Assets::TextureCollection(path, textures);
+        }
+        
+        void TextureCache::writeTextureCollection(const Path& path, const MappedFile::List& files, const Assets::TextureCollection& collection) const {
+            if (m_directory.isEmpty())
+                return;
+            
+            const Assets::TextureList& textures = collection.textures();
+            assert(textures.size() == files.size());
+            
+            // Textures which are decoded lazily are not decoded just to be cached, since that would make loading
+            // them as slow as decoding them. Textures without image data cannot be restored from the cache.
+            for (const Assets::Texture* texture : textures) {
+                if (!texture->decoded() || texture->buffers().empty())
+                    return;
+            }
+            
+            const Path filePath = cacheFilePath(path);
+            const Path tempFilePath = makeTempFilePath(filePath);
+            
+            try {
+                if (!Disk::directoryExists(m_directory))
+                    Disk::createDirectory(m_directory);
+                
+                {
+                    std::ofstream stream(tempFilePath.asString().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                    writeString(stream, TextureCacheLayout::Magic);
+                    writeValue<uint32_t>(stream, TextureCacheLayout::Version);
+                    writeString(stream, m_key);
+                    writeValue<uint64_t>(stream, files.size());
+                    
+                    for (size_t i = 0; i < files.size(); ++i) {
+                        const MappedFile::Ptr& textureFile = files[i];
+                        writeString(stream, textureFile->path().asString());
+                        writeValue<uint64_t>(stream, textureFile->size());
+                        writeValue<uint64_t>(stream, hash(textureFile->begin(), textureFile->end()));
+                        writeTexture(stream, *textures[i]);
+                    }
+                    
+                    if (!stream.good())
+                        throw FileSystemException("Could not write texture cache file '" + tempFilePath.asString() + "'");
+                }
+                
+                // replace the cache file only once it is complete
+                Disk::moveFile(tempFilePath, filePath, true);
+            } catch (const std::exception&) {
+                std::remove(tempFilePath.asString().c_str());
+            }
+        }
+        
+        uint64_t TextureCache::hash(const char* begin, const char* end, uint64_t seed) {
+            // 64 bit FNV-1a
+            static const uint64_t Prime = 1099511628211ULL;
+            
+            uint64_t result = seed;
+            for (const char* cur = begin; cur < end; ++cur) {
+                result ^= static_cast<uint64_t>(static_cast<unsigned char>(*cur));
+                result *= Prime;
+            }
+            return result;
+        }
+        
+        Path TextureCache::cacheFilePath(const Path& path) const {
+            const String pathStr = path.asString();
+            const uint64_t pathHash = hash(pathStr.data(), pathStr.data() + pathStr.size(), hash(m_key.data(), m_key.data() + m_key.size()));
+            
+            StringStream name;
+            name << std::hex << std::setw(16) << std::setfill('0') << pathHash << "." << TextureCacheLayout::Extension;
+            return m_directory + Path(name.str());
+        }
+        
+        Path TextureCache::makeTempFilePath(const Path& filePath) {
+            // several instances of the editor may write the same cache file at the same time
+            static std::random_device device;
+            static std::mutex mutex;
+            
+            uint64_t random;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                random = (static_cast<uint64_t>(device()) << 32) ^ static_cast<uint64_t>(device());
+            }
+            
+            StringStream extension;
+            extension << TextureCacheLayout::Extension << "." << std::hex << std::setw(16) << std::setfill('0') << random << ".tmp";
+            return filePath.replaceExtension(extension.str());
+        }
+    }
+}
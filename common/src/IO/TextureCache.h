@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TextureCache
+#define TrenchBroom_TextureCache
+
+#include "Macros.h"
+#include "StringUtils.h"
+#include "Assets/AssetTypes.h"
+#include "IO/MappedFile.h"
+#include "IO/Path.h"
+
+#ifdef _MSC_VER
+#include <cstdint>
+#elif defined __GNUC__
+#include <stdint.h>
+#endif
+
+namespace TrenchBroom {
+    namespace IO {
+        /**
+         Stores decoded texture collections on disk so that their textures need not be decoded again when the
+         collections are loaded the next time. A cached collection is only used if its texture files still have
+         the same sizes and contents as when the collection was cached.
+         
+         The given key must identify everything besides the texture files that affects how the textures are
+         decoded, e.g. the texture format and the palette.
+         
+         Only collections whose textures are decoded eagerly are cached, i.e. Quake 2 wal textures and image files.
+         Entity models are not cached; they are parsed one at a time when they are first needed.
+         */
+        class TextureCache {
+        private:
+            Path m_directory;
+            String m_key;
+        public:
+            /**
+             Creates a cache which stores its files in the given directory. If the directory is empty, nothing is
+             cached.
+             */
+            TextureCache(const Path& directory, const String& key);
+            
+            /**
+             Reads the cached collection at the given path with the given texture files. Returns null if the
+             collection is not cached or if the texture files have changed since it was cached.
+             */
+            Assets::TextureCollection* readTextureCollection(const Path& path, const MappedFile::List& files) const;
+            
+            /**
+             Caches the given collection, which must have been read from the given texture files. Nothing is cached
+             unless all textures of the collection have been decoded already, so collections whose textures are
+             decoded lazily are never cached. Errors are ignored since the cache is not essential.
+             */
+            void writeTextureCollection(const Path& path, const MappedFile::List& files, const Assets::TextureCollection& collection) const;
+            
+            static uint64_t hash(const char* begin, const char* end, uint64_t seed = 14695981039346656037ULL);
+        private:
+            Path cacheFilePath(const Path& path) const;
+            static Path makeTempFilePath(const Path& filePath);
+            
+            deleteCopyAndAssignment(TextureCache)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureCache) */
@@ -19,6 +19,8 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "CollectionUtils.h"
+#include "ParallelUtils.h"
 #include "Assets/AssetTypes.h"
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
@@ -39,14 +41,26 @@ namespace TrenchBroom {
         TextureCollectionLoader::~TextureCollectionLoader() {}
 
         Assets::TextureCollection* TextureCollectionLoader::loadTextureCollection(const Path& path, const String& textureExtension, const TextureReader& textureReader) {
-            std::unique_ptr<Assets::TextureCollection> collection(new Assets::TextureCollection(path));
-            
-            for (MappedFile::Ptr file : doFindTextures(path, textureExtension)) {
-                Assets::Texture* texture = textureReader.readTexture(file->begin(), file->end(), file->path());
-                collection->addTexture(texture);
+            return readTextureCollection(path, findTextures(path, textureExtension), textureReader);
+        }
+
+        MappedFile::List TextureCollectionLoader::findTextures(const Path& path, const String& textureExtension) {
+            return doFindTextures(path, textureExtension);
+        }
+
+        Assets::TextureCollection* TextureCollectionLoader::readTextureCollection(const Path& path, const MappedFile::List& files, const TextureReader& textureReader) {
+            Assets::TextureList textures(files.size(), NULL);
+            try {
+                ParallelUtils::parallelFor(files.size(), [&](const size_t i) {
+                    const MappedFile::Ptr file = files[i];
+                    textures[i] = textureReader.readTexture(file);
+                });
+            } catch (...) {
+                VectorUtils::clearAndDelete(textures);
+                throw;
             }
             
-            return collection.release();
+            return new Assets::TextureCollection(path, textures);
         }
 
         FileTextureCollectionLoader::FileTextureCollectionLoader(const IO::Path::List& searchPaths) :
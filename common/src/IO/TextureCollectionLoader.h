@@ -49,6 +49,17 @@ namespace TrenchBroom {
             virtual ~TextureCollectionLoader();
         public:
             Assets::TextureCollection* loadTextureCollection(const Path& path, const String& textureExtension, const TextureReader& textureReader);
+            
+            /**
+             Opens the texture files of the collection at the given path. The returned files remain valid on their
+             own, so they can be read on another thread.
+             */
+            MappedFile::List findTextures(const Path& path, const String& textureExtension);
+            
+            /**
+             Reads the given texture files into a new collection, decoding several textures in parallel.
+             */
+            static Assets::TextureCollection* readTextureCollection(const Path& path, const MappedFile::List& files, const TextureReader& textureReader);
         private:
             virtual MappedFile::Array doFindTextures(const Path& path, const String& extension) = 0;
         };
@@ -20,8 +20,8 @@
 #include "TextureLoader.h"
 
 #include "Assets/Palette.h"
-#include "Assets/TextureManager.h"
 #include "EL/Interpolator.h"
+#include "IO/FileSystem.h"
 #include "IO/FreeImageTextureReader.h"
 #include "IO/HlMipTextureReader.h"
 #include "IO/IdMipTextureReader.h"
@@ -32,13 +32,14 @@
 
 namespace TrenchBroom {
     namespace IO {
-        TextureLoader::TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::Array& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig) :
+        TextureLoader::TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::Array& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig, const Path& cacheDirectory) :
         m_variables(variables.clone()),
         m_gameFS(gameFS),
         m_fileSearchPaths(fileSearchPaths),
         m_textureExtension(getTextureExtension(textureConfig)),
         m_textureReader(createTextureReader(textureConfig)),
-        m_textureCollectionLoader(createTextureCollectionLoader(textureConfig)) {
+        m_textureCollectionLoader(createTextureCollectionLoader(textureConfig)),
+        m_cache(getCacheDirectory(textureConfig, cacheDirectory), getCacheKey(textureConfig)) {
             ensure(m_textureReader != NULL, "textureReader is null");
             ensure(m_textureCollectionLoader != NULL, "textureCollectionLoader is null");
         }
@@ -72,10 +73,34 @@ namespace TrenchBroom {
         }
         
         Assets::Palette TextureLoader::loadPalette(const Model::GameConfig::TextureConfig& textureConfig) const {
+            return Assets::Palette::loadFile(m_gameFS, palettePath(textureConfig));
+        }
+        
+        Path TextureLoader::palettePath(const Model::GameConfig::TextureConfig& textureConfig) const {
             const String pathSpec = textureConfig.palette.asString();
             const String pathStr = EL::interpolate(pathSpec, EL::EvaluationContext(*m_variables));
-            const Path path(pathStr);
-            return Assets::Palette::loadFile(m_gameFS, path);
+            return Path(pathStr);
+        }
+        
+        Path TextureLoader::getCacheDirectory(const Model::GameConfig::TextureConfig& textureConfig, const Path& cacheDirectory) const {
+            // mip textures are only decoded when they are first used, so loading them is cheaper than validating a
+            // cache file against the hashes of all texture files, and their collections are never cached anyway
+            if (textureConfig.format.format == "idmip" || textureConfig.format.format == "hlmip")
+                return Path("");
+            return cacheDirectory;
+        }
+        
+        String TextureLoader::getCacheKey(const Model::GameConfig::TextureConfig& textureConfig) const {
+            StringStream key;
+            key << textureConfig.format.format << ":" << textureConfig.format.extension;
+            
+            // the decoded textures depend on the contents of the palette
+            if (textureConfig.format.format == "idwal") {
+                const MappedFile::Ptr paletteFile = m_gameFS.openFile(palettePath(textureConfig));
+                key << ":" << TextureCache::hash(paletteFile->begin(), paletteFile->end());
+            }
+            
+            return key.str();
         }
 
         TextureCollectionLoader* TextureLoader::createTextureCollectionLoader(const Model::GameConfig::TextureConfig& textureConfig) const {
@@ -92,11 +117,20 @@ namespace TrenchBroom {
         }
 
         Assets::TextureCollection* TextureLoader::loadTextureCollection(const Path& path) {
-            return m_textureCollectionLoader->loadTextureCollection(path, m_textureExtension, *m_textureReader);
+            return readTextureCollection(path, findTextures(path));
         }
 
-        void TextureLoader::loadTextures(const Path::Array& paths, Assets::TextureManager& textureManager) {
-            textureManager.setTextureCollections(paths, *this);
+        MappedFile::List TextureLoader::findTextures(const Path& path) {
+            return m_textureCollectionLoader->findTextures(path, m_textureExtension);
+        }
+        
+        Assets::TextureCollection* TextureLoader::readTextureCollection(const Path& path, const MappedFile::List& files) const {
+            Assets::TextureCollection* collection = m_cache.readTextureCollection(path, files);
+            if (collection == NULL) {
+                collection = TextureCollectionLoader::readTextureCollection(path, files, *m_textureReader);
+                m_cache.writeTextureCollection(path, files, *collection);
+            }
+            return collection;
         }
     }
 }
@@ -24,15 +24,18 @@
 #include "EL.h"
 #include "StringUtils.h"
 #include "Assets/AssetTypes.h"
+#include "IO/MappedFile.h"
 #include "IO/Path.h"
+#include "IO/TextureCache.h"
 #include "Model/GameConfig.h"
 
+#include <memory>
+
 namespace TrenchBroom {
     class VariableTable;
 
     namespace Assets {
         class Palette;
-        class TextureManager;
     }
     
     namespace IO {
@@ -41,6 +44,8 @@ namespace TrenchBroom {
         class TextureReader;
         
         class TextureLoader {
+        public:
+            typedef std::shared_ptr<TextureLoader> Ptr;
         private:
             const EL::VariableStore* m_variables;
             const FileSystem& m_gameFS;
@@ -48,17 +53,31 @@ namespace TrenchBroom {
             String m_textureExtension;
             TextureReader* m_textureReader;
             TextureCollectionLoader* m_textureCollectionLoader;
+            TextureCache m_cache;
         public:
-            TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig);
+            /**
+             Decoded texture collections are cached in the given directory. If the directory is empty, nothing is
+             cached. Collections of mip textures are never cached since their textures are decoded lazily.
+             */
+            TextureLoader(const EL::VariableStore& variables, const FileSystem& gameFS, const IO::Path::List& fileSearchPaths, const Model::GameConfig::TextureConfig& textureConfig, const Path& cacheDirectory);
             ~TextureLoader();
         private:
             String getTextureExtension(const Model::GameConfig::TextureConfig& textureConfig) const;
             TextureReader* createTextureReader(const Model::GameConfig::TextureConfig& textureConfig) const;
             Assets::Palette loadPalette(const Model::GameConfig::TextureConfig& textureConfig) const;
+            Path palettePath(const Model::GameConfig::TextureConfig& textureConfig) const;
+            Path getCacheDirectory(const Model::GameConfig::TextureConfig& textureConfig, const Path& cacheDirectory) const;
+            String getCacheKey(const Model::GameConfig::TextureConfig& textureConfig) const;
             TextureCollectionLoader* createTextureCollectionLoader(const Model::GameConfig::TextureConfig& textureConfig) const;
         public:
             Assets::TextureCollection* loadTextureCollection(const Path& path);
-            void loadTextures(const Path::List& paths, Assets::TextureManager& textureManager);
+            
+            /**
+             Loading a collection is split into two steps. Finding its textures uses the game file system and must
+             happen on the main thread, while reading the found textures may happen on any thread.
+             */
+            MappedFile::List findTextures(const Path& path);
+            Assets::TextureCollection* readTextureCollection(const Path& path, const MappedFile::List& files) const;
 
             deleteCopyAndAssignment(TextureLoader)
         };
@@ -81,6 +81,12 @@ namespace TrenchBroom {
             String textureName(const String& textureName, const Path& path) const;
         private:
             virtual Assets::Texture* doReadTexture(const char* const begin, const char* const end, const Path& path) const = 0;
+            
+            /**
+             Reads a texture from the given file. Readers may keep a reference to the file to defer decoding the
+             image data until the texture is used. By default, the texture is read immediately.
+             */
+            virtual Assets::Texture* doReadTextureFromFile(MappedFile::Ptr file) const;
         public:
             static size_t mipSize(size_t width, size_t height, size_t mipLevel);
             
@@ -94,25 +94,103 @@ namespace TrenchBroom {
             
             template <typename T>
             T toFloat() const {
-                static const size_t BufferSize = 256;
-                static char buffer[BufferSize];
-                assert(length() < BufferSize);
-                
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T f = static_cast<T>(std::atof(buffer));
-                return f;
+                double result;
+                if (!parseDecimal(m_begin, m_end, result)) {
+                    static const size_t BufferSize = 256;
+                    char buffer[BufferSize];
+                    assert(length() < BufferSize);
+                    
+                    memcpy(buffer, m_begin, length());
+                    buffer[length()] = 0;
+                    result = std::atof(buffer);
+                }
+                return static_cast<T>(result);
             }
             
             template <typename T>
             T toInteger() const {
-                static char buffer[64];
-                assert(length() < 64);
+                const char* cur = m_begin;
+                while (cur < m_end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r'))
+                    ++cur;
+                
+                const bool negative = cur < m_end && *cur == '-';
+                if (cur < m_end && (*cur == '-' || *cur == '+'))
+                    ++cur;
+                
+                long result = 0;
+                while (cur < m_end && *cur >= '0' && *cur <= '9')
+                    result = 10 * result + (*cur++ - '0');
+                return static_cast<T>(negative ? -result : result);
+            }
+        private:
+            /**
+             Converts the given decimal number directly if this can be done exactly, that is, if the number has at
+             most 15 significant digits and its exponent is small enough to be represented exactly by a double.
+             Returns false for all other input, which must then be converted by the C library.
+             */
+            static bool parseDecimal(const char* cur, const char* end, double& result) {
+                static const double PowersOfTen[] = {
+                    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+                static const int MaxExponent = 22;
+                static const size_t MaxDigits = 15;
+
+                const bool negative = cur < end && *cur == '-';
+                if (cur < end && (*cur == '-' || *cur == '+'))
+                    ++cur;
+                
+                unsigned long long mantissa = 0;
+                size_t digits = 0;
+                int exponent = 0;
+                bool hasDigits = false;
+                bool fraction = false;
+                
+                for (; cur < end; ++cur) {
+                    if (*cur >= '0' && *cur <= '9') {
+                        hasDigits = true;
+                        if (mantissa > 0 || *cur != '0') {
+                            if (++digits > MaxDigits)
+                                return false;
+                            mantissa = 10 * mantissa + static_cast<unsigned long long>(*cur - '0');
+                        }
+                        if (fraction)
+                            --exponent;
+                    } else if (*cur == '.' && !fraction) {
+                        fraction = true;
+                    } else {
+                        break;
+                    }
+                }
+                
+                if (!hasDigits)
+                    return false;
+                
+                if (cur < end && (*cur == 'e' || *cur == 'E')) {
+                    ++cur;
+                    const bool negativeExponent = cur < end && *cur == '-';
+                    if (cur < end && (*cur == '-' || *cur == '+'))
+                        ++cur;
+                    if (cur == end)
+                        return false;
+                    
+                    int e = 0;
+                    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+                        if (e > 2 * MaxExponent)
+                            return false;
+                        e = 10 * e + (*cur - '0');
+                    }
+                    exponent += negativeExponent ? -e : e;
+                }
+                
+                if (cur != end || exponent < -MaxExponent || exponent > MaxExponent)
+                    return false;
                 
-                memcpy(buffer, m_begin, length());
-                buffer[length()] = 0;
-                const T i = static_cast<T>(std::atoi(buffer));
-                return i;
+                const double value = static_cast<double>(mantissa);
+                result = exponent < 0 ? value / PowersOfTen[-exponent] : value * PowersOfTen[exponent];
+                if (negative)
+                    result = -result;
+                return true;
             }
         };
     }
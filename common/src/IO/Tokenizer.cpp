@@ -19,13 +19,25 @@
 
 #include "Tokenizer.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace IO {
         TokenizerState::TokenizerState(const char* begin, const char* end) :
         m_begin(begin),
         m_cur(m_begin),
         m_end(end),
-        m_line(1),
+        m_firstLine(1),
+        m_line(m_firstLine),
+        m_column(1),
+        m_escaped(false) {}
+        
+        TokenizerState::TokenizerState(const char* begin, const char* end, const size_t firstLine) :
+        m_begin(begin),
+        m_cur(m_begin),
+        m_end(end),
+        m_firstLine(firstLine),
+        m_line(m_firstLine),
         m_column(1),
         m_escaped(false) {}
         
@@ -81,8 +93,29 @@ namespace TrenchBroom {
         }
         
         void TokenizerState::advance(const size_t offset) {
-            for (size_t i = 0; i < offset; ++i)
-                advance();
+            if (offset > static_cast<size_t>(m_end - m_cur))
+                throw ParserException("Unexpected end of file");
+            
+            const char* end = m_cur + offset;
+            
+            // only the backslashes immediately before the new position determine whether it is escaped
+            const char* backslashes = end;
+            while (backslashes > m_cur && *(backslashes - 1) == '\\')
+                --backslashes;
+            const bool oddBackslashes = (end - backslashes) % 2 == 1;
+            m_escaped = backslashes == m_cur ? m_escaped != oddBackslashes : oddBackslashes;
+            
+            const size_t newlines = static_cast<size_t>(std::count(m_cur, end, '\n'));
+            if (newlines > 0) {
+                const char* lineStart = end;
+                while (*(lineStart - 1) != '\n')
+                    --lineStart;
+                m_line += newlines;
+                m_column = 1 + static_cast<size_t>(end - lineStart);
+            } else {
+                m_column += offset;
+            }
+            m_cur = end;
         }
         
         void TokenizerState::advance() {
@@ -108,7 +141,7 @@ namespace TrenchBroom {
         
         void TokenizerState::reset() {
             m_cur = m_begin;
-            m_line = 1;
+            m_line = m_firstLine;
             m_column = 1;
             m_escaped = false;
         }
@@ -57,11 +57,13 @@ namespace TrenchBroom {
             const char* m_begin;
             const char* m_cur;
             const char* m_end;
+            size_t m_firstLine;
             size_t m_line;
             size_t m_column;
             bool m_escaped;
         public:
             TokenizerState(const char* begin, const char* end);
+            TokenizerState(const char* begin, const char* end, size_t firstLine);
             
             size_t length() const;
             const char* begin() const;
@@ -101,21 +103,13 @@ namespace TrenchBroom {
 
             typedef std::shared_ptr<TokenizerState> StatePtr;
 
-            class SaveState {
-            private:
-                StatePtr m_state;
-                TokenizerState::Snapshot m_snapshot;
-            public:
-                SaveState(StatePtr state) :
-                m_state(state),
-                m_snapshot(m_state->snapshot()) {}
-                
-                ~SaveState() {
-                    m_state->restore(m_snapshot);
-                }
-            };
-
             StatePtr m_state;
+
+            // one token lookahead: the token following m_lookaheadPos and the state after that token
+            const char* m_lookaheadPos;
+            bool m_hasLookahead;
+            Token m_lookahead;
+            TokenizerState::Snapshot m_lookaheadEnd;
             
             template <typename T> friend class Tokenizer;
         public:
@@ -125,27 +119,62 @@ namespace TrenchBroom {
             }
         public:
             Tokenizer(const char* begin, const char* end) :
-            m_state(new TokenizerState(begin, end)) {}
+            m_state(new TokenizerState(begin, end)),
+            m_lookaheadPos(NULL),
+            m_hasLookahead(false),
+            m_lookaheadEnd(m_state->snapshot()) {}
+
+            Tokenizer(const char* begin, const char* end, const size_t firstLine) :
+            m_state(new TokenizerState(begin, end, firstLine)),
+            m_lookaheadPos(NULL),
+            m_hasLookahead(false),
+            m_lookaheadEnd(m_state->snapshot()) {}
 
             Tokenizer(const String& str) :
-            m_state(new TokenizerState(str.c_str(), str.c_str() + str.size())) {}
+            m_state(new TokenizerState(str.c_str(), str.c_str() + str.size())),
+            m_lookaheadPos(NULL),
+            m_hasLookahead(false),
+            m_lookaheadEnd(m_state->snapshot()) {}
 
             template <typename OtherType>
             Tokenizer(Tokenizer<OtherType>& nestedTokenizer) :
-            m_state(nestedTokenizer.m_state) {}
+            m_state(nestedTokenizer.m_state),
+            m_lookaheadPos(NULL),
+            m_hasLookahead(false),
+            m_lookaheadEnd(m_state->snapshot()) {}
             
             Tokenizer(const Tokenizer& other) :
-            m_state(other.m_state) {}
+            m_state(other.m_state),
+            m_lookaheadPos(other.m_lookaheadPos),
+            m_hasLookahead(other.m_hasLookahead),
+            m_lookahead(other.m_lookahead),
+            m_lookaheadEnd(other.m_lookaheadEnd) {}
             
             virtual ~Tokenizer() {}
 
             Token nextToken() {
+                if (hasLookahead()) {
+                    m_state->restore(m_lookaheadEnd);
+                    discardLookahead();
+                    return m_lookahead;
+                }
                 return emitToken();
             }
 
+            /**
+             Returns the next token without consuming it. The token is kept until it is consumed by nextToken() or
+             until the tokenizer moves elsewhere, so peeking repeatedly does not emit the token again.
+             */
             Token peekToken() {
-                SaveState oldState(m_state);
-                return nextToken();
+                if (!hasLookahead()) {
+                    const TokenizerState::Snapshot previous = m_state->snapshot();
+                    m_lookahead = emitToken();
+                    m_lookaheadEnd = m_state->snapshot();
+                    m_state->restore(previous);
+                    m_lookaheadPos = curPos();
+                    m_hasLookahead = true;
+                }
+                return m_lookahead;
             }
 
             String readRemainder(const TokenType delimiterType) {
@@ -173,6 +202,7 @@ namespace TrenchBroom {
 
             void reset() {
                 m_state->reset();
+                discardLookahead();
             }
 
             double progress() const {
@@ -206,7 +236,18 @@ namespace TrenchBroom {
             void restore(const TokenizerState::Snapshot& snapshot) {
                 m_state->restore(snapshot);
             }
+        private:
+            // The state may be shared with nested tokenizers, so the lookahead is only valid while the state has
+            // not moved away from the position where the lookahead token was read.
+            bool hasLookahead() const {
+                return m_hasLookahead && m_lookaheadPos == curPos();
+            }
         protected:
+            void discardLookahead() {
+                m_hasLookahead = false;
+                m_lookaheadPos = NULL;
+            }
+
             size_t offset(const char* ptr) const {
                 return m_state->offset(ptr);
             }
@@ -215,6 +256,10 @@ namespace TrenchBroom {
                 return m_state->curPos();
             }
 
+            const char* endPos() const {
+                return m_state->end();
+            }
+
             char curChar() const {
                 if (eof())
                     return 0;
@@ -0,0 +1,592 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_AABBTree
+#define TrenchBroom_AABBTree
+
+#include "Exceptions.h"
+#include "MathUtils.h"
+#include "VecMath.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         A bounding volume hierarchy of axis aligned bounding boxes, stored in a flat array of nodes in depth first
+         order. The tree is built using the surface area heuristic.
+
+         Objects that are added after the tree was built are kept in a list of pending objects which is searched
+         linearly, and removed objects are only marked as such. If there are too many pending objects, the tree is
+         rebuilt by the next query, so that adding many objects at once only builds the tree once. Consequently,
+         queries must not be run concurrently with each other. Updating an object's bounds refits the nodes on the
+         path to the root, unless the object has moved too far away from its leaf, in which case it is reinserted as a
+         pending object. Once there are too many removed objects or too many refits, the tree is rebuilt,
+         so that the cost of rebuilding is amortized over the modifications.
+         */
+        template <typename F, typename T>
+        class AABBTree {
+        public:
+            typedef std::vector<T> List;
+            typedef BBox<F,3> Box;
+        private:
+            static const size_t NoNode = static_cast<size_t>(-1);
+            static const size_t MaxLeafSize = 4;
+            static const size_t BinCount = 16;
+            static const size_t MinRebuildThreshold = 64;
+
+            struct Entry {
+                Box bounds;
+                Vec<F,3> center;
+                T object;
+                size_t leaf;
+                bool removed;
+
+                Entry(const Box& i_bounds, T i_object) :
+                bounds(i_bounds),
+                center(i_bounds.center()),
+                object(i_object),
+                leaf(NoNode),
+                removed(false) {}
+            };
+
+            /**
+             An inner node's left child immediately follows it, and its right child is at index first. A leaf
+             references the entries in [first, first + count).
+             */
+            struct Node {
+                Box bounds;
+                size_t parent;
+                size_t first;
+                size_t count;
+
+                Node(const size_t i_parent) :
+                parent(i_parent),
+                first(0),
+                count(0) {}
+
+                bool leaf() const {
+                    return count > 0;
+                }
+            };
+
+            struct Bin {
+                Box bounds;
+                size_t count;
+
+                Bin() : count(0) {}
+
+                void add(const Box& box) {
+                    if (count == 0)
+                        bounds = box;
+                    else
+                        bounds.mergeWith(box);
+                    ++count;
+                }
+            };
+
+            typedef std::vector<Entry> EntryList;
+            typedef std::vector<Node> NodeList;
+            typedef std::unordered_map<T, size_t> EntryMap;
+
+            Box m_bounds;
+            // the tree is rebuilt lazily when it is queried
+            mutable EntryList m_entries;
+            mutable NodeList m_nodes;
+            mutable EntryMap m_entryMap;
+
+            mutable size_t m_indexedCount;
+            mutable size_t m_removedCount;
+            mutable size_t m_refitCount;
+        public:
+            AABBTree(const Box& bounds) :
+            m_bounds(bounds),
+            m_indexedCount(0),
+            m_removedCount(0),
+            m_refitCount(0) {}
+
+            const Box& bounds() const {
+                return m_bounds;
+            }
+
+            size_t size() const {
+                return m_entryMap.size();
+            }
+
+            bool empty() const {
+                return m_entryMap.empty();
+            }
+
+            void addObject(const Box& bounds, T object) {
+                if (!m_bounds.contains(bounds))
+                    throw AABBTreeException("Object is too large for this tree");
+                if (m_entryMap.count(object) > 0)
+                    throw AABBTreeException("Object is already contained in this tree");
+
+                m_entryMap.insert(std::make_pair(object, m_entries.size()));
+                m_entries.push_back(Entry(bounds, object));
+            }
+
+            void removeObject(T object) {
+                typename EntryMap::iterator it = m_entryMap.find(object);
+                if (it == std::end(m_entryMap))
+                    throw AABBTreeException("Cannot find object in tree");
+
+                m_entries[it->second].removed = true;
+                m_entryMap.erase(it);
+
+                if (++m_removedCount > rebuildThreshold(4))
+                    rebuild();
+            }
+
+            void updateObject(const Box& bounds, T object) {
+                typename EntryMap::iterator it = m_entryMap.find(object);
+                if (it == std::end(m_entryMap))
+                    throw AABBTreeException("Cannot find object in tree");
+                if (!m_bounds.contains(bounds))
+                    throw AABBTreeException("Object is too large for this tree");
+
+                Entry& entry = m_entries[it->second];
+                if (entry.leaf == NoNode || canRefit(m_nodes[entry.leaf], bounds)) {
+                    entry.bounds = bounds;
+                    entry.center = bounds.center();
+                    if (entry.leaf != NoNode) {
+                        refit(entry.leaf);
+                        if (++m_refitCount > rebuildThreshold(2))
+                            rebuild();
+                    }
+                } else {
+                    // the object has moved too far away from its leaf, so it is reinserted instead
+                    entry.removed = true;
+                    it->second = m_entries.size();
+                    m_entries.push_back(Entry(bounds, object));
+
+                    if (++m_removedCount > rebuildThreshold(4))
+                        rebuild();
+                }
+            }
+
+            bool containsObject(const Box& bounds, T object) const {
+                typename EntryMap::const_iterator it = m_entryMap.find(object);
+                if (it == std::end(m_entryMap))
+                    return false;
+                return m_entries[it->second].bounds == bounds;
+            }
+
+            void clear() {
+                m_entries.clear();
+                m_nodes.clear();
+                m_entryMap.clear();
+                m_indexedCount = 0;
+                m_removedCount = 0;
+                m_refitCount = 0;
+            }
+
+            /**
+             Returns every object whose bounds are hit by the given ray, in no particular order.
+             */
+            List findObjects(const Ray<F,3>& ray) const {
+                const Vec<F,3> invDirection = invert(ray.direction);
+                List result;
+                traverse([&ray, &invDirection](const Box& box) { return !Math::isnan(intersectWithRay(box, ray, invDirection)); },
+                         [&result](const Entry& entry) { result.push_back(entry.object); });
+                return result;
+            }
+
+            /**
+             Returns every object whose bounds are within some distance of the given ray, where the distance may vary
+             along the ray, e.g. to find handles whose size depends on the distance to the camera. For a given box,
+             the given function must return an upper bound of the distance for all points within the box.
+             */
+            template <typename D>
+            List findObjectsNearRay(const Ray<F,3>& ray, D maxDistance) const {
+                const Vec<F,3> invDirection = invert(ray.direction);
+                List result;
+                traverse([&ray, &invDirection, &maxDistance](const Box& box) { return !Math::isnan(intersectWithRay(box.expanded(maxDistance(box)), ray, invDirection)); },
+                         [&result](const Entry& entry) { result.push_back(entry.object); });
+                return result;
+            }
+
+            List findObjects(const Vec<F,3>& point) const {
+                List result;
+                traverse([&point](const Box& box) { return box.contains(point); },
+                         [&result](const Entry& entry) { result.push_back(entry.object); });
+                return result;
+            }
+
+            List findObjects(const Box& bounds) const {
+                List result;
+                traverse([&bounds](const Box& box) { return box.intersects(bounds); },
+                         [&result](const Entry& entry) { result.push_back(entry.object); });
+                return result;
+            }
+
+            /**
+             Returns every object whose bounds are not entirely in front of any of the given planes. If the planes
+             bound a convex volume such as a view frustum and their normals point outwards, the result contains every
+             object that may intersect the volume.
+             */
+            List findObjects(const typename Plane<F,3>::List& planes) const {
+                List result;
+                traverse([&planes](const Box& box) { return !outside(box, planes); },
+                         [&result](const Entry& entry) { result.push_back(entry.object); });
+                return result;
+            }
+
+            /**
+             Finds the object that is hit first by the given ray. The given function is called with an object and
+             must return the distance at which the ray hits it, or NaN if the ray misses it. It is called for the
+             objects in order of their bounds' distance to the ray origin, and objects whose bounds are farther away
+             than the closest hit found so far are skipped.
+
+             Returns true and sets object and distance if any object was hit.
+             */
+            template <typename H>
+            bool findNearest(const Ray<F,3>& ray, H intersect, T& object, F& distance) const {
+                validate();
+
+                const Vec<F,3> invDirection = invert(ray.direction);
+                bool found = false;
+                F closest = std::numeric_limits<F>::max();
+
+                const auto visit = [&](const Entry& entry) {
+                    const F boxDistance = intersectWithRay(entry.bounds, ray, invDirection);
+                    if (!Math::isnan(boxDistance) && boxDistance <= closest) {
+                        const F hitDistance = intersect(entry.object);
+                        if (!Math::isnan(hitDistance) && hitDistance < closest) {
+                            closest = hitDistance;
+                            object = entry.object;
+                            found = true;
+                        }
+                    }
+                };
+
+                for (size_t i = m_indexedCount; i < m_entries.size(); ++i) {
+                    if (!m_entries[i].removed)
+                        visit(m_entries[i]);
+                }
+
+                if (!m_nodes.empty()) {
+                    typedef std::pair<size_t, F> StackEntry;
+                    std::vector<StackEntry> stack;
+                    stack.reserve(64);
+
+                    const F rootDistance = intersectWithRay(m_nodes.front().bounds, ray, invDirection);
+                    if (!Math::isnan(rootDistance))
+                        stack.push_back(StackEntry(0, rootDistance));
+
+                    while (!stack.empty()) {
+                        const StackEntry current = stack.back();
+                        stack.pop_back();
+                        if (current.second > closest)
+                            continue;
+
+                        const Node& node = m_nodes[current.first];
+                        if (node.leaf()) {
+                            for (size_t i = node.first; i < node.first + node.count; ++i) {
+                                if (!m_entries[i].removed)
+                                    visit(m_entries[i]);
+                            }
+                        } else {
+                            const size_t left = current.first + 1;
+                            const size_t right = node.first;
+                            const F leftDistance = intersectWithRay(m_nodes[left].bounds, ray, invDirection);
+                            const F rightDistance = intersectWithRay(m_nodes[right].bounds, ray, invDirection);
+
+                            // push the farther child first so that the nearer child is visited first
+                            if (Math::isnan(leftDistance)) {
+                                if (!Math::isnan(rightDistance))
+                                    stack.push_back(StackEntry(right, rightDistance));
+                            } else if (Math::isnan(rightDistance)) {
+                                stack.push_back(StackEntry(left, leftDistance));
+                            } else if (leftDistance <= rightDistance) {
+                                stack.push_back(StackEntry(right, rightDistance));
+                                stack.push_back(StackEntry(left, leftDistance));
+                            } else {
+                                stack.push_back(StackEntry(left, leftDistance));
+                                stack.push_back(StackEntry(right, rightDistance));
+                            }
+                        }
+                    }
+                }
+
+                if (found)
+                    distance = closest;
+                return found;
+            }
+        private:
+            size_t pendingCount() const {
+                return m_entries.size() - m_indexedCount;
+            }
+
+            size_t rebuildThreshold(const size_t divisor) const {
+                return std::max(MinRebuildThreshold, m_indexedCount / divisor);
+            }
+
+            /**
+             Refitting a leaf to bounds that are far away from the leaf's other objects would make the tree much less
+             efficient, so this is only done if it does not increase the leaf's surface area by too much.
+             */
+            static bool canRefit(const Node& leaf, const Box& bounds) {
+                return area(leaf.bounds.mergedWith(bounds)) <= static_cast<F>(2.0) * area(leaf.bounds);
+            }
+
+            template <typename NodeTest, typename EntryVisitor>
+            void traverse(NodeTest test, EntryVisitor visit) const {
+                validate();
+
+                for (size_t i = m_indexedCount; i < m_entries.size(); ++i) {
+                    const Entry& entry = m_entries[i];
+                    if (!entry.removed && test(entry.bounds))
+                        visit(entry);
+                }
+
+                if (m_nodes.empty())
+                    return;
+
+                std::vector<size_t> stack;
+                stack.reserve(64);
+                stack.push_back(0);
+
+                while (!stack.empty()) {
+                    const size_t index = stack.back();
+                    stack.pop_back();
+
+                    const Node& node = m_nodes[index];
+                    if (!test(node.bounds))
+                        continue;
+
+                    if (node.leaf()) {
+                        for (size_t i = node.first; i < node.first + node.count; ++i) {
+                            const Entry& entry = m_entries[i];
+                            if (!entry.removed && test(entry.bounds))
+                                visit(entry);
+                        }
+                    } else {
+                        stack.push_back(node.first);
+                        stack.push_back(index + 1);
+                    }
+                }
+            }
+
+            void refit(size_t index) {
+                Node& leaf = m_nodes[index];
+                leaf.bounds = m_entries[leaf.first].bounds;
+                for (size_t i = leaf.first + 1; i < leaf.first + leaf.count; ++i)
+                    leaf.bounds.mergeWith(m_entries[i].bounds);
+
+                index = leaf.parent;
+                while (index != NoNode) {
+                    Node& node = m_nodes[index];
+                    const Box bounds = m_nodes[index + 1].bounds.mergedWith(m_nodes[node.first].bounds);
+                    if (bounds == node.bounds)
+                        break;
+                    node.bounds = bounds;
+                    index = node.parent;
+                }
+            }
+
+            void validate() const {
+                if (pendingCount() > rebuildThreshold(64))
+                    rebuild();
+            }
+
+            void rebuild() const {
+                EntryList entries;
+                entries.reserve(m_entryMap.size());
+                for (const Entry& entry : m_entries) {
+                    if (!entry.removed)
+                        entries.push_back(entry);
+                }
+
+                using std::swap;
+                swap(m_entries, entries);
+
+                m_nodes.clear();
+                if (!m_entries.empty()) {
+                    m_nodes.reserve(2 * (m_entries.size() / MaxLeafSize + 1));
+                    build(0, m_entries.size(), NoNode);
+                }
+
+                m_entryMap.clear();
+                for (size_t i = 0; i < m_entries.size(); ++i)
+                    m_entryMap.insert(std::make_pair(m_entries[i].object, i));
+
+                m_indexedCount = m_entries.size();
+                m_removedCount = 0;
+                m_refitCount = 0;
+            }
+
+            size_t build(const size_t first, const size_t last, const size_t parent) const {
+                const size_t index = m_nodes.size();
+                m_nodes.push_back(Node(parent));
+
+                Box bounds = m_entries[first].bounds;
+                Box centerBounds(m_entries[first].center, m_entries[first].center);
+                for (size_t i = first + 1; i < last; ++i) {
+                    bounds.mergeWith(m_entries[i].bounds);
+                    centerBounds.mergeWith(m_entries[i].center);
+                }
+                m_nodes[index].bounds = bounds;
+
+                const size_t count = last - first;
+                const size_t mid = count <= MaxLeafSize ? first : split(first, last, bounds, centerBounds);
+
+                if (mid == first) {
+                    m_nodes[index].first = first;
+                    m_nodes[index].count = count;
+                    for (size_t i = first; i < last; ++i)
+                        m_entries[i].leaf = index;
+                } else {
+                    build(first, mid, index);
+                    const size_t right = build(mid, last, index);
+                    m_nodes[index].first = right;
+                }
+
+                return index;
+            }
+
+            /**
+             Partitions the given range of entries along the best split plane according to the surface area heuristic
+             and returns the start of the second partition, or first if the entries should not be split.
+             */
+            size_t split(const size_t first, const size_t last, const Box& bounds, const Box& centerBounds) const {
+                const Vec<F,3> extent = centerBounds.size();
+                const size_t axis = extent.firstComponent();
+                const size_t count = last - first;
+
+                if (extent[axis] <= static_cast<F>(0.0)) {
+                    // all centers coincide, split in the middle to limit the size of the leaves
+                    return first + count / 2;
+                }
+
+                const F min = centerBounds.min[axis];
+                const F scale = static_cast<F>(BinCount) / extent[axis];
+                const auto binIndex = [min, scale, axis](const Entry& entry) {
+                    const size_t i = static_cast<size_t>((entry.center[axis] - min) * scale);
+                    return std::min(i, BinCount - 1);
+                };
+
+                Bin bins[BinCount];
+                for (size_t i = first; i < last; ++i)
+                    bins[binIndex(m_entries[i])].add(m_entries[i].bounds);
+
+                // cost of splitting after bin i, computed by sweeping from both sides
+                F rightCosts[BinCount];
+                Bin right;
+                for (size_t i = BinCount - 1; i > 0; --i) {
+                    if (bins[i].count > 0) {
+                        right.add(bins[i].bounds);
+                        right.count += bins[i].count - 1;
+                    }
+                    rightCosts[i - 1] = right.count > 0 ? static_cast<F>(right.count) * area(right.bounds) : static_cast<F>(0.0);
+                }
+
+                size_t bestSplit = BinCount;
+                F bestCost = std::numeric_limits<F>::max();
+                Bin left;
+                for (size_t i = 0; i < BinCount - 1; ++i) {
+                    if (bins[i].count > 0) {
+                        left.add(bins[i].bounds);
+                        left.count += bins[i].count - 1;
+                    }
+                    if (left.count == 0 || left.count == count)
+                        continue;
+
+                    const F cost = static_cast<F>(left.count) * area(left.bounds) + rightCosts[i];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestSplit = i;
+                    }
+                }
+
+                if (bestSplit == BinCount)
+                    return first + count / 2;
+
+                const F leafCost = static_cast<F>(count) * area(bounds);
+                if (count <= 2 * MaxLeafSize && leafCost <= bestCost)
+                    return first;
+
+                typename EntryList::iterator begin = std::begin(m_entries) + static_cast<std::ptrdiff_t>(first);
+                typename EntryList::iterator end = std::begin(m_entries) + static_cast<std::ptrdiff_t>(last);
+                const typename EntryList::iterator mid = std::partition(begin, end, [&binIndex, bestSplit](const Entry& entry) { return binIndex(entry) <= bestSplit; });
+                return first + static_cast<size_t>(mid - begin);
+            }
+
+            static F area(const Box& box) {
+                const Vec<F,3> size = box.size();
+                return static_cast<F>(2.0) * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+            }
+
+            static Vec<F,3> invert(const Vec<F,3>& direction) {
+                Vec<F,3> result;
+                for (size_t i = 0; i < 3; ++i)
+                    result[i] = direction[i] != static_cast<F>(0.0) ? static_cast<F>(1.0) / direction[i] : std::numeric_limits<F>::infinity();
+                return result;
+            }
+
+            /**
+             Returns the distance from the ray origin to the point where the ray enters the given box, which is 0 if
+             the origin is inside of the box, or NaN if the ray misses the box.
+             */
+            static F intersectWithRay(const Box& box, const Ray<F,3>& ray, const Vec<F,3>& invDirection) {
+                F near = static_cast<F>(0.0);
+                F far = std::numeric_limits<F>::max();
+                for (size_t i = 0; i < 3; ++i) {
+                    if (ray.direction[i] == static_cast<F>(0.0)) {
+                        if (ray.origin[i] < box.min[i] || ray.origin[i] > box.max[i])
+                            return Math::nan<F>();
+                    } else {
+                        F t1 = (box.min[i] - ray.origin[i]) * invDirection[i];
+                        F t2 = (box.max[i] - ray.origin[i]) * invDirection[i];
+                        if (t1 > t2)
+                            std::swap(t1, t2);
+                        near = std::max(near, t1);
+                        far = std::min(far, t2);
+                        if (near > far)
+                            return Math::nan<F>();
+                    }
+                }
+                return near;
+            }
+
+            static bool outside(const Box& box, const typename Plane<F,3>::List& planes) {
+                for (const Plane<F,3>& plane : planes) {
+                    // the corner of the box that is farthest behind the plane
+                    Vec<F,3> corner;
+                    for (size_t i = 0; i < 3; ++i)
+                        corner[i] = plane.normal[i] >= static_cast<F>(0.0) ? box.min[i] : box.max[i];
+                    if (plane.pointDistance(corner) > static_cast<F>(0.0))
+                        return true;
+                }
+                return false;
+            }
+        };
+
+        template <typename F, typename T> const size_t AABBTree<F,T>::NoNode;
+        template <typename F, typename T> const size_t AABBTree<F,T>::MaxLeafSize;
+        template <typename F, typename T> const size_t AABBTree<F,T>::BinCount;
+        template <typename F, typename T> const size_t AABBTree<F,T>::MinRebuildThreshold;
+    }
+}
+
+#endif /* defined(TrenchBroom_AABBTree) */
@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AttributableNodeLinkIndex.h"
+
+#include "CollectionUtils.h"
+#include "Model/EntityAttributes.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace TrenchBroom {
+    namespace Model {
+        void AttributableNodeLinkIndex::addAttribute(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) {
+            NodeMap* map = nodeMap(name);
+            if (map != NULL)
+                add(*map, attributable, value);
+        }
+        
+        void AttributableNodeLinkIndex::removeAttribute(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) {
+            NodeMap* map = nodeMap(name);
+            if (map != NULL)
+                remove(*map, attributable, value);
+        }
+
+        void AttributableNodeLinkIndex::findTargets(const AttributeValue& targetname, AttributableNodeArray& result) const {
+            // a node has at most one targetname, so there are no duplicates
+            const NodeMap::const_iterator it = m_targetnames.find(targetname);
+            if (it != std::end(m_targetnames))
+                VectorUtils::append(result, it->second);
+        }
+        
+        void AttributableNodeLinkIndex::findLinkSources(const AttributeValue& targetname, AttributableNodeArray& result) const {
+            findUnique(m_targets, targetname, result);
+        }
+        
+        void AttributableNodeLinkIndex::findKillSources(const AttributeValue& targetname, AttributableNodeArray& result) const {
+            findUnique(m_killtargets, targetname, result);
+        }
+
+        AttributableNodeLinkIndex::NodeMap* AttributableNodeLinkIndex::nodeMap(const AttributeName& name) {
+            if (name == AttributeNames::Targetname)
+                return &m_targetnames;
+            if (isNumberedAttribute(AttributeNames::Target, name))
+                return &m_targets;
+            if (isNumberedAttribute(AttributeNames::Killtarget, name))
+                return &m_killtargets;
+            return NULL;
+        }
+
+        void AttributableNodeLinkIndex::add(NodeMap& map, AttributableNode* attributable, const AttributeValue& value) {
+            map[value].push_back(attributable);
+        }
+        
+        void AttributableNodeLinkIndex::remove(NodeMap& map, AttributableNode* attributable, const AttributeValue& value) {
+            NodeMap::iterator it = map.find(value);
+            if (it == std::end(map))
+                return;
+            
+            // a node is listed once for every matching attribute, so only one entry must be removed
+            AttributableNodeArray& nodes = it->second;
+            AttributableNodeArray::iterator nIt = std::find(std::begin(nodes), std::end(nodes), attributable);
+            if (nIt != std::end(nodes)) {
+                *nIt = nodes.back();
+                nodes.pop_back();
+            }
+            
+            if (nodes.empty())
+                map.erase(it);
+        }
+
+        void AttributableNodeLinkIndex::findUnique(const NodeMap& map, const AttributeValue& value, AttributableNodeArray& result) {
+            const NodeMap::const_iterator it = map.find(value);
+            if (it == std::end(map))
+                return;
+            
+            const size_t first = result.size();
+            VectorUtils::append(result, it->second);
+            
+            const AttributableNodeArray::iterator begin = std::next(std::begin(result), static_cast<std::ptrdiff_t>(first));
+            std::sort(begin, std::end(result));
+            result.erase(std::unique(begin, std::end(result)), std::end(result));
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_AttributableNodeLinkIndex
+#define TrenchBroom_AttributableNodeLinkIndex
+
+#include "StringUtils.h"
+#include "Model/ModelTypes.h"
+
+#include <unordered_map>
+
+namespace TrenchBroom {
+    namespace Model {
+        /**
+         Indexes the attributes which establish links between attributable nodes, that is, the targetnames and the
+         numbered target and killtarget attributes, by their values. Resolving the links of a node only requires a
+         hash lookup per attribute, which keeps loading and pasting maps with many links linear in the number of
+         links.
+         */
+        class AttributableNodeLinkIndex {
+        private:
+            typedef std::unordered_map<AttributeValue, AttributableNodeArray> NodeMap;
+            
+            NodeMap m_targetnames;
+            NodeMap m_targets;
+            NodeMap m_killtargets;
+        public:
+            void addAttribute(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value);
+            void removeAttribute(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value);
+            
+            /**
+             Appends the nodes with the given targetname to the given array.
+             */
+            void findTargets(const AttributeValue& targetname, AttributableNodeArray& result) const;
+            
+            /**
+             Appends the nodes which have a numbered target attribute with the given value to the given array. Every
+             node is added only once, even if it has several matching attributes.
+             */
+            void findLinkSources(const AttributeValue& targetname, AttributableNodeArray& result) const;
+            
+            /**
+             Appends the nodes which have a numbered killtarget attribute with the given value to the given array.
+             Every node is added only once, even if it has several matching attributes.
+             */
+            void findKillSources(const AttributeValue& targetname, AttributableNodeArray& result) const;
+        private:
+            NodeMap* nodeMap(const AttributeName& name);
+            
+            static void add(NodeMap& map, AttributableNode* attributable, const AttributeValue& value);
+            static void remove(NodeMap& map, AttributableNode* attributable, const AttributeValue& value);
+            static void findUnique(const NodeMap& map, const AttributeValue& value, AttributableNodeArray& result);
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_AttributableNodeLinkIndex) */
@@ -19,7 +19,9 @@
 
 #include "Brush.h"
 
+#include "Allocator.h"
 #include "CollectionUtils.h"
+#include "ParallelUtils.h"
 #include "Model/BrushContentTypeBuilder.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
@@ -34,6 +36,8 @@
 #include "Model/PickResult.h"
 #include "Model/World.h"
 
+#include <exception>
+
 namespace TrenchBroom {
     namespace Model {
         const Hit::HitType Brush::BrushHit = Hit::freeHitType();
@@ -49,9 +53,11 @@ namespace TrenchBroom {
         class Brush::AddFaceToGeometryCallback : public BrushGeometry::Callback {
         private:
             BrushFace* m_addedFace;
+            BrushFaceArray& m_droppedFaces;
         public:
-            AddFaceToGeometryCallback(BrushFace* addedFace) :
-            m_addedFace(addedFace) {
+            AddFaceToGeometryCallback(BrushFace* addedFace, BrushFaceArray& droppedFaces) :
+            m_addedFace(addedFace),
+            m_droppedFaces(droppedFaces) {
                 ensure(m_addedFace != NULL, "addedFace is null");
             }
             
@@ -65,14 +71,19 @@ namespace TrenchBroom {
                 if (brushFace != NULL) {
                     ensure(!brushFace->selected(), "brush face is selected");
                     
-                    delete brushFace;
+                    m_droppedFaces.push_back(brushFace);
                     face->setPayload(NULL);
                 }
             }
         };
 
         class Brush::HealEdgesCallback : public BrushGeometry::Callback {
+        private:
+            BrushFaceArray& m_droppedFaces;
         public:
+            HealEdgesCallback(BrushFaceArray& droppedFaces) :
+            m_droppedFaces(droppedFaces) {}
+            
             void facesWillBeMerged(BrushFaceGeometry* remainingGeometry, BrushFaceGeometry* geometryToDelete) {
                 BrushFace* remainingFace = remainingGeometry->payload();
                 ensure(remainingFace != NULL, "remainingFace is null");
@@ -82,7 +93,7 @@ namespace TrenchBroom {
                 ensure(faceToDelete != NULL, "faceToDelete is null");
                 ensure(!faceToDelete->selected(), "brush face is selected");
                 
-                delete faceToDelete;
+                m_droppedFaces.push_back(faceToDelete);
                 geometryToDelete->setPayload(NULL);
             }
 
@@ -91,27 +102,32 @@ namespace TrenchBroom {
                 ensure(brushFace != NULL, "brushFace is null");
                 ensure(!brushFace->selected(), "brush face is selected");
                 
-                delete brushFace;
+                m_droppedFaces.push_back(brushFace);
                 face->setPayload(NULL);
             }
         };
         
+        /**
+         Builds a geometry from the given faces. The faces which do not contribute to the geometry are not deleted
+         right away, but collected in the given array, because deleting a face updates the usage count of its texture
+         and must therefore happen on the main thread.
+         */
         class Brush::AddFacesToGeometry {
         private:
             BrushGeometry& m_geometry;
             bool m_brushEmpty;
             bool m_brushValid;
         public:
-            AddFacesToGeometry(BrushGeometry& geometry, const BrushFaceArray& facesToAdd) :
+            AddFacesToGeometry(BrushGeometry& geometry, const BrushFaceArray& facesToAdd, BrushFaceArray& droppedFaces) :
             m_geometry(geometry),
             m_brushEmpty(false),
             m_brushValid(true) {
-                HealEdgesCallback healCallback;
+                HealEdgesCallback healCallback(droppedFaces);
 
                 BrushFaceArray::const_iterator it, end;
                 for (it = std::begin(facesToAdd), end = std::end(facesToAdd); it != end && !m_brushEmpty && m_brushValid; ++it) {
                     BrushFace* face = *it;
-                    AddFaceToGeometryCallback addCallback(face);
+                    AddFaceToGeometryCallback addCallback(face, droppedFaces);
                     const BrushGeometry::ClipResult result = m_geometry.clip(face->boundary(), addCallback);
                     if (result.empty())
                         m_brushEmpty = true;
@@ -577,6 +593,10 @@ namespace TrenchBroom {
                     testFaces.push_back(brushFace);
             }
             
+            // the test geometry is discarded as a whole, so there is no point in pooling its parts
+            AllocatorArena arena;
+            const AllocatorArena::Scope arenaScope(arena);
+            
             BrushGeometry testGeometry(worldBounds);
             CanMoveBoundary canMove(testGeometry, testFaces);
             const bool inWorldBounds = worldBounds.contains(testGeometry.bounds()) && testGeometry.closed();
@@ -683,6 +703,11 @@ namespace TrenchBroom {
             return true;
         }
 
+        bool Brush::intersects(const Brush* brush) const {
+            ensure(brush != NULL, "brush is null");
+            return m_geometry->intersects(*brush->m_geometry);
+        }
+
         BrushFaceArray Brush::incidentFaces(const BrushVertex* vertex) const {
             BrushFaceArray result;
             result.reserve(m_faces.size());
@@ -697,6 +722,28 @@ namespace TrenchBroom {
             return result;
         }
 
+        /**
+         Removes the vertices at the given positions from the given geometry and returns the positions of the removed
+         vertices. Removing a vertex only rebuilds the faces around it, which is much cheaper than computing the
+         convex hull of the remaining vertices from scratch.
+         */
+        static Vec3::List removeGeometryVertices(BrushGeometry& geometry, const Vec3::Set& positions) {
+            Vec3::List result;
+            result.reserve(positions.size());
+            for (const Vec3& position : positions) {
+                if (geometry.findVertexByPosition(position) != NULL)
+                    result.push_back(position);
+            }
+            
+            for (const Vec3& position : result) {
+                BrushVertex* vertex = geometry.findVertexByPosition(position);
+                if (vertex != NULL)
+                    geometry.removeVertex(vertex);
+            }
+            
+            return result;
+        }
+        
         bool Brush::canMoveVertices(const BBox3& worldBounds, const Vec3::List& vertices, const Vec3& delta) const {
             return doCanMoveVertices(worldBounds, vertices, delta, true);
         }
@@ -706,16 +753,12 @@ namespace TrenchBroom {
             ensure(!vertexPositions.empty(), "no vertex positions");
             assert(canMoveVertices(worldBounds, vertexPositions, delta));
 
-            BrushGeometry newGeometry;
+            // only the faces around the moved vertices are rebuilt
+            BrushGeometry newGeometry(*m_geometry);
             Vec3::Set vertexSet(std::begin(vertexPositions), std::end(vertexPositions));
             
-            for (BrushVertex* vertex : m_geometry->vertices()) {
-                const Vec3& position = vertex->position();
-                if (vertexSet.count(position) > 0)
-                    newGeometry.addPoint(position + delta);
-                else
-                    newGeometry.addPoint(position);
-            }
+            for (const Vec3& position : removeGeometryVertices(newGeometry, vertexSet))
+                newGeometry.addPoint(position + delta);
 
             Vec3::List result;
             Vec3::Map vertexMapping;
@@ -759,6 +802,8 @@ namespace TrenchBroom {
             ensure(m_geometry != NULL, "geometry is null");
             ensure(!vertexPositions.empty(), "no vertex positions");
             
+            AllocatorArena arena;
+            const AllocatorArena::Scope arenaScope(arena);
             BrushGeometry testGeometry(*m_geometry);
             
             for (const Vec3& position : vertexPositions) {
@@ -777,14 +822,9 @@ namespace TrenchBroom {
             ensure(!vertexPositions.empty(), "no vertex positions");
             assert(canRemoveVertices(worldBounds, vertexPositions));
             
-            BrushGeometry newGeometry;
+            BrushGeometry newGeometry(*m_geometry);
             const Vec3::Set vertexSet(std::begin(vertexPositions), std::end(vertexPositions));
-            
-            for (const BrushVertex* vertex : m_geometry->vertices()) {
-                const Vec3& position = vertex->position();
-                if (vertexSet.count(position) == 0)
-                    newGeometry.addPoint(position);
-            }
+            removeGeometryVertices(newGeometry, vertexSet);
             
             const PolyhedronMatcher<BrushGeometry> matcher(*m_geometry, newGeometry);
             doSetNewGeometry(worldBounds, matcher, newGeometry);
@@ -928,20 +968,21 @@ namespace TrenchBroom {
                 return true;
             
             const Vec3::Set vertexSet(std::begin(vertices), std::end(vertices));
-            BrushGeometry remaining;
+            
+            AllocatorArena arena;
+            const AllocatorArena::Scope arenaScope(arena);
+            
+            // Derive the remaining fragment and the result from the current geometry so that only the faces around
+            // the moving vertices must be rebuilt.
+            BrushGeometry remaining(*m_geometry);
+            const Vec3::List movingPositions = removeGeometryVertices(remaining, vertexSet);
+            
             BrushGeometry moving;
-            BrushGeometry result;
+            moving.addPoints(movingPositions);
             
-            for (const BrushVertex* vertex : m_geometry->vertices()) {
-                const Vec3& position = vertex->position();
-                if (vertexSet.count(position) == 0) {
-                    remaining.addPoint(position);
-                    result.addPoint(position);
-                } else {
-                    moving.addPoint(position);
-                    result.addPoint(position + delta);
-                }
-            }
+            BrushGeometry result(remaining);
+            for (const Vec3& position : movingPositions)
+                result.addPoint(position + delta);
             
             assert(moving.vertexCount() == vertices.size());
             assert(remaining.vertexCount() + moving.vertexCount() == vertexCount());
@@ -1004,17 +1045,21 @@ namespace TrenchBroom {
         }
 
         BrushArray Brush::subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const {
-            const BrushGeometry::SubtractResult result = m_geometry->subtract(*subtrahend->m_geometry);
-            
-            BrushArray brushes(0);
-            brushes.reserve(result.size());
-            
-            for (const BrushGeometry& geometry : result) {
-                Brush* brush = createBrush(factory, worldBounds, defaultTextureName, geometry, subtrahend);
-                brushes.push_back(brush);
-            }
-            
-            return brushes;
+            return createBrushes(factory, worldBounds, defaultTextureName, subtractGeometry(subtrahend), subtrahend);
+        }
+        
+        std::vector<BrushArray> Brush::subtractFromBrushes(const BrushArray& minuends, const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) {
+            std::vector<BrushGeometry::SubtractResult> geometries(minuends.size());
+            ParallelUtils::parallelFor(minuends.size(), [&minuends, &geometries, subtrahend](const size_t i) {
+                geometries[i] = minuends[i]->subtractGeometry(subtrahend);
+            });
+            
+            // the brushes are created on this thread because assigning their textures notifies the texture manager
+            std::vector<BrushArray> result;
+            result.reserve(minuends.size());
+            for (size_t i = 0; i < minuends.size(); ++i)
+                result.push_back(minuends[i]->createBrushes(factory, worldBounds, defaultTextureName, geometries[i], subtrahend));
+            return result;
         }
 
         void Brush::intersect(const BBox3& worldBounds, const Brush* brush) {
@@ -1024,6 +1069,25 @@ namespace TrenchBroom {
             rebuildGeometry(worldBounds);
         }
 
+        BrushGeometry::SubtractResult Brush::subtractGeometry(const Brush* subtrahend) const {
+            // the bounds and separating axis tests are much cheaper than a subtraction which yields nothing
+            if (!intersects(subtrahend))
+                return BrushGeometry::SubtractResult();
+            return m_geometry->subtract(*subtrahend->m_geometry);
+        }
+        
+        BrushArray Brush::createBrushes(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry::SubtractResult& geometries, const Brush* subtrahend) const {
+            BrushArray brushes(0);
+            brushes.reserve(geometries.size());
+            
+            for (const BrushGeometry& geometry : geometries) {
+                Brush* brush = createBrush(factory, worldBounds, defaultTextureName, geometry, subtrahend);
+                brushes.push_back(brush);
+            }
+            
+            return brushes;
+        }
+        
         Brush* Brush::createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const {
             BrushFaceArray faces(0);
             faces.reserve(geometry.faceCount());
@@ -1072,11 +1136,75 @@ namespace TrenchBroom {
             rebuildGeometry(worldBounds);
         }
 
+        /**
+         Calls the given function for each of the given brushes in parallel. The function updates the geometry of the
+         brush it is passed, but it must neither notify any observers nor delete any faces. Instead, it adds the faces
+         that were removed from the brush to the given array.
+
+         Afterwards, the removed faces are deleted and the bounds changes of the brushes are announced serially on the
+         calling thread. If the function throws for some brushes, the other brushes are updated nevertheless, and the
+         exception thrown for the first failed brush in the given order is rethrown.
+         */
+        template <typename F>
+        void Brush::updateGeometries(const BrushArray& brushes, F update) {
+            std::vector<BrushFaceArray> droppedFaces(brushes.size());
+            std::vector<std::exception_ptr> exceptions(brushes.size());
+            
+            ParallelUtils::parallelFor(brushes.size(), [&](const size_t i) {
+                try {
+                    update(brushes[i], droppedFaces[i]);
+                } catch (...) {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+            
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                VectorUtils::clearAndDelete(droppedFaces[i]);
+                if (!exceptions[i])
+                    brushes[i]->nodeBoundsDidChange();
+            }
+            
+            for (const std::exception_ptr& exception : exceptions) {
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+        }
+
         void Brush::rebuildGeometry(const BBox3& worldBounds) {
+            updateGeometries(BrushArray(1, this), [&worldBounds](Brush* brush, BrushFaceArray& droppedFaces) {
+                brush->buildGeometry(worldBounds, droppedFaces);
+            });
+        }
+
+        void Brush::rebuildBrushGeometry(const BrushArray& brushes, const BBox3& worldBounds) {
+            updateGeometries(brushes, [&worldBounds](Brush* brush, BrushFaceArray& droppedFaces) {
+                brush->buildGeometry(worldBounds, droppedFaces);
+            });
+        }
+
+        void Brush::transformBrushes(const BrushArray& brushes, const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
+            for (Brush* brush : brushes)
+                brush->nodeWillChange();
+            
+            try {
+                updateGeometries(brushes, [&](Brush* brush, BrushFaceArray& droppedFaces) {
+                    brush->transformFacesAndGeometry(transformation, lockTextures, worldBounds, droppedFaces);
+                });
+            } catch (...) {
+                for (Brush* brush : brushes)
+                    brush->nodeDidChange();
+                throw;
+            }
+            
+            for (Brush* brush : brushes)
+                brush->nodeDidChange();
+        }
+
+        void Brush::buildGeometry(const BBox3& worldBounds, BrushFaceArray& droppedFaces) {
             delete m_geometry;
             m_geometry = new BrushGeometry(worldBounds.expanded(1.0));
             
-            AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces);
+            AddFacesToGeometry addFacesToGeometry(*m_geometry, m_faces, droppedFaces);
             updateFacesFromGeometry(worldBounds);
             if (addFacesToGeometry.brushEmpty())
                 throw GeometryException("Brush is empty");
@@ -1084,7 +1212,6 @@ namespace TrenchBroom {
                 throw GeometryException("Brush is invalid");
             if (!fullySpecified())
                 throw GeometryException("Brush is not fully specified");
-            nodeBoundsDidChange();
         }
 
         void Brush::findIntegerPlanePoints(const BBox3& worldBounds) {
@@ -1095,6 +1222,51 @@ namespace TrenchBroom {
             rebuildGeometry(worldBounds);
         }
 
+        /**
+         Returns whether the given transformation is a combination of translations, rotations, reflections and
+         uniform scaling by a factor of at least one. Such a transformation maps the vertices and face planes of a
+         brush onto each other without changing its topology, and it does not shorten any edges.
+         */
+        static bool isTopologyPreserving(const Mat4x4& transformation) {
+            if (transformation[0][3] != 0.0 || transformation[1][3] != 0.0 || transformation[2][3] != 0.0 || transformation[3][3] != 1.0)
+                return false;
+            
+            const Vec3 x(transformation[0][0], transformation[0][1], transformation[0][2]);
+            const Vec3 y(transformation[1][0], transformation[1][1], transformation[1][2]);
+            const Vec3 z(transformation[2][0], transformation[2][1], transformation[2][2]);
+            
+            const FloatType scale = x.squaredLength();
+            if (Math::lt(scale, 1.0))
+                return false;
+            
+            const FloatType epsilon = scale * Math::Constants<FloatType>::angleEpsilon();
+            return (Math::eq(y.squaredLength(), scale, epsilon) &&
+                    Math::eq(z.squaredLength(), scale, epsilon) &&
+                    Math::zero(x.dot(y), epsilon) &&
+                    Math::zero(x.dot(z), epsilon) &&
+                    Math::zero(y.dot(z), epsilon));
+        }
+        
+        bool Brush::transformGeometry(const Mat4x4& transformation, const BBox3& worldBounds) {
+            if (!isTopologyPreserving(transformation))
+                return false;
+            
+            m_geometry->transform(transformation);
+            m_geometry->correctVertexPositions();
+            
+            // a rebuild would clip the geometry by the world bounds
+            return worldBounds.expanded(1.0).contains(m_geometry->bounds());
+        }
+
+        void Brush::transformFacesAndGeometry(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds, BrushFaceArray& droppedFaces) {
+            for (BrushFace* face : m_faces)
+                face->transform(transformation, lockTextures);
+            
+            // transforming the existing geometry is much cheaper than rebuilding it from the face planes
+            if (!transformGeometry(transformation, worldBounds))
+                buildGeometry(worldBounds, droppedFaces);
+        }
+
         bool Brush::checkGeometry() const {
             for (const BrushFace* face : m_faces) {
                 if (face->geometry() == NULL)
@@ -1261,12 +1433,7 @@ namespace TrenchBroom {
         }
         
         void Brush::doTransform(const Mat4x4& transformation, bool lockTextures, const BBox3& worldBounds) {
-            const NotifyNodeChange nodeChange(this);
-
-            for (BrushFace* face : m_faces)
-                face->transform(transformation, lockTextures);
-
-            rebuildGeometry(worldBounds);
+            transformBrushes(BrushArray(1, this), transformation, lockTextures, worldBounds);
         }
         
         class Brush::Contains : public ConstNodeVisitor, public NodeQuery<bool> {
@@ -151,6 +151,7 @@ namespace TrenchBroom {
             EdgeList edges() const;
             
             bool containsPoint(const Vec3& point) const;
+            bool intersects(const Brush* brush) const;
             
             BrushFaceArray incidentFaces(const BrushVertex* vertex) const;
             
@@ -184,8 +185,18 @@ namespace TrenchBroom {
         public:
             // CSG operations
             BrushArray subtract(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend) const;
+            
+            /**
+             Subtracts the given subtrahend from each of the given minuends, whose fragments are computed in parallel.
+             The result contains the fragments of every minuend at the index of that minuend. Minuends which do not
+             intersect the subtrahend have no fragments.
+             */
+            static std::vector<BrushArray> subtractFromBrushes(const BrushArray& minuends, const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const Brush* subtrahend);
+            
             void intersect(const BBox3& worldBounds, const Brush* brush);
         private:
+            BrushGeometry::SubtractResult subtractGeometry(const Brush* subtrahend) const;
+            BrushArray createBrushes(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry::SubtractResult& geometries, const Brush* subtrahend) const;
             Brush* createBrush(const ModelFactory& factory, const BBox3& worldBounds, const String& defaultTextureName, const BrushGeometry& geometry, const Brush* subtrahend) const;
         private:
             void updateFacesFromGeometry(const BBox3& worldBounds);
@@ -193,7 +204,24 @@ namespace TrenchBroom {
         public: // brush geometry
             void rebuildGeometry(const BBox3& worldBounds);
             void findIntegerPlanePoints(const BBox3& worldBounds);
+            
+            /**
+             Rebuilds the geometries of the given brushes in parallel. If some of the geometries cannot be built, the
+             other brushes are rebuilt nevertheless, and the exception of the first failed brush is rethrown.
+             */
+            static void rebuildBrushGeometry(const BrushArray& brushes, const BBox3& worldBounds);
+            
+            /**
+             Transforms the given brushes like calling transform for each of them, but computes their new faces and
+             geometries in parallel. Only the notifications are sent serially, once all brushes have been transformed.
+             */
+            static void transformBrushes(const BrushArray& brushes, const Mat4x4& transformation, bool lockTextures, const BBox3& worldBounds);
         private:
+            template <typename F>
+            static void updateGeometries(const BrushArray& brushes, F update);
+            void buildGeometry(const BBox3& worldBounds, BrushFaceArray& droppedFaces);
+            bool transformGeometry(const Mat4x4& transformation, const BBox3& worldBounds);
+            void transformFacesAndGeometry(const Mat4x4& transformation, bool lockTextures, const BBox3& worldBounds, BrushFaceArray& droppedFaces);
             bool checkGeometry() const;
         public: // content type
             bool transparent() const;
@@ -122,6 +122,12 @@ namespace TrenchBroom {
             return result;
         }
 
+        BrushFace* BrushFace::cloneWithoutTexture() const {
+            BrushFace* result = new BrushFace(points()[0], points()[1], points()[2], m_attribs.takeSnapshot(), m_texCoordSystem->clone());
+            result->setFilePosition(m_lineNumber, m_lineCount);
+            return result;
+        }
+
         BrushFaceSnapshot* BrushFace::takeSnapshot() {
             return new BrushFaceSnapshot(this, m_texCoordSystem);
         }
@@ -285,7 +291,7 @@ namespace TrenchBroom {
 
         void BrushFace::updateTexture(Assets::TextureManager* textureManager) {
             ensure(textureManager != NULL, "textureManager is null");
-            Assets::Texture* texture = textureManager->texture(textureName());
+            Assets::Texture* texture = textureManager->texture(m_attribs.internedTextureName());
             setTexture(texture);
             invalidateVertexCache();
         }
@@ -81,6 +81,8 @@ namespace TrenchBroom {
             typedef ConstProjectingSequence<BrushHalfEdgeList, ProjectToVertex> VertexList;
             typedef ConstProjectingSequence<BrushHalfEdgeList, ProjectToEdge> EdgeList;
         private:
+            friend class BrushSnapshot;
+            
             Brush* m_brush;
             BrushFace::Points m_points;
             Plane3 m_boundary;
@@ -108,6 +110,12 @@ namespace TrenchBroom {
             
             BrushFace* clone() const;
             
+            /**
+             Returns a copy of this face which only refers to its texture by name. Unlike a regular clone, the copy
+             does not affect the usage count of the texture, so it may be deleted on any thread.
+             */
+            BrushFace* cloneWithoutTexture() const;
+            
             BrushFaceSnapshot* takeSnapshot();
 
             Brush* brush() const;
@@ -24,6 +24,9 @@
 namespace TrenchBroom {
     namespace Model {
         BrushFaceAttributes::BrushFaceAttributes(const String& textureName) :
+        BrushFaceAttributes(Assets::TextureName(textureName)) {}
+        
+        BrushFaceAttributes::BrushFaceAttributes(const Assets::TextureName& textureName) :
         m_textureName(textureName),
         m_texture(NULL),
         m_offset(Vec2f::Null),
@@ -81,6 +84,10 @@ namespace TrenchBroom {
         }
 
         const String& BrushFaceAttributes::textureName() const {
+            return m_textureName.asString();
+        }
+        
+        const Assets::TextureName& BrushFaceAttributes::internedTextureName() const {
             return m_textureName;
         }
         
@@ -146,7 +153,7 @@ namespace TrenchBroom {
             m_texture = texture;
             if (m_texture != NULL) {
                 m_texture->incUsageCount();
-                m_textureName = m_texture->name();
+                m_textureName = m_texture->internedName();
             }
         }
         
@@ -154,7 +161,9 @@ namespace TrenchBroom {
             if (m_texture != NULL)
                 m_texture->decUsageCount();
             m_texture = NULL;
-            m_textureName = BrushFace::NoTextureName;
+            
+            static const Assets::TextureName NoTextureName(BrushFace::NoTextureName);
+            m_textureName = NoTextureName;
         }
 
         void BrushFaceAttributes::setOffset(const Vec2f& offset) {
@@ -36,5 +36,13 @@ namespace TrenchBroom {
             if (m_coordSystem != NULL)
                 m_coordSystem->restore();
         }
+
+        size_t BrushFaceSnapshot::memorySize() const {
+            // a texture coordinate system snapshot stores no more than two axes
+            size_t size = sizeof(BrushFaceSnapshot) + m_attribs.textureName().capacity();
+            if (m_coordSystem != NULL)
+                size += 2 * sizeof(Vec3);
+            return size;
+        }
     }
 }
@@ -33,6 +33,11 @@ namespace TrenchBroom {
             BrushFaceSnapshot(BrushFace* face, TexCoordSystem* coordSystem);
             ~BrushFaceSnapshot();
             void restore();
+            
+            /**
+             Returns the approximate number of bytes used by this snapshot.
+             */
+            size_t memorySize() const;
         };
     }
 }
@@ -19,9 +19,9 @@
 
 #include "BrushSnapshot.h"
 
-#include "CollectionUtils.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
+#include "Model/TexCoordSystem.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -31,17 +31,77 @@ namespace TrenchBroom {
         }
 
         BrushSnapshot::~BrushSnapshot() {
-            VectorUtils::clearAndDelete(m_faces);
+            for (FaceSnapshot& face : m_faces) {
+                delete face.texCoordSystem;
+                face.texCoordSystem = NULL;
+            }
         }
 
         void BrushSnapshot::takeSnapshot(Brush* brush) {
-            for (BrushFace* face : brush->faces())
-                m_faces.push_back(face->clone());
+            const BrushFaceArray& faces = brush->faces();
+            m_faces.reserve(faces.size());
+            
+            for (const BrushFace* face : faces) {
+                FaceSnapshot snapshot;
+                for (size_t i = 0; i < 3; ++i)
+                    snapshot.points[i] = face->m_points[i];
+                snapshot.attribsIndex = findOrAddAttribs(face->m_attribs);
+                snapshot.texCoordSystem = face->m_texCoordSystem->clone();
+                snapshot.lineNumber = face->m_lineNumber;
+                snapshot.lineCount = face->m_lineCount;
+                snapshot.selected = face->m_selected;
+                m_faces.push_back(snapshot);
+            }
+        }
+        
+        static bool equalAttribs(const BrushFaceAttributes& lhs, const BrushFaceAttributes& rhs) {
+            return (lhs.internedTextureName() == rhs.internedTextureName() &&
+                    lhs.offset() == rhs.offset() &&
+                    lhs.scale() == rhs.scale() &&
+                    lhs.rotation() == rhs.rotation() &&
+                    lhs.surfaceContents() == rhs.surfaceContents() &&
+                    lhs.surfaceFlags() == rhs.surfaceFlags() &&
+                    lhs.surfaceValue() == rhs.surfaceValue());
+        }
+        
+        size_t BrushSnapshot::findOrAddAttribs(const BrushFaceAttributes& attribs) {
+            for (size_t i = 0; i < m_attribs.size(); ++i) {
+                if (equalAttribs(m_attribs[i], attribs))
+                    return i;
+            }
+            
+            m_attribs.push_back(attribs.takeSnapshot());
+            return m_attribs.size() - 1;
         }
         
         void BrushSnapshot::doRestore(const BBox3& worldBounds) {
-            m_brush->setFaces(worldBounds, m_faces);
+            BrushFaceArray faces;
+            faces.reserve(m_faces.size());
+            
+            for (FaceSnapshot& snapshot : m_faces) {
+                BrushFace* face = new BrushFace(snapshot.points[0], snapshot.points[1], snapshot.points[2], m_attribs[snapshot.attribsIndex], snapshot.texCoordSystem);
+                snapshot.texCoordSystem = NULL;
+                
+                face->setFilePosition(snapshot.lineNumber, snapshot.lineCount);
+                if (snapshot.selected)
+                    face->select();
+                faces.push_back(face);
+            }
             m_faces.clear();
+            m_attribs.clear();
+            
+            m_brush->setFaces(worldBounds, faces);
+        }
+
+        size_t BrushSnapshot::doGetMemorySize() const {
+            // a texture coordinate system stores no more than two axes
+            size_t size = sizeof(BrushSnapshot);
+            size += m_faces.capacity() * sizeof(FaceSnapshot);
+            size += m_faces.size() * 2 * sizeof(Vec3);
+            size += m_attribs.capacity() * sizeof(BrushFaceAttributes);
+            for (const BrushFaceAttributes& attribs : m_attribs)
+                size += attribs.textureName().capacity();
+            return size;
         }
     }
 }
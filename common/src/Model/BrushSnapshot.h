@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_BrushSnapshot
 #define TrenchBroom_BrushSnapshot
 
+#include "VecMath.h"
+#include "Model/BrushFaceAttributes.h"
 #include "Model/ModelTypes.h"
 #include "Model/NodeSnapshot.h"
 
@@ -28,18 +30,38 @@
 namespace TrenchBroom {
     namespace Model {
         class Brush;
-        class BrushFaceSnapshot;
+        class TexCoordSystem;
         
+        /**
+         Records the faces of a brush without cloning them. Only the plane points, the texture coordinate system and
+         the attributes of each face are kept, and faces with equal attributes share a single copy of them. The
+         attributes refer to their textures by name only, so the textures must be set again after restoring.
+         */
         class BrushSnapshot : public NodeSnapshot {
         private:
+            struct FaceSnapshot {
+                Vec3 points[3];
+                size_t attribsIndex;
+                TexCoordSystem* texCoordSystem;
+                size_t lineNumber;
+                size_t lineCount;
+                bool selected;
+            };
+            
+            typedef std::vector<FaceSnapshot> FaceSnapshotList;
+            typedef std::vector<BrushFaceAttributes> BrushFaceAttributesList;
+            
             Brush* m_brush;
-            BrushFaceList m_faces;
+            FaceSnapshotList m_faces;
+            BrushFaceAttributesList m_attribs;
         public:
             BrushSnapshot(Brush* brush);
             ~BrushSnapshot();
         private:
             void takeSnapshot(Brush* brush);
+            size_t findOrAddAttribs(const BrushFaceAttributes& attribs);
             void doRestore(const BBox3& worldBounds);
+            size_t doGetMemorySize() const;
         };
     }
 }
@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushVolumeQuery.h"
+
+#include "ParallelUtils.h"
+#include "Model/Brush.h"
+#include "Model/CollectContainedNodesVisitor.h"
+#include "Model/CollectMatchingNodesVisitor.h"
+#include "Model/CollectTouchingNodesVisitor.h"
+#include "Model/Layer.h"
+#include "Model/MatchSelectableNodes.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
+#include <map>
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushVolumeQuery::Candidate {
+        public:
+            Node* node;
+            BrushList brushes;
+            
+            Candidate(Node* i_node) :
+            node(i_node) {}
+        };
+        
+        class BrushVolumeQuery::FindLayerNodes : public NodeVisitor {
+        private:
+            const BBox3& m_bounds;
+            NodeList& m_result;
+        public:
+            FindLayerNodes(const BBox3& bounds, NodeList& result) :
+            m_bounds(bounds),
+            m_result(result) {}
+        private:
+            void doVisit(World* world)   {}
+            void doVisit(Layer* layer)   { layer->findNodesIntersecting(m_bounds, m_result); }
+            void doVisit(Group* group)   {}
+            void doVisit(Entity* entity) {}
+            void doVisit(Brush* brush)   {}
+        };
+        
+        BrushVolumeQuery::BrushVolumeQuery(World* world, const BrushList& brushes, const EditorContext& editorContext) :
+        m_world(world),
+        m_brushes(brushes),
+        m_editorContext(editorContext) {}
+        
+        NodeList BrushVolumeQuery::touchingNodes() const {
+            return findMatchingNodes<MatchTouchingNodes<BrushList::const_iterator> >();
+        }
+        
+        NodeList BrushVolumeQuery::containedNodes() const {
+            return findMatchingNodes<MatchContainedNodes<BrushList::const_iterator> >();
+        }
+        
+        template <typename M>
+        NodeList BrushVolumeQuery::findMatchingNodes() const {
+            const CandidateList candidates = findCandidates();
+            
+            std::vector<char> matches(candidates.size(), 0);
+            ParallelUtils::parallelFor(candidates.size(), [&candidates, &matches](const size_t i) {
+                const Candidate& candidate = candidates[i];
+                const M match(std::begin(candidate.brushes), std::end(candidate.brushes));
+                matches[i] = match(candidate.node) ? 1 : 0;
+            });
+            
+            NodeList result;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                if (matches[i] != 0)
+                    result.push_back(candidates[i].node);
+            }
+            return result;
+        }
+        
+        BrushVolumeQuery::CandidateList BrushVolumeQuery::findCandidates() const {
+            // the top level nodes whose bounds intersect the bounds of any brush, along with these brushes
+            CandidateList topLevelNodes;
+            std::map<Node*, size_t> indices;
+            
+            for (Brush* brush : m_brushes) {
+                NodeList nodes;
+                FindLayerNodes findNodes(brush->bounds(), nodes);
+                m_world->iterate(findNodes);
+                
+                for (Node* node : nodes) {
+                    const auto it = indices.insert(std::make_pair(node, topLevelNodes.size())).first;
+                    if (it->second == topLevelNodes.size())
+                        topLevelNodes.push_back(Candidate(node));
+                    topLevelNodes[it->second].brushes.push_back(brush);
+                }
+            }
+            
+            // The bounds of the descendants of a top level node are contained in its bounds, so only descendants of
+            // top level candidates can match. Computing the bounds here also ensures that they are not lazily
+            // computed during the parallel tests.
+            CandidateList result;
+            for (const Candidate& topLevelNode : topLevelNodes) {
+                CollectMatchingNodesVisitor<MatchSelectableNodes> collect((MatchSelectableNodes(m_editorContext)));
+                topLevelNode.node->acceptAndRecurse(collect);
+                
+                for (Node* node : collect.nodes()) {
+                    Candidate candidate(node);
+                    for (Brush* brush : topLevelNode.brushes) {
+                        if (brush->bounds().intersects(node->bounds()))
+                            candidate.brushes.push_back(brush);
+                    }
+                    if (!candidate.brushes.empty())
+                        result.push_back(candidate);
+                }
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushVolumeQuery
+#define TrenchBroom_BrushVolumeQuery
+
+#include "Model/ModelTypes.h"
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        class EditorContext;
+        
+        /**
+         Finds the selectable nodes that touch or that are contained in any of a list of brushes, which need not
+         belong to the world.
+         
+         Only nodes whose bounds intersect the bounds of one of the brushes are considered. These candidates are found
+         using the spatial index of each layer, and each candidate is only tested against the brushes whose bounds
+         intersect its bounds. The exact tests are run in parallel.
+         */
+        class BrushVolumeQuery {
+        private:
+            class Candidate;
+            typedef std::vector<Candidate> CandidateList;
+            class FindLayerNodes;
+            
+            World* m_world;
+            BrushList m_brushes;
+            const EditorContext& m_editorContext;
+        public:
+            BrushVolumeQuery(World* world, const BrushList& brushes, const EditorContext& editorContext);
+            
+            NodeList touchingNodes() const;
+            NodeList containedNodes() const;
+        private:
+            template <typename M>
+            NodeList findMatchingNodes() const;
+            CandidateList findCandidates() const;
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_BrushVolumeQuery) */
@@ -31,6 +31,7 @@
 #include "Model/IssueGenerator.h"
 #include "Model/NodeVisitor.h"
 #include "Model/PickResult.h"
+#include "Model/TransformObjectVisitor.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -40,7 +41,9 @@ namespace TrenchBroom {
         Entity::Entity() :
         AttributableNode(),
         Object(),
-        m_boundsValid(false) {}
+        m_boundsValid(false),
+        m_modelDefinition(NULL),
+        m_modelSpecificationValid(false) {}
 
         bool Entity::pointEntity() const {
             if (definition() == NULL)
@@ -81,8 +84,15 @@ namespace TrenchBroom {
         Assets::ModelSpecification Entity::modelSpecification() const {
             if (m_definition == NULL || !pointEntity())
                 return Assets::ModelSpecification();
-            Assets::PointEntityDefinition* pointDefinition = static_cast<Assets::PointEntityDefinition*>(m_definition);
-            return pointDefinition->model(m_attributes);
+            
+            if (!m_modelSpecificationValid) {
+                const Assets::PointEntityDefinition* pointDefinition = static_cast<Assets::PointEntityDefinition*>(m_definition);
+                m_modelDependencies.clear();
+                m_modelSpecification = pointDefinition->model(m_attributes, m_modelDependencies);
+                m_modelDefinition = m_definition;
+                m_modelSpecificationValid = true;
+            }
+            return m_modelSpecification;
         }
 
         const BBox3& Entity::doGetBounds() const {
@@ -209,6 +219,7 @@ namespace TrenchBroom {
         }
 
         void Entity::doAttributesDidChange() {
+            invalidateModelSpecification();
             nodeBoundsDidChange();
         }
         
@@ -246,29 +257,12 @@ namespace TrenchBroom {
             return visitor.hasResult() ? visitor.result() : NULL;
         }
 
-        class TransformEntity : public NodeVisitor {
-        private:
-            const Mat4x4d& m_transformation;
-            bool m_lockTextures;
-            const BBox3& m_worldBounds;
-        public:
-            TransformEntity(const Mat4x4d& transformation, const bool lockTextures, const BBox3& worldBounds) :
-            m_transformation(transformation),
-            m_lockTextures(lockTextures),
-            m_worldBounds(worldBounds) {}
-        private:
-            void doVisit(World* world)   {}
-            void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   {}
-            void doVisit(Entity* entity) {}
-            void doVisit(Brush* brush)   { brush->transform(m_transformation, m_lockTextures, m_worldBounds); }
-        };
-
         void Entity::doTransform(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
             if (hasChildren()) {
                 const NotifyNodeChange nodeChange(this);
-                TransformEntity visitor(transformation, lockTextures, worldBounds);
+                TransformObjectVisitor visitor(transformation, lockTextures, worldBounds);
                 iterate(visitor);
+                visitor.transformBrushes();
             } else {
                 // node change is called by setOrigin already
                 const Vec3 bottomCenter = Vec3(bounds().center().xy(), bounds().min.z());
@@ -313,5 +307,12 @@ namespace TrenchBroom {
             }
             m_boundsValid = true;
         }
+        
+        void Entity::invalidateModelSpecification() {
+            // only a change of the definition or of an attribute that was read when evaluating the model
+            // specification can change its result
+            if (m_modelSpecificationValid && (m_definition != m_modelDefinition || m_modelDependencies.changed(m_attributes)))
+                m_modelSpecificationValid = false;
+        }
     }
 }
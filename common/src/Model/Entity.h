@@ -24,7 +24,9 @@
 #include "VecMath.h"
 #include "Hit.h"
 #include "Assets/AssetTypes.h"
+#include "Assets/ModelDefinition.h"
 #include "Model/AttributableNode.h"
+#include "Model/EntityAttributesVariableStore.h"
 #include "Model/EntityRotationPolicy.h"
 #include "Model/Object.h"
 
@@ -39,6 +41,11 @@ namespace TrenchBroom {
             static const BBox3 DefaultBounds;
             mutable BBox3 m_bounds;
             mutable bool m_boundsValid;
+            
+            mutable Assets::ModelSpecification m_modelSpecification;
+            mutable EntityAttributesVariableStore::Dependencies m_modelDependencies;
+            mutable const Assets::EntityDefinition* m_modelDefinition;
+            mutable bool m_modelSpecificationValid;
         public:
             Entity();
             
@@ -93,6 +100,7 @@ namespace TrenchBroom {
         private:
             void invalidateBounds();
             void validateBounds() const;
+            void invalidateModelSpecification();
         private:
             Entity(const Entity&);
             Entity& operator=(const Entity&);
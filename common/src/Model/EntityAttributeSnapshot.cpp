@@ -39,5 +39,9 @@ namespace TrenchBroom {
             else
                 node->addOrUpdateAttribute(m_name, m_value);
         }
+        
+        size_t EntityAttributeSnapshot::memorySize() const {
+            return sizeof(EntityAttributeSnapshot) + m_name.capacity() + m_value.capacity();
+        }
     }
 }
@@ -38,6 +38,7 @@ namespace TrenchBroom {
             EntityAttributeSnapshot(const AttributeName& name);
 
             void restore(AttributableNode* node) const;
+            size_t memorySize() const;
         };
     }
 }
@@ -23,15 +23,42 @@
 
 namespace TrenchBroom {
     namespace Model {
-        EntityAttributesVariableStore::EntityAttributesVariableStore(const EntityAttributes& attributes) :
-        m_attributes(attributes) {}
+        void EntityAttributesVariableStore::Dependencies::add(const AttributeName& name, const AttributeValue* value) {
+            if (value == NULL)
+                m_attributes[name] = std::make_pair(false, AttributeValue());
+            else
+                m_attributes[name] = std::make_pair(true, *value);
+        }
+        
+        void EntityAttributesVariableStore::Dependencies::clear() {
+            m_attributes.clear();
+        }
+        
+        bool EntityAttributesVariableStore::Dependencies::changed(const EntityAttributes& attributes) const {
+            for (const auto& entry : m_attributes) {
+                const AttributeValue* value = attributes.attribute(entry.first);
+                if (value == NULL) {
+                    if (entry.second.first)
+                        return true;
+                } else if (!entry.second.first || *value != entry.second.second) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        EntityAttributesVariableStore::EntityAttributesVariableStore(const EntityAttributes& attributes, Dependencies* dependencies) :
+        m_attributes(attributes),
+        m_dependencies(dependencies) {}
         
         EL::VariableStore* EntityAttributesVariableStore::doClone() const {
-            return new EntityAttributesVariableStore(m_attributes);
+            return new EntityAttributesVariableStore(m_attributes, m_dependencies);
         }
         
         EL::Value EntityAttributesVariableStore::doGetValue(const String& name) const {
             const AttributeValue* value = m_attributes.attribute(name);
+            if (m_dependencies != NULL)
+                m_dependencies->add(name, value);
             if (value == NULL)
                 return EL::Value::Undefined;
             return EL::Value::ref(*value);
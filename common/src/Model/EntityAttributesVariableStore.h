@@ -22,16 +22,36 @@
 
 #include "Macros.h"
 #include "EL.h"
+#include "Model/ModelTypes.h"
+
+#include <map>
+#include <utility>
 
 namespace TrenchBroom {
     namespace Model {
         class EntityAttributes;
         
         class EntityAttributesVariableStore : public EL::VariableStore {
+        public:
+            /**
+             Records the attributes that were read from a store along with their values. Attributes that were
+             read but undefined are recorded too, so that adding them later counts as a change.
+             */
+            class Dependencies {
+            private:
+                typedef std::map<AttributeName, std::pair<bool, AttributeValue> > Map;
+                Map m_attributes;
+            public:
+                void add(const AttributeName& name, const AttributeValue* value);
+                void clear();
+                
+                bool changed(const EntityAttributes& attributes) const;
+            };
         private:
             const EntityAttributes& m_attributes;
+            Dependencies* m_dependencies;
         public:
-            EntityAttributesVariableStore(const EntityAttributes& attributes);
+            EntityAttributesVariableStore(const EntityAttributes& attributes, Dependencies* dependencies = NULL);
         private:
             VariableStore* doClone() const;
             EL::Value doGetValue(const String& name) const;
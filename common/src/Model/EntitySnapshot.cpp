@@ -32,5 +32,11 @@ namespace TrenchBroom {
             m_entity->addOrUpdateAttribute(m_origin.name(), m_origin.value());
             m_entity->addOrUpdateAttribute(m_rotation.name(), m_rotation.value());
         }
+
+        size_t EntitySnapshot::doGetMemorySize() const {
+            return (sizeof(EntitySnapshot) +
+                    m_origin.name().capacity() + m_origin.value().capacity() +
+                    m_rotation.name().capacity() + m_rotation.value().capacity());
+        }
     }
 }
@@ -36,6 +36,7 @@ namespace TrenchBroom {
             EntitySnapshot(Entity* entity, const EntityAttribute& origin, const EntityAttribute& rotation);
         private:
             void doRestore(const BBox3& worldBounds);
+            size_t doGetMemorySize() const;
         };
     }
 }
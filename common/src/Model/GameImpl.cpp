@@ -21,6 +21,7 @@
 
 #include "Macros.h"
 #include "Assets/Palette.h"
+#include "Assets/TextureManager.h"
 #include "IO/BrushFaceReader.h"
 #include "IO/Bsp29Parser.h"
 #include "IO/DefParser.h"
@@ -129,6 +130,7 @@ namespace TrenchBroom {
             IO::SimpleParserStatus parserStatus(logger);
             const IO::MappedFile::Ptr file = IO::Disk::openFile(IO::Disk::fixPath(path));
             IO::WorldReader reader(file->begin(), file->end(), brushContentTypeBuilder());
+            reader.setParallel(true);
             return reader.read(format, worldBounds, parserStatus);
         }
 
@@ -192,8 +194,9 @@ namespace TrenchBroom {
             const IO::Path::List paths = extractTextureCollections(world);
 
             const IO::Path::List fileSearchPaths = textureCollectionSearchPaths(documentPath);
-            IO::TextureLoader textureLoader(variables, m_gameFS, fileSearchPaths, m_config.textureConfig());
-            textureLoader.loadTextures(paths, textureManager);
+            const IO::Path cacheDirectory = IO::SystemPaths::userDataDirectory() + IO::Path("cache/textures");
+            IO::TextureLoader::Ptr textureLoader(new IO::TextureLoader(variables, m_gameFS, fileSearchPaths, m_config.textureConfig(), cacheDirectory));
+            textureManager.setTextureCollections(paths, textureLoader);
         }
 
         IO::Path::List GameImpl::textureCollectionSearchPaths(const IO::Path& documentPath) const {
@@ -228,6 +228,7 @@ namespace TrenchBroom {
         void Group::doTransform(const Mat4x4& transformation, const bool lockTextures, const BBox3& worldBounds) {
             TransformObjectVisitor visitor(transformation, lockTextures, worldBounds);
             iterate(visitor);
+            visitor.transformBrushes();
         }
         
         bool Group::doContains(const Node* node) const {
@@ -48,5 +48,12 @@ namespace TrenchBroom {
             for (NodeSnapshot* snapshot : m_snapshots)
                 snapshot->restore(worldBounds);
         }
+
+        size_t GroupSnapshot::doGetMemorySize() const {
+            size_t size = sizeof(GroupSnapshot) + m_snapshots.capacity() * sizeof(NodeSnapshot*);
+            for (const NodeSnapshot* snapshot : m_snapshots)
+                size += snapshot->memorySize();
+            return size;
+        }
     }
 }
@@ -24,6 +24,7 @@
 #include "Model/EditorContext.h"
 #include "Model/Node.h"
 
+#include <atomic>
 #include <cassert>
 
 namespace TrenchBroom {
@@ -87,7 +88,8 @@ namespace TrenchBroom {
         }
 
         size_t Issue::nextSeqId() {
-            static size_t seqId = 0;
+            // issues may be created on several threads at once, see World::validateAllIssues
+            static std::atomic<size_t> seqId(0);
             return seqId++;
         }
 
@@ -19,6 +19,7 @@
 
 #include "Layer.h"
 
+#include "CollectionUtils.h"
 #include "Model/Brush.h"
 #include "Model/Group.h"
 #include "Model/Entity.h"
@@ -29,18 +30,22 @@ namespace TrenchBroom {
     namespace Model {
         Layer::Layer(const String& name, const BBox3& worldBounds) :
         m_name(name),
-        m_octree(worldBounds, static_cast<FloatType>(64.0f)) {}
+        m_tree(worldBounds) {}
         
         void Layer::setName(const String& name) {
             m_name = name;
         }
 
+        void Layer::findNodesIntersecting(const BBox3& bounds, NodeList& result) const {
+            VectorUtils::append(result, m_tree.findObjects(bounds));
+        }
+
         const String& Layer::doGetName() const {
             return m_name;
         }
 
         const BBox3& Layer::doGetBounds() const {
-            return m_octree.bounds();
+            return m_tree.bounds();
         }
 
         Node* Layer::doClone(const BBox3& worldBounds) const {
@@ -73,60 +78,60 @@ namespace TrenchBroom {
             return false;
         }
 
-        class Layer::AddNodeToOctree : public NodeVisitor {
+        class Layer::AddNodeToTree : public NodeVisitor {
         private:
-            NodeTree& m_octree;
+            NodeTree& m_tree;
         public:
-            AddNodeToOctree(NodeTree& octree) :
-            m_octree(octree) {}
+            AddNodeToTree(NodeTree& tree) :
+            m_tree(tree) {}
         private:
             void doVisit(World* world)   {}
             void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.addObject(group->bounds(), group); }
-            void doVisit(Entity* entity) { m_octree.addObject(entity->bounds(), entity); }
-            void doVisit(Brush* brush)   { m_octree.addObject(brush->bounds(), brush); }
+            void doVisit(Group* group)   { m_tree.addObject(group->bounds(), group); }
+            void doVisit(Entity* entity) { m_tree.addObject(entity->bounds(), entity); }
+            void doVisit(Brush* brush)   { m_tree.addObject(brush->bounds(), brush); }
         };
         
-        class Layer::RemoveNodeFromOctree : public NodeVisitor {
+        class Layer::RemoveNodeFromTree : public NodeVisitor {
         private:
-            NodeTree& m_octree;
+            NodeTree& m_tree;
         public:
-            RemoveNodeFromOctree(NodeTree& octree) :
-            m_octree(octree) {}
+            RemoveNodeFromTree(NodeTree& tree) :
+            m_tree(tree) {}
         private:
             void doVisit(World* world)   {}
             void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.removeObject(group); }
-            void doVisit(Entity* entity) { m_octree.removeObject(entity); }
-            void doVisit(Brush* brush)   { m_octree.removeObject(brush); }
+            void doVisit(Group* group)   { m_tree.removeObject(group); }
+            void doVisit(Entity* entity) { m_tree.removeObject(entity); }
+            void doVisit(Brush* brush)   { m_tree.removeObject(brush); }
         };
         
-        class Layer::UpdateNodeInOctree : public NodeVisitor {
+        class Layer::UpdateNodeInTree : public NodeVisitor {
         private:
-            NodeTree& m_octree;
+            NodeTree& m_tree;
         public:
-            UpdateNodeInOctree(NodeTree& octree) :
-            m_octree(octree) {}
+            UpdateNodeInTree(NodeTree& tree) :
+            m_tree(tree) {}
         private:
             void doVisit(World* world)   {}
             void doVisit(Layer* layer)   {}
-            void doVisit(Group* group)   { m_octree.updateObject(group->bounds(), group); }
-            void doVisit(Entity* entity) { m_octree.updateObject(entity->bounds(), entity); }
-            void doVisit(Brush* brush)   { m_octree.updateObject(brush->bounds(), brush); }
+            void doVisit(Group* group)   { m_tree.updateObject(group->bounds(), group); }
+            void doVisit(Entity* entity) { m_tree.updateObject(entity->bounds(), entity); }
+            void doVisit(Brush* brush)   { m_tree.updateObject(brush->bounds(), brush); }
         };
 
         void Layer::doChildWasAdded(Node* node) {
-            AddNodeToOctree visitor(m_octree);
+            AddNodeToTree visitor(m_tree);
             node->accept(visitor);
         }
         
         void Layer::doChildWillBeRemoved(Node* node) {
-            RemoveNodeFromOctree visitor(m_octree);
+            RemoveNodeFromTree visitor(m_tree);
             node->accept(visitor);
         }
         
         void Layer::doChildBoundsDidChange(Node* node) {
-            UpdateNodeInOctree visitor(m_octree);
+            UpdateNodeInTree visitor(m_tree);
             node->accept(visitor);
         }
 
@@ -147,12 +152,12 @@ namespace TrenchBroom {
         }
 
         void Layer::doPick(const Ray3& ray, PickResult& pickResult) const {
-            for (const Node* node : m_octree.findObjects(ray))
+            for (const Node* node : m_tree.findObjects(ray))
                 node->pick(ray, pickResult);
         }
         
         void Layer::doFindNodesContaining(const Vec3& point, NodeList& result) {
-            for (Node* node : m_octree.findObjects(point))
+            for (Node* node : m_tree.findObjects(point))
                 node->findNodesContaining(point, result);
         }
 
@@ -23,7 +23,7 @@
 #include "StringUtils.h"
 #include "Model/ModelTypes.h"
 #include "Model/Node.h"
-#include "Model/Octree.h"
+#include "Model/AABBTree.h"
 
 namespace TrenchBroom {
     namespace Model {
@@ -31,12 +31,17 @@ namespace TrenchBroom {
         private:
             String m_name;
             
-            typedef Octree<FloatType, Node*> NodeTree;
-            NodeTree m_octree;
+            typedef AABBTree<FloatType, Node*> NodeTree;
+            NodeTree m_tree;
         public:
             Layer(const String& name, const BBox3& worldBounds);
             
             void setName(const String& name);
+
+            /**
+             Adds the children of this layer whose bounds intersect the given bounds to the given list.
+             */
+            void findNodesIntersecting(const BBox3& bounds, NodeList& result) const;
         private: // implement Node interface
             const String& doGetName() const;
             const BBox3& doGetBounds() const;
@@ -46,9 +51,9 @@ namespace TrenchBroom {
             bool doCanRemoveChild(const Node* child) const;
             bool doRemoveIfEmpty() const;
             
-            class AddNodeToOctree;
-            class RemoveNodeFromOctree;
-            class UpdateNodeInOctree;
+            class AddNodeToTree;
+            class RemoveNodeFromTree;
+            class UpdateNodeInTree;
             
             void doChildWasAdded(Node* node);
             void doChildWillBeRemoved(Node* node);
@@ -19,6 +19,15 @@
 
 #include "ModelUtils.h"
 
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Group.h"
+#include "Model/Layer.h"
+#include "Model/NodeVisitor.h"
+#include "Model/World.h"
+
 namespace TrenchBroom {
     namespace Model {
         Model::NodeList collectParents(const Model::NodeList& nodes) {
@@ -54,5 +63,50 @@ namespace TrenchBroom {
             
             return result;
         }
+        
+        class MemorySizeVisitor : public Model::ConstNodeVisitor {
+        private:
+            size_t m_size;
+        public:
+            MemorySizeVisitor() :
+            m_size(0) {}
+            
+            size_t size() const {
+                return m_size;
+            }
+        private:
+            void doVisit(const Model::World* world)   { m_size += sizeof(Model::World) + attributesSize(world); }
+            void doVisit(const Model::Layer* layer)   { m_size += sizeof(Model::Layer) + layer->name().capacity(); }
+            void doVisit(const Model::Group* group)   { m_size += sizeof(Model::Group) + group->name().capacity(); }
+            void doVisit(const Model::Entity* entity) { m_size += sizeof(Model::Entity) + attributesSize(entity); }
+            
+            void doVisit(const Model::Brush* brush) {
+                // every edge consists of two half edges
+                m_size += sizeof(Model::Brush);
+                m_size += brush->faceCount() * (sizeof(Model::BrushFace) + sizeof(Model::BrushFaceGeometry));
+                m_size += brush->edgeCount() * (sizeof(Model::BrushEdge) + 2 * sizeof(Model::BrushHalfEdge));
+                m_size += brush->vertexCount() * sizeof(Model::BrushVertex);
+            }
+            
+            static size_t attributesSize(const Model::AttributableNode* node) {
+                size_t size = 0;
+                for (const Model::EntityAttribute& attribute : node->attributes())
+                    size += sizeof(Model::EntityAttribute) + attribute.name().capacity() + attribute.value().capacity();
+                return size;
+            }
+        };
+        
+        size_t memorySize(const Model::NodeList& nodes) {
+            MemorySizeVisitor visitor;
+            Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), visitor);
+            return visitor.size();
+        }
+        
+        size_t memorySize(const Model::ParentChildrenMap& nodes) {
+            size_t size = 0;
+            for (const auto& entry : nodes)
+                size += memorySize(entry.second);
+            return size;
+        }
     }
 }
@@ -38,6 +38,12 @@ namespace TrenchBroom {
 
         Model::NodeList collectChildren(const Model::ParentChildrenMap& nodes);
         Model::ParentChildrenMap parentChildrenMap(const Model::NodeList& nodes);
+        
+        /**
+         Returns the approximate number of bytes used by the given nodes, including their descendants.
+         */
+        size_t memorySize(const Model::NodeList& nodes);
+        size_t memorySize(const Model::ParentChildrenMap& nodes);
     }
 }
 
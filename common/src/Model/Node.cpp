@@ -539,6 +539,10 @@ namespace TrenchBroom {
             return m_lineNumber;
         }
 
+        size_t Node::lineCount() const {
+            return m_lineCount;
+        }
+
         void Node::setFilePosition(const size_t lineNumber, const size_t lineCount) {
             m_lineNumber = lineNumber;
             m_lineCount = lineCount;
@@ -564,6 +568,10 @@ namespace TrenchBroom {
                 m_hiddenIssues &= ~type;
         }
 
+        bool Node::issuesValid() const {
+            return m_issuesValid;
+        }
+        
         void Node::validateIssues(const IssueGeneratorArray& issueGenerators) {
             if (!m_issuesValid) {
                 std::for_each(std::begin(issueGenerators), std::end(issueGenerators), [this](const IssueGenerator* generator) { doGenerateIssues(generator, m_issues); });
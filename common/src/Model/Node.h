@@ -238,6 +238,7 @@ namespace TrenchBroom {
             FloatType intersectWithRay(const Ray3& ray) const;
         public: // file position
             size_t lineNumber() const;
+            size_t lineCount() const;
             void setFilePosition(size_t lineNumber, size_t lineCount);
             bool containsLine(size_t lineNumber) const;
         public: // issue management
@@ -246,9 +247,10 @@ namespace TrenchBroom {
             bool issueHidden(IssueType type) const;
             void setIssueHidden(IssueType type, bool hidden);
         public: // should only be called from this and from the world
+            bool issuesValid() const;
             void invalidateIssues() const;
-        private:
             void validateIssues(const IssueGeneratorArray& issueGenerators);
+        private:
             void clearIssues() const;
         public: // visitors
             template <class V>
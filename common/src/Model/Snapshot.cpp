@@ -41,6 +41,18 @@ namespace TrenchBroom {
                 snapshot->restore();
         }
 
+        size_t Snapshot::memorySize() const {
+            size_t size = sizeof(Snapshot);
+            size += m_nodeSnapshots.capacity() * sizeof(NodeSnapshot*);
+            size += m_brushFaceSnapshots.capacity() * sizeof(BrushFaceSnapshot*);
+            
+            for (const NodeSnapshot* snapshot : m_nodeSnapshots)
+                size += snapshot->memorySize();
+            for (const BrushFaceSnapshot* snapshot : m_brushFaceSnapshots)
+                size += snapshot->memorySize();
+            return size;
+        }
+
         void Snapshot::takeSnapshot(Node* node) {
             NodeSnapshot* snapshot = node->takeSnapshot();
             if (snapshot != NULL)
@@ -47,6 +47,11 @@ namespace TrenchBroom {
             
             void restoreNodes(const BBox3& worldBounds);
             void restoreBrushFaces();
+            
+            /**
+             Returns the approximate number of bytes used by this snapshot.
+             */
+            size_t memorySize() const;
         private:
             void takeSnapshot(Node* node);
             void takeSnapshot(BrushFace* face);
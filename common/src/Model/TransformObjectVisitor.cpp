@@ -30,10 +30,15 @@ namespace TrenchBroom {
         m_lockTextures(lockTextures),
         m_worldBounds(worldBounds) {}
 
+        void TransformObjectVisitor::transformBrushes() {
+            Brush::transformBrushes(m_brushes, m_transformation, m_lockTextures, m_worldBounds);
+            m_brushes.clear();
+        }
+
         void TransformObjectVisitor::doVisit(World* world)   {}
         void TransformObjectVisitor::doVisit(Layer* layer)   {}
         void TransformObjectVisitor::doVisit(Group* group)   {  group->transform(m_transformation, m_lockTextures, m_worldBounds); }
         void TransformObjectVisitor::doVisit(Entity* entity) { entity->transform(m_transformation, m_lockTextures, m_worldBounds); }
-        void TransformObjectVisitor::doVisit(Brush* brush)   {  brush->transform(m_transformation, m_lockTextures, m_worldBounds); }
+        void TransformObjectVisitor::doVisit(Brush* brush)   { m_brushes.push_back(brush); }
     }
 }
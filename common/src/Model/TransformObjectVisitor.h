@@ -26,13 +26,20 @@
 
 namespace TrenchBroom {
     namespace Model {
+        /**
+         Transforms the visited groups and entities right away. The visited brushes are collected instead so that they
+         can be transformed in parallel by calling transformBrushes once all nodes have been visited.
+         */
         class TransformObjectVisitor : public NodeVisitor {
         private:
             const Mat4x4d& m_transformation;
             bool m_lockTextures;
             const BBox3& m_worldBounds;
+            BrushArray m_brushes;
         public:
             TransformObjectVisitor(const Mat4x4d& transformation, bool lockTextures, const BBox3& worldBounds);
+            
+            void transformBrushes();
         private:
             void doVisit(World* world);
             void doVisit(Layer* layer);
@@ -19,6 +19,7 @@
 
 #include "World.h"
 
+#include "ParallelUtils.h"
 #include "Model/AssortNodesVisitor.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
@@ -96,6 +97,38 @@ namespace TrenchBroom {
             InvalidateAllIssuesVisitor visitor;
             acceptAndRecurse(visitor);
         }
+        
+        class World::CollectInvalidIssueNodesVisitor : public NodeVisitor {
+        private:
+            NodeList m_nodes;
+        public:
+            const NodeList& nodes() const {
+                return m_nodes;
+            }
+        private:
+            void doVisit(World* world)   { collect(world);  }
+            void doVisit(Layer* layer)   { collect(layer);  }
+            void doVisit(Group* group)   { collect(group);  }
+            void doVisit(Entity* entity) { collect(entity); }
+            void doVisit(Brush* brush)   { collect(brush);  }
+            
+            void collect(Node* node) {
+                if (!node->issuesValid()) {
+                    // some generators query the bounds, which are cached lazily and must not be computed concurrently
+                    node->bounds();
+                    m_nodes.push_back(node);
+                }
+            }
+        };
+        
+        void World::validateAllIssues() {
+            CollectInvalidIssueNodesVisitor visitor;
+            acceptAndRecurse(visitor);
+            
+            const NodeList& nodes = visitor.nodes();
+            const IssueGeneratorList& issueGenerators = registeredIssueGenerators();
+            ParallelUtils::parallelFor(nodes.size(), [&nodes, &issueGenerators](const size_t i) { nodes[i]->validateIssues(issueGenerators); });
+        }
 
         const BBox3& World::doGetBounds() const {
             // TODO: this should probably return the world bounds, as it does in Layer::doGetBounds
@@ -198,19 +231,29 @@ namespace TrenchBroom {
         }
         
         void World::doFindAttributableNodesWithAttribute(const AttributeName& name, const AttributeValue& value, AttributableNodeList& result) const {
-            VectorUtils::append(result, m_attributableIndex.findAttributableNodes(AttributableNodeIndexQuery::exact(name), value));
+            if (name == AttributeNames::Targetname)
+                m_linkIndex.findTargets(value, result);
+            else
+                VectorUtils::append(result, m_attributableIndex.findAttributableNodes(AttributableNodeIndexQuery::exact(name), value));
         }
         
         void World::doFindAttributableNodesWithNumberedAttribute(const AttributeName& prefix, const AttributeValue& value, AttributableNodeList& result) const {
-            VectorUtils::append(result, m_attributableIndex.findAttributableNodes(AttributableNodeIndexQuery::numbered(prefix), value));
+            if (prefix == AttributeNames::Target)
+                m_linkIndex.findLinkSources(value, result);
+            else if (prefix == AttributeNames::Killtarget)
+                m_linkIndex.findKillSources(value, result);
+            else
+                VectorUtils::append(result, m_attributableIndex.findAttributableNodes(AttributableNodeIndexQuery::numbered(prefix), value));
         }
         
         void World::doAddToIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) {
             m_attributableIndex.addAttribute(attributable, name, value);
+            m_linkIndex.addAttribute(attributable, name, value);
         }
         
         void World::doRemoveFromIndex(AttributableNode* attributable, const AttributeName& name, const AttributeValue& value) {
             m_attributableIndex.removeAttribute(attributable, name, value);
+            m_linkIndex.removeAttribute(attributable, name, value);
         }
 
         void World::doAttributesDidChange() {}
@@ -24,6 +24,7 @@
 #include "VecMath.h"
 #include "Model/AttributableNode.h"
 #include "Model/AttributableNodeIndex.h"
+#include "Model/AttributableNodeLinkIndex.h"
 #include "Model/IssueGeneratorRegistry.h"
 #include "Model/MapFormat.h"
 #include "Model/ModelFactory.h"
@@ -40,6 +41,7 @@ namespace TrenchBroom {
             ModelFactoryImpl m_factory;
             Layer* m_defaultLayer;
             AttributableNodeIndex m_attributableIndex;
+            AttributableNodeLinkIndex m_linkIndex;
             IssueGeneratorRegistry m_issueGeneratorRegistry;
             bool m_issuesMustBeValidated;
         public:
@@ -56,8 +58,15 @@ namespace TrenchBroom {
             IssueQuickFixList quickFixes(IssueType issueTypes) const;
             void registerIssueGenerator(IssueGenerator* issueGenerator);
             void unregisterAllIssueGenerators();
+            
+            /**
+             Generates the issues of all nodes whose issues have been invalidated since they were last generated.
+             The nodes are processed in parallel, so the issue generators must only read from the nodes.
+             */
+            void validateAllIssues();
         private:
             class InvalidateAllIssuesVisitor;
+            class CollectInvalidIssueNodesVisitor;
             void invalidateAllIssues();
         private: // implement Node interface
             const BBox3& doGetBounds() const;
@@ -0,0 +1,243 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_ParallelUtils_h
+#define TrenchBroom_ParallelUtils_h
+
+#include "Macros.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ParallelUtils {
+    inline size_t threadCount() {
+        const unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? static_cast<size_t>(count) : 1;
+    }
+
+    class WorkerPool;
+    
+    /**
+     A task that several threads may run at the same time. Every thread that runs it keeps taking work from it
+     until none is left, so a task must not throw.
+     */
+    class Task {
+    private:
+        friend class WorkerPool;
+        size_t m_running;
+    public:
+        Task() :
+        m_running(0) {}
+        
+        virtual ~Task() {}
+        
+        void run() {
+            doRun();
+        }
+    private:
+        virtual void doRun() = 0;
+    };
+    
+    /**
+     A fixed set of worker threads that is started once and shared by all calls to parallelFor.
+     */
+    class WorkerPool {
+    private:
+        std::vector<std::thread> m_workers;
+        std::deque<Task*> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_taskQueued;
+        std::condition_variable m_taskFinished;
+        bool m_stop;
+    public:
+        static WorkerPool& instance() {
+            static WorkerPool pool(threadCount() - 1);
+            return pool;
+        }
+        
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_taskQueued.notify_all();
+            for (std::thread& worker : m_workers)
+                worker.join();
+        }
+        
+        size_t workerCount() const {
+            return m_workers.size();
+        }
+        
+        /**
+         Runs the given task on the calling thread and on up to the given number of workers. Workers that are
+         busy with other tasks do not join in, and the calling thread never waits for them to become free.
+         Returns once every thread that has started running the task is done with it.
+         */
+        void run(Task& task, const size_t helperCount) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.insert(std::end(m_queue), helperCount, &task);
+            }
+            m_taskQueued.notify_all();
+            
+            task.run();
+            
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queue.erase(std::remove(std::begin(m_queue), std::end(m_queue), &task), std::end(m_queue));
+            m_taskFinished.wait(lock, [&task]() { return task.m_running == 0; });
+        }
+    private:
+        WorkerPool(const size_t workerCount) :
+        m_stop(false) {
+            m_workers.reserve(workerCount);
+            for (size_t i = 0; i < workerCount; ++i)
+                m_workers.push_back(std::thread([this]() { work(); }));
+        }
+        
+        void work() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true) {
+                m_taskQueued.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                if (m_stop)
+                    return;
+                
+                Task* task = m_queue.front();
+                m_queue.pop_front();
+                ++task->m_running;
+                
+                lock.unlock();
+                task->run();
+                lock.lock();
+                
+                if (--task->m_running == 0)
+                    m_taskFinished.notify_all();
+            }
+        }
+        
+        deleteCopyAndAssignment(WorkerPool)
+    };
+    
+    template <typename F>
+    class ForTask : public Task {
+    private:
+        const size_t m_count;
+        F& m_f;
+        std::atomic<size_t> m_next;
+        std::atomic<bool> m_failed;
+        std::exception_ptr m_exception;
+        std::mutex m_exceptionMutex;
+    public:
+        ForTask(const size_t count, F& f) :
+        m_count(count),
+        m_f(f),
+        m_next(0),
+        m_failed(false) {}
+        
+        void rethrow() const {
+            if (m_exception)
+                std::rethrow_exception(m_exception);
+        }
+    private:
+        void doRun() {
+            size_t i;
+            while (!m_failed && (i = m_next++) < m_count) {
+                try {
+                    m_f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_exceptionMutex);
+                    if (!m_failed) {
+                        m_exception = std::current_exception();
+                        m_failed = true;
+                    }
+                }
+            }
+        }
+    };
+
+    /**
+     While an instance of this class exists, parallelFor calls f for every index in order on the calling thread.
+     This allows comparing the results of parallel code with those of a serial run.
+     */
+    class SerialScope {
+    public:
+        SerialScope() {
+            ++depth();
+        }
+        
+        ~SerialScope() {
+            --depth();
+        }
+        
+        static bool active() {
+            return depth() > 0;
+        }
+    private:
+        static std::atomic<size_t>& depth() {
+            static std::atomic<size_t> depth(0);
+            return depth;
+        }
+        
+        deleteCopyAndAssignment(SerialScope)
+    };
+    
+    /**
+     Calls f(i) for every i in [0, count) on the calling thread and the idle threads of the shared worker pool.
+     The indices are handed out dynamically, so f may be called in any order and from any of the threads.
+     Returns once all calls have returned. If any call throws, the remaining indices are skipped and the
+     first exception is rethrown on the calling thread. Calling parallelFor from within f is allowed.
+     */
+    template <typename F>
+    void parallelFor(const size_t count, F f) {
+        if (count == 0)
+            return;
+
+        WorkerPool& pool = WorkerPool::instance();
+        const size_t helperCount = std::min(pool.workerCount(), count - 1);
+        if (helperCount == 0 || SerialScope::active()) {
+            for (size_t i = 0; i < count; ++i)
+                f(i);
+            return;
+        }
+
+        ForTask<F> task(count, f);
+        pool.run(task, helperCount);
+        task.rethrow();
+    }
+
+    /**
+     Calls f(*it) for every element in [cur, end) in parallel, see parallelFor.
+     */
+    template <typename I, typename F>
+    void parallelForEach(I cur, I end, F f) {
+        std::vector<I> items;
+        while (cur != end)
+            items.push_back(cur++);
+        parallelFor(items.size(), [&](const size_t i) { f(*items[i]); });
+    }
+}
+
+#endif
@@ -375,6 +375,14 @@ private:
     bool checkLeavingEdges(const Vertex* v) const;
     
     void updateBounds();
+public: // Transformation
+    /**
+     Applies the given affine transformation to the vertices. The transformation must be invertible, so that the
+     topology of the polyhedron does not change. Reflections are handled by reversing the face boundaries.
+     */
+    void transform(const Mat<T,4,4>& transformation);
+private:
+    void invertOrientation();
 public: // Vertex correction and edge healing
     void correctVertexPositions(const size_t decimals = 0, const T epsilon = Math::Constants<T>::correctEpsilon());
     bool healEdges(const T minLength = Math::Constants<T>::pointStatusEpsilon());
@@ -977,6 +977,54 @@ bool Polyhedron<T,FP,VP>::checkLeavingEdges(const Vertex* v) const {
     return true;
 }
 
+template <typename T, typename FP, typename VP>
+void Polyhedron<T,FP,VP>::transform(const Mat<T,4,4>& transformation) {
+    if (empty())
+        return;
+    
+    assert(!Math::zero(matrixDeterminant(stripTranslation(transformation))));
+    if (matrixDeterminant(stripTranslation(transformation)) < 0.0)
+        invertOrientation();
+    
+    Vertex* firstVertex = m_vertices.front();
+    Vertex* currentVertex = firstVertex;
+    do {
+        currentVertex->setPosition(transformation * currentVertex->position());
+        currentVertex = currentVertex->next();
+    } while (currentVertex != firstVertex);
+    
+    updateBounds();
+}
+
+template <typename T, typename FP, typename VP>
+void Polyhedron<T,FP,VP>::invertOrientation() {
+    // Every half edge remains in its face, but runs in the opposite direction, that is, it now originates at its
+    // previous destination. Reversing the boundaries keeps the half edges of each face in order.
+    if (m_faces.empty())
+        return;
+    
+    typedef std::pair<HalfEdge*, Vertex*> NewOrigin;
+    std::vector<NewOrigin> newOrigins;
+    newOrigins.reserve(2 * edgeCount());
+    
+    Face* firstFace = m_faces.front();
+    Face* currentFace = firstFace;
+    do {
+        HalfEdge* firstEdge = currentFace->boundary().front();
+        HalfEdge* currentEdge = firstEdge;
+        do {
+            newOrigins.push_back(std::make_pair(currentEdge, currentEdge->destination()));
+            currentEdge = currentEdge->next();
+        } while (currentEdge != firstEdge);
+        
+        currentFace->flip();
+        currentFace = currentFace->next();
+    } while (currentFace != firstFace);
+    
+    for (const NewOrigin& newOrigin : newOrigins)
+        newOrigin.first->setOrigin(newOrigin.second);
+}
+
 template <typename T, typename FP, typename VP>
 void Polyhedron<T,FP,VP>::correctVertexPositions(const size_t decimals, const T epsilon) {
     Vertex* firstVertex = m_vertices.front();
@@ -19,19 +19,25 @@
 
 #include "BrushRenderer.h"
 
+#include "CollectionUtils.h"
+#include "ParallelUtils.h"
 #include "Preferences.h"
 #include "PreferenceManager.h"
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
 #include "Model/EditorContext.h"
-#include "Model/NodeVisitor.h"
-#include "Renderer/IndexArrayMapBuilder.h"
+#include "Renderer/Camera.h"
+#include "Renderer/RenderBatch.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/RenderUtils.h"
-#include "Renderer/TexturedIndexArrayBuilder.h"
+#include "Renderer/Vbo.h"
+#include "Renderer/VboBlock.h"
+#include "Renderer/VertexListBuilder.h"
 #include "Renderer/VertexSpec.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Renderer {
         BrushRenderer::FaceAcceptor::~FaceAcceptor() {}
@@ -121,9 +127,348 @@ namespace TrenchBroom {
             return m_transparent;
         }
 
+        class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
+        private:
+            const Filter& m_filter;
+            bool m_showHiddenBrushes;
+            NoFilter m_noFilter;
+        public:
+            FilterWrapper(const Filter& filter, const bool showHiddenBrushes) :
+            m_filter(filter),
+            m_showHiddenBrushes(showHiddenBrushes),
+            m_noFilter(false) {}
+            
+            void doProvideFaces(const Model::Brush* brush, FaceAcceptor& faceAcceptor) const {
+                if (m_showHiddenBrushes)
+                    m_noFilter.provideFaces(brush, faceAcceptor);
+                else
+                    m_filter.provideFaces(brush, faceAcceptor);
+            }
+            
+            void doProvideEdges(const Model::Brush* brush, EdgeAcceptor& edgeAcceptor) const {
+                if (m_showHiddenBrushes)
+                    m_noFilter.provideEdges(brush, edgeAcceptor);
+                else
+                    m_filter.provideEdges(brush, edgeAcceptor);
+            }
+
+            bool doIsTransparent(const Model::Brush* brush) const { return m_filter.transparent(brush); }
+        };
+        
+        BrushRenderer::DrawRanges::DrawRanges() :
+        m_end(0) {}
+        
+        bool BrushRenderer::DrawRanges::empty() const {
+            return m_counts.empty();
+        }
+        
+        void BrushRenderer::DrawRanges::add(const size_t offset, const size_t count) {
+            if (count == 0)
+                return;
+            
+            // ranges that continue the previous one are merged into it
+            if (!m_counts.empty() && offset == m_end) {
+                m_counts.back() += static_cast<GLsizei>(count);
+            } else {
+                m_counts.push_back(static_cast<GLsizei>(count));
+                m_offsets.push_back(reinterpret_cast<const GLvoid*>(offset));
+            }
+            m_end = offset + count * sizeof(GLuint);
+        }
+        
+        void BrushRenderer::DrawRanges::clear() {
+            m_counts.clear();
+            m_offsets.clear();
+            m_end = 0;
+        }
+        
+        void BrushRenderer::DrawRanges::render(const PrimType primType) const {
+            if (m_counts.empty())
+                return;
+            
+            const GLsizei primCount = static_cast<GLsizei>(m_counts.size());
+            const GLvoid** offsets = const_cast<const GLvoid**>(&m_offsets[0]);
+            glAssert(glMultiDrawElements(primType, &m_counts[0], glType<GLuint>(), offsets, primCount));
+        }
+        
+        /**
+         Holds the vertices and indices of a single brush. Each brush owns a block in the shared vertex buffer and a
+         block in the shared index buffer, so changing a brush only requires its own blocks to be written again.
+         
+         The vertex block is aligned to the vertex size so that the brush's indices can refer to the vertices by
+         their absolute position in the vertex buffer. This allows all brushes to be drawn with a single vertex
+         setup.
+         */
+        class BrushRenderer::BrushData : public BrushRenderer::FaceAcceptor, public BrushRenderer::EdgeAcceptor {
+        private:
+            typedef Model::BrushFace::VertexSpec VertexSpec;
+            typedef VertexSpec::Vertex::List VertexList;
+            typedef GLuint Index;
+            typedef std::vector<Index> IndexList;
+            
+            struct FaceRange {
+                const Assets::Texture* texture;
+                size_t offset;
+                size_t count;
+                
+                FaceRange(const Assets::Texture* i_texture, const size_t i_offset) :
+                texture(i_texture),
+                offset(i_offset),
+                count(0) {}
+            };
+            
+            typedef std::vector<FaceRange> FaceRangeList;
+            
+            struct CompareFacesByTexture {
+                bool operator()(const Model::BrushFace* lhs, const Model::BrushFace* rhs) const {
+                    return lhs->texture() < rhs->texture();
+                }
+            };
+            
+            typedef std::vector<const Model::BrushFace*> FaceList;
+            
+            const Model::Brush* m_brush;
+            FaceList m_faces;
+            VertexList m_vertices;
+            IndexList m_indices;
+            
+            FaceRangeList m_faceRanges;
+            size_t m_edgeOffset;
+            size_t m_edgeCount;
+            bool m_transparent;
+            
+            VboBlock* m_vertexBlock;
+            VboBlock* m_indexBlock;
+            bool m_valid;
+        public:
+            BrushData(const Model::Brush* brush) :
+            m_brush(brush),
+            m_edgeOffset(0),
+            m_edgeCount(0),
+            m_transparent(false),
+            m_vertexBlock(NULL),
+            m_indexBlock(NULL),
+            m_valid(false) {}
+            
+            ~BrushData() {
+                freeBlocks();
+            }
+            
+            const Model::Brush* brush() const {
+                return m_brush;
+            }
+            
+            bool valid() const {
+                return m_valid;
+            }
+            
+            void invalidate() {
+                freeBlocks();
+                m_valid = false;
+            }
+            
+            /**
+             Only touches the faces and the geometry of this brush, so different brushes can be validated in
+             parallel.
+             */
+            void validate(const FilterWrapper& filter) {
+                assert(!m_valid);
+                assert(m_vertexBlock == NULL && m_indexBlock == NULL);
+                
+                m_vertices.clear();
+                m_indices.clear();
+                m_faceRanges.clear();
+                
+                m_transparent = filter.transparent(m_brush);
+                
+                filter.provideFaces(m_brush, *this);
+                std::stable_sort(std::begin(m_faces), std::end(m_faces), CompareFacesByTexture());
+                collectFaces();
+                m_faces.clear();
+                
+                m_edgeOffset = m_indices.size();
+                if (!m_vertices.empty())
+                    filter.provideEdges(m_brush, *this);
+                m_edgeCount = m_indices.size() - m_edgeOffset;
+                
+                m_valid = true;
+            }
+            
+            void prepareVertices(Vbo& vertexVbo) {
+                if (m_vertexBlock != NULL || m_vertices.empty())
+                    return;
+                
+                // allocate enough slack to start the vertices at a multiple of the vertex size
+                const size_t size = m_vertices.size() * VertexSpec::Size;
+                m_vertexBlock = vertexVbo.allocateBlock(size + VertexSpec::Size - 1);
+                
+                const size_t baseVertex = (m_vertexBlock->offset() + VertexSpec::Size - 1) / VertexSpec::Size;
+                const size_t address = baseVertex * VertexSpec::Size - m_vertexBlock->offset();
+                
+                MapVboBlock map(m_vertexBlock);
+                m_vertexBlock->writeBuffer(address, m_vertices);
+                VectorUtils::clearToZero(m_vertices);
+                
+                for (Index& index : m_indices)
+                    index += static_cast<Index>(baseVertex);
+            }
+            
+            void prepareIndices(Vbo& indexVbo) {
+                if (m_indexBlock != NULL || m_indices.empty())
+                    return;
+                
+                assert(m_vertexBlock != NULL);
+                m_indexBlock = indexVbo.allocateBlock(m_indices.size() * sizeof(Index));
+                
+                MapVboBlock map(m_indexBlock);
+                m_indexBlock->writeBuffer(0, m_indices);
+                VectorUtils::clearToZero(m_indices);
+            }
+            
+            void collectDrawRanges(TextureDrawRanges& opaqueFaceRanges, TextureDrawRanges& transparentFaceRanges, DrawRanges& edgeRanges) const {
+                if (m_indexBlock == NULL)
+                    return;
+                
+                TextureDrawRanges& faceRanges = m_transparent ? transparentFaceRanges : opaqueFaceRanges;
+                for (const FaceRange& range : m_faceRanges)
+                    faceRanges[range.texture].add(indexAddress(range.offset), range.count);
+                edgeRanges.add(indexAddress(m_edgeOffset), m_edgeCount);
+            }
+        private:
+            void collectFaces() {
+                size_t vertexCount = 0;
+                size_t indexCount = 0;
+                for (const Model::BrushFace* face : m_faces) {
+                    vertexCount += face->vertexCount();
+                    indexCount += 3 * (face->vertexCount() - 2);
+                }
+                
+                VertexListBuilder<VertexSpec> builder(vertexCount);
+                m_indices.reserve(indexCount);
+                
+                for (const Model::BrushFace* face : m_faces) {
+                    if (m_faceRanges.empty() || m_faceRanges.back().texture != face->texture())
+                        m_faceRanges.push_back(FaceRange(face->texture(), m_indices.size()));
+                    
+                    const Index baseIndex = static_cast<Index>(builder.vertexCount());
+                    face->getVertices(builder);
+                    addPolygon(baseIndex, face->vertexCount());
+                    m_faceRanges.back().count = m_indices.size() - m_faceRanges.back().offset;
+                }
+                
+                using std::swap;
+                swap(m_vertices, builder.vertices());
+            }
+            
+            void addPolygon(const Index baseIndex, const size_t vertexCount) {
+                for (size_t i = 0; i < vertexCount - 2; ++i) {
+                    m_indices.push_back(baseIndex);
+                    m_indices.push_back(baseIndex + static_cast<Index>(i + 1));
+                    m_indices.push_back(baseIndex + static_cast<Index>(i + 2));
+                }
+            }
+            
+            void accept(const Model::BrushFace* face) {
+                m_faces.push_back(face);
+            }
+            
+            void accept(const Model::BrushEdge* edge) {
+                m_indices.push_back(edge->firstVertex()->payload());
+                m_indices.push_back(edge->secondVertex()->payload());
+            }
+            
+            size_t indexAddress(const size_t index) const {
+                return m_indexBlock->offset() + index * sizeof(Index);
+            }
+            
+            void freeBlocks() {
+                if (m_vertexBlock != NULL) {
+                    m_vertexBlock->free();
+                    m_vertexBlock = NULL;
+                }
+                if (m_indexBlock != NULL) {
+                    m_indexBlock->free();
+                    m_indexBlock = NULL;
+                }
+            }
+        };
+        
+        class BrushRenderer::FaceRender : public FaceRenderer::RenderBase, public IndexedRenderable {
+        private:
+            BrushRenderer& m_renderer;
+            const TextureDrawRanges& m_ranges;
+        public:
+            FaceRender(BrushRenderer& renderer, const TextureDrawRanges& ranges, const Color& faceColor) :
+            RenderBase(faceColor),
+            m_renderer(renderer),
+            m_ranges(ranges) {}
+        private:
+            void doPrepareVertices(Vbo& vertexVbo) {
+                m_renderer.prepareVertices(vertexVbo);
+            }
+            
+            void doPrepareIndices(Vbo& indexVbo) {
+                m_renderer.prepareIndices(indexVbo);
+            }
+            
+            void doRender(RenderContext& renderContext) {
+                if (m_ranges.empty())
+                    return;
+                
+                Model::BrushFace::VertexSpec::setup(0);
+                renderFaces(renderContext);
+                Model::BrushFace::VertexSpec::cleanup();
+            }
+            
+            void doRenderFaces(TextureRenderFunc& func) {
+                for (const auto& entry : m_ranges) {
+                    const Assets::Texture* texture = entry.first;
+                    const DrawRanges& ranges = entry.second;
+                    
+                    func.before(texture);
+                    ranges.render(GL_TRIANGLES);
+                    func.after(texture);
+                }
+            }
+        };
+        
+        class BrushRenderer::EdgeRender : public EdgeRenderer::RenderBase, public IndexedRenderable {
+        private:
+            BrushRenderer& m_renderer;
+            const DrawRanges& m_ranges;
+        public:
+            EdgeRender(BrushRenderer& renderer, const DrawRanges& ranges, const EdgeRenderer::Params& params) :
+            RenderBase(params),
+            m_renderer(renderer),
+            m_ranges(ranges) {}
+        private:
+            void doPrepareVertices(Vbo& vertexVbo) {
+                m_renderer.prepareVertices(vertexVbo);
+            }
+            
+            void doPrepareIndices(Vbo& indexVbo) {
+                m_renderer.prepareIndices(indexVbo);
+            }
+            
+            void doRender(RenderContext& renderContext) {
+                if (m_ranges.empty())
+                    return;
+                renderEdges(renderContext);
+            }
+            
+            void doRenderVertices(RenderContext& renderContext) {
+                Model::BrushFace::VertexSpec::setup(0);
+                m_ranges.render(GL_LINES);
+                Model::BrushFace::VertexSpec::cleanup();
+            }
+        };
+        
         BrushRenderer::BrushRenderer(const bool transparent) :
         m_filter(new NoFilter(transparent)),
         m_valid(true),
+        m_prepared(true),
+        m_brushTree(BBox3(std::numeric_limits<FloatType>::max())),
+        m_drawRangesValid(false),
         m_showEdges(false),
         m_grayscale(false),
         m_tint(false),
@@ -132,31 +477,41 @@ namespace TrenchBroom {
         m_showHiddenBrushes(false) {}
         
         BrushRenderer::~BrushRenderer() {
+            clearBrushes();
             delete m_filter;
             m_filter = NULL;
         }
 
         void BrushRenderer::addBrushes(const Model::BrushList& brushes) {
-            VectorUtils::append(m_brushes, brushes);
-            invalidate();
+            for (Model::Brush* brush : brushes)
+                addBrush(brush);
+        }
+
+        void BrushRenderer::removeBrushes(const Model::BrushList& brushes) {
+            for (const Model::Brush* brush : brushes)
+                removeBrush(brush);
         }
 
         void BrushRenderer::setBrushes(const Model::BrushList& brushes) {
-            m_brushes = brushes;
-            invalidate();
+            clearBrushes();
+            addBrushes(brushes);
         }
 
         void BrushRenderer::invalidate() {
-            m_vertexArray = VertexArray();
+            for (const auto& entry : m_brushData)
+                entry.second->invalidate();
             m_valid = false;
         }
         
+        void BrushRenderer::invalidateBrushes(const Model::BrushList& brushes) {
+            for (const Model::Brush* brush : brushes)
+                invalidateBrush(brush);
+        }
+
         void BrushRenderer::clear() {
-            m_brushes.clear();
-            m_transparentFaceRenderer = FaceRenderer();
-            m_opaqueFaceRenderer = FaceRenderer();
-            m_vertexArray = VertexArray();
+            clearBrushes();
             m_valid = true;
+            m_prepared = true;
         }
 
         void BrushRenderer::setFaceColor(const Color& faceColor) {
@@ -203,9 +558,10 @@ namespace TrenchBroom {
         }
 
         void BrushRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
-            if (!m_brushes.empty()) {
+            if (!m_brushData.empty()) {
                 if (!m_valid)
                     validate();
+                cull(renderContext.camera());
                 if (renderContext.showFaces())
                     renderFaces(renderBatch);
                 if (renderContext.showEdges() || m_showEdges)
@@ -215,264 +571,134 @@ namespace TrenchBroom {
         
 
         void BrushRenderer::renderFaces(RenderBatch& renderBatch) {
-            m_opaqueFaceRenderer.setGrayscale(m_grayscale);
-            m_opaqueFaceRenderer.setTint(m_tint);
-            m_opaqueFaceRenderer.setTintColor(m_tintColor);
-            m_opaqueFaceRenderer.render(renderBatch);
+            FaceRender* opaqueFaceRender = new FaceRender(*this, m_opaqueFaceRanges, m_faceColor);
+            opaqueFaceRender->setGrayscale(m_grayscale);
+            opaqueFaceRender->setTint(m_tint);
+            opaqueFaceRender->setTintColor(m_tintColor);
+            renderBatch.addOneShot(opaqueFaceRender);
             
-            m_transparentFaceRenderer.setGrayscale(m_grayscale);
-            m_transparentFaceRenderer.setTint(m_tint);
-            m_transparentFaceRenderer.setTintColor(m_tintColor);
-            m_transparentFaceRenderer.setAlpha(m_transparencyAlpha);
-            m_transparentFaceRenderer.render(renderBatch);
+            FaceRender* transparentFaceRender = new FaceRender(*this, m_transparentFaceRanges, m_faceColor);
+            transparentFaceRender->setGrayscale(m_grayscale);
+            transparentFaceRender->setTint(m_tint);
+            transparentFaceRender->setTintColor(m_tintColor);
+            transparentFaceRender->setAlpha(m_transparencyAlpha);
+            renderBatch.addOneShot(transparentFaceRender);
         }
         
         void BrushRenderer::renderEdges(RenderBatch& renderBatch) {
             if (m_showOccludedEdges)
-                m_edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
-            m_edgeRenderer.render(renderBatch, m_edgeColor);
+                renderBatch.addOneShot(new EdgeRender(*this, m_edgeRanges, EdgeRenderer::Params(1.0f, 0.2f, true, m_occludedEdgeColor)));
+            renderBatch.addOneShot(new EdgeRender(*this, m_edgeRanges, EdgeRenderer::Params(1.0f, 0.0f, false, m_edgeColor)));
         }
 
-        class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
-        private:
-            const Filter& m_filter;
-            bool m_showHiddenBrushes;
-            NoFilter m_noFilter;
-        public:
-            FilterWrapper(const Filter& filter, const bool showHiddenBrushes) :
-            m_filter(filter),
-            m_showHiddenBrushes(showHiddenBrushes),
-            m_noFilter(false) {}
-            
-            void doProvideFaces(const Model::Brush* brush, FaceAcceptor& faceAcceptor) const {
-                if (m_showHiddenBrushes)
-                    m_noFilter.provideFaces(brush, faceAcceptor);
-                else
-                    m_filter.provideFaces(brush, faceAcceptor);
-            }
-            
-            void doProvideEdges(const Model::Brush* brush, EdgeAcceptor& edgeAcceptor) const {
-                if (m_showHiddenBrushes)
-                    m_noFilter.provideEdges(brush, edgeAcceptor);
-                else
-                    m_filter.provideEdges(brush, edgeAcceptor);
-            }
-
-            bool doIsTransparent(const Model::Brush* brush) const { return m_filter.transparent(brush); }
-        };
-        
-        class BrushRenderer::CountVertices : public Model::ConstNodeVisitor, public BrushRenderer::FaceAcceptor {
-        private:
-            const FilterWrapper& m_filter;
-            size_t m_vertexCount;
-        public:
-            CountVertices(const FilterWrapper& filter) :
-            m_filter(filter),
-            m_vertexCount(0) {}
-            
-            size_t vertexCount() const {
-                return m_vertexCount;
-            }
-        private:
-            void doVisit(const Model::World* world) {}
-            void doVisit(const Model::Layer* layer) {}
-            void doVisit(const Model::Group* group) {}
-            void doVisit(const Model::Entity* entity) {}
-            void doVisit(const Model::Brush* brush) {
-                countFaceVertices(brush);
-            }
-            
-            void countFaceVertices(const Model::Brush* brush) {
-                m_filter.provideFaces(brush, *this);
-            }
+        void BrushRenderer::validate() {
+            assert(!m_valid);
             
-            void accept(const Model::BrushFace* face) {
-                m_vertexCount += face->vertexCount();
+            std::vector<BrushData*> invalidBrushes;
+            for (const auto& entry : m_brushData) {
+                BrushData* brushData = entry.second;
+                if (!brushData->valid())
+                    invalidBrushes.push_back(brushData);
             }
-        };
-
-        class BrushRenderer::CollectVertices : public Model::ConstNodeVisitor, public BrushRenderer::FaceAcceptor {
-        private:
-            const FilterWrapper& m_filter;
-            VertexListBuilder<Model::BrushFace::Vertex::Spec> m_builder;
-        public:
-            CollectVertices(const FilterWrapper& filter, const size_t faceVertexCount) :
-            m_filter(filter),
-            m_builder(faceVertexCount) {}
             
-            VertexArray vertexArray() {
-                return VertexArray::swap(m_builder.vertices());
-            }
-        private:
-            void doVisit(const Model::World* world) {}
-            void doVisit(const Model::Layer* layer) {}
-            void doVisit(const Model::Group* group) {}
-            void doVisit(const Model::Entity* entity) {}
-            void doVisit(const Model::Brush* brush) {
-                collectFaceVertices(brush);
-            }
+            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
+            ParallelUtils::parallelFor(invalidBrushes.size(), [&invalidBrushes, &wrapper](const size_t i) {
+                invalidBrushes[i]->validate(wrapper);
+            });
             
-            void collectFaceVertices(const Model::Brush* brush) {
-                m_filter.provideFaces(brush, *this);
+            for (BrushData* brushData : invalidBrushes) {
+                const BBox3& bounds = brushData->brush()->bounds();
+                if (!m_brushTree.containsObject(bounds, brushData))
+                    m_brushTree.updateObject(bounds, brushData);
             }
             
-            void accept(const Model::BrushFace* face) {
-                face->getVertices(m_builder);
-            }
-        };
+            m_valid = true;
+            m_prepared = false;
+        }
         
-        class BrushRenderer::CountIndices : public Model::ConstNodeVisitor, public BrushRenderer::FaceAcceptor, public BrushRenderer::EdgeAcceptor {
-        private:
-            bool m_brushTransparent;
-            const FilterWrapper& m_filter;
-            TexturedIndexArrayMap::Size m_opaqueIndexSize;
-            TexturedIndexArrayMap::Size m_transparentIndexSize;
-            IndexArrayMap::Size m_edgeIndexSize;
-        public:
-            CountIndices(const FilterWrapper& filter) :
-            m_filter(filter) {}
-            
-            const TexturedIndexArrayMap::Size& opaqueIndexSize() const {
-                return m_opaqueIndexSize;
-            }
+        void BrushRenderer::cull(const Camera& camera) {
+            Plane3f top, right, bottom, left;
+            camera.frustumPlanes(top, right, bottom, left);
             
-            const TexturedIndexArrayMap::Size& transparentIndexSize() const {
-                return m_transparentIndexSize;
-            }
+            Plane3::List frustumPlanes;
+            frustumPlanes.push_back(Plane3(top));
+            frustumPlanes.push_back(Plane3(right));
+            frustumPlanes.push_back(Plane3(bottom));
+            frustumPlanes.push_back(Plane3(left));
             
-            const IndexArrayMap::Size& edgeIndexSize() const {
-                return m_edgeIndexSize;
-            }
-        private:
-            void doVisit(const Model::World* world) {}
-            void doVisit(const Model::Layer* layer) {}
-            void doVisit(const Model::Group* group) {}
-            void doVisit(const Model::Entity* entity) {}
-            void doVisit(const Model::Brush* brush) {
-                countFaceIndices(brush);
-                countEdgeIndices(brush);
-            }
-            
-            void countFaceIndices(const Model::Brush* brush) {
-                // HACK:
-                m_brushTransparent = m_filter.transparent(brush);
-                m_filter.provideFaces(brush, *this);
-            }
-            
-            void accept(const Model::BrushFace* face) {
-                if (m_brushTransparent)
-                    face->countIndices(m_transparentIndexSize);
-                else
-                    face->countIndices(m_opaqueIndexSize);
-            }
-            
-            void countEdgeIndices(const Model::Brush* brush) {
-                m_filter.provideEdges(brush, *this);
-            }
-            
-            void accept(const Model::BrushEdge* edge) {
-                m_edgeIndexSize.inc(GL_LINES, 2);
-            }
-        };
+            m_visibleBrushes = m_brushTree.findObjects(frustumPlanes);
+            m_drawRangesValid = false;
+        }
         
-        class BrushRenderer::CollectIndices : public Model::ConstNodeVisitor, public BrushRenderer::FaceAcceptor, public BrushRenderer::EdgeAcceptor {
-        private:
-            bool m_brushTransparent;
-            const FilterWrapper& m_filter;
-            TexturedIndexArrayBuilder m_opaqueFaceIndexBuilder;
-            TexturedIndexArrayBuilder m_transparentFaceIndexBuilder;
-            IndexArrayMapBuilder m_edgeIndexBuilder;
-        public:
-            CollectIndices(const FilterWrapper& filter, const CountIndices& indexSize) :
-            m_filter(filter),
-            m_opaqueFaceIndexBuilder(indexSize.opaqueIndexSize()),
-            m_transparentFaceIndexBuilder(indexSize.transparentIndexSize()),
-            m_edgeIndexBuilder(indexSize.edgeIndexSize()) {}
-            
-            TexturedIndexArrayBuilder& opaqueFaceIndices() {
-                return m_opaqueFaceIndexBuilder;
-            }
+        void BrushRenderer::prepareVertices(Vbo& vertexVbo) {
+            if (m_prepared)
+                return;
             
-            TexturedIndexArrayBuilder& transparentFaceIndices() {
-                return m_transparentFaceIndexBuilder;
-            }
-            
-            IndexArrayMapBuilder& edgeIndices() {
-                return m_edgeIndexBuilder;
-            }
-        private:
-            void doVisit(const Model::World* world) {}
-            void doVisit(const Model::Layer* layer) {}
-            void doVisit(const Model::Group* group) {}
-            void doVisit(const Model::Entity* entity) {}
-            void doVisit(const Model::Brush* brush) {
-                collectFaceIndices(brush);
-                collectEdgeIndices(brush);
-            }
-            
-            void collectFaceIndices(const Model::Brush* brush) {
-                // HACK: cache this now
-                m_brushTransparent = m_filter.transparent(brush);
-                
-                m_filter.provideFaces(brush, *this);
-            }
-            
-            void accept(const Model::BrushFace* face) {
-                if (m_brushTransparent)
-                    face->getFaceIndices(m_transparentFaceIndexBuilder);
-                else
-                    face->getFaceIndices(m_opaqueFaceIndexBuilder);
+            for (const auto& entry : m_brushData)
+                entry.second->prepareVertices(vertexVbo);
+        }
+        
+        void BrushRenderer::prepareIndices(Vbo& indexVbo) {
+            if (!m_prepared) {
+                for (const auto& entry : m_brushData)
+                    entry.second->prepareIndices(indexVbo);
+                m_prepared = true;
             }
             
-            void collectEdgeIndices(const Model::Brush* brush) {
-                m_filter.provideEdges(brush, *this);
+            if (!m_drawRangesValid) {
+                collectDrawRanges();
+                m_drawRangesValid = true;
             }
+        }
+        
+        void BrushRenderer::collectDrawRanges() {
+            m_opaqueFaceRanges.clear();
+            m_transparentFaceRanges.clear();
+            m_edgeRanges.clear();
             
-            void accept(const Model::BrushEdge* edge) {
-                const Model::BrushVertex* v1 = edge->firstVertex();
-                const Model::BrushVertex* v2 = edge->secondVertex();
-                m_edgeIndexBuilder.addLine(v1->payload(), v2->payload());
+            for (const BrushData* brushData : m_visibleBrushes)
+                brushData->collectDrawRanges(m_opaqueFaceRanges, m_transparentFaceRanges, m_edgeRanges);
+        }
+        
+        void BrushRenderer::addBrush(Model::Brush* brush) {
+            BrushDataMap::iterator it = m_brushData.lower_bound(brush);
+            if (it != std::end(m_brushData) && it->first == brush) {
+                it->second->invalidate();
+            } else {
+                BrushData* brushData = new BrushData(brush);
+                m_brushData.insert(it, std::make_pair(brush, brushData));
+                m_brushTree.addObject(brush->bounds(), brushData);
             }
-        };
-        
-        void BrushRenderer::validate() {
-            assert(!m_valid);
-            validateVertices();
-            validateIndices();
-            m_valid = true;
+            m_valid = false;
         }
         
-        void BrushRenderer::validateVertices() {
-            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
-            CountVertices countVertices(wrapper);
-            Model::Node::accept(std::begin(m_brushes), std::end(m_brushes), countVertices);
-            
-            CollectVertices collectVertices(wrapper, countVertices.vertexCount());
-            Model::Node::accept(std::begin(m_brushes), std::end(m_brushes), collectVertices);
+        void BrushRenderer::removeBrush(const Model::Brush* brush) {
+            BrushDataMap::iterator it = m_brushData.find(brush);
+            if (it == std::end(m_brushData))
+                return;
             
-            m_vertexArray = collectVertices.vertexArray();
+            BrushData* brushData = it->second;
+            m_brushTree.removeObject(brushData);
+            m_brushData.erase(it);
+            delete brushData;
+            m_prepared = false;
+        }
+        
+        void BrushRenderer::invalidateBrush(const Model::Brush* brush) {
+            BrushDataMap::iterator it = m_brushData.find(brush);
+            if (it != std::end(m_brushData)) {
+                it->second->invalidate();
+                m_valid = false;
+            }
         }
         
-        void BrushRenderer::validateIndices() {
-            const FilterWrapper wrapper(*m_filter, m_showHiddenBrushes);
-            CountIndices countIndices(wrapper);
-            Model::Node::accept(std::begin(m_brushes), std::end(m_brushes), countIndices);
-            
-            CollectIndices collectIndices(wrapper, countIndices);
-            Model::Node::accept(std::begin(m_brushes), std::end(m_brushes), collectIndices);
-            
-            const IndexArray opaqueIndices = IndexArray::swap(collectIndices.opaqueFaceIndices().indices());
-            const TexturedIndexArrayMap& opaqueRanges = collectIndices.opaqueFaceIndices().ranges();
-            
-            const IndexArray transparentIndices = IndexArray::swap(collectIndices.transparentFaceIndices().indices());
-            const TexturedIndexArrayMap& transparentRanges = collectIndices.transparentFaceIndices().ranges();
-            
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, opaqueIndices, opaqueRanges, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, transparentIndices, transparentRanges, m_faceColor);
-            
-            const IndexArray edgeIndices = IndexArray::swap(collectIndices.edgeIndices().indices());
-            const IndexArrayMap& edgeRanges = collectIndices.edgeIndices().ranges();
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, edgeIndices, edgeRanges);
+        void BrushRenderer::clearBrushes() {
+            MapUtils::clearAndDelete(m_brushData);
+            m_brushTree.clear();
+            m_visibleBrushes.clear();
+            m_opaqueFaceRanges.clear();
+            m_transparentFaceRanges.clear();
+            m_edgeRanges.clear();
         }
     }
 }
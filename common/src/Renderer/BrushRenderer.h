@@ -21,16 +21,24 @@
 #define TrenchBroom_BrushRenderer
 
 #include "Color.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/AABBTree.h"
 #include "Model/ModelTypes.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/FaceRenderer.h"
 
+#include <limits>
+#include <map>
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
         class EditorContext;
     }
     
     namespace Renderer {
+        class Camera;
         class RenderBatch;
         class RenderContext;
         class Vbo;
@@ -106,18 +114,52 @@ namespace TrenchBroom {
             };
         private:
             class FilterWrapper;
-            class CountVertices;
-            class CollectVertices;
-            class CountIndices;
-            class CollectIndices;
+            class BrushData;
+            class FaceRender;
+            class EdgeRender;
+            
+            typedef std::map<const Model::Brush*, BrushData*> BrushDataMap;
+            typedef std::vector<BrushData*> BrushDataList;
+            typedef Model::AABBTree<FloatType, BrushData*> BrushTree;
+            
+            /**
+             A list of index ranges in the shared index buffer that are drawn with a single call to
+             glMultiDrawElements.
+             */
+            class DrawRanges {
+            private:
+                GLCounts m_counts;
+                std::vector<const GLvoid*> m_offsets;
+                size_t m_end;
+            public:
+                DrawRanges();
+                
+                bool empty() const;
+                void add(size_t offset, size_t count);
+                void clear();
+                
+                void render(PrimType primType) const;
+            };
+            
+            typedef std::map<const Assets::Texture*, DrawRanges> TextureDrawRanges;
         private:
             Filter* m_filter;
-            Model::BrushList m_brushes;
-            VertexArray m_vertexArray;
-            FaceRenderer m_opaqueFaceRenderer;
-            FaceRenderer m_transparentFaceRenderer;
-            IndexedEdgeRenderer m_edgeRenderer;
+            BrushDataMap m_brushData;
             bool m_valid;
+            bool m_prepared;
+            
+            /**
+             The brushes are kept in a bounding volume hierarchy so that only the brushes which may intersect the
+             camera frustum are drawn. The renderer is shared by all views, so the brushes are culled on every render.
+             The draw ranges are then collected once when the first renderable of the render batch is prepared.
+             */
+            BrushTree m_brushTree;
+            BrushDataList m_visibleBrushes;
+            bool m_drawRangesValid;
+            
+            TextureDrawRanges m_opaqueFaceRanges;
+            TextureDrawRanges m_transparentFaceRanges;
+            DrawRanges m_edgeRanges;
             
             Color m_faceColor;
             bool m_showEdges;
@@ -135,6 +177,9 @@ namespace TrenchBroom {
             BrushRenderer(const FilterT& filter) :
             m_filter(new FilterT(filter)),
             m_valid(true),
+            m_prepared(true),
+            m_brushTree(BBox3(std::numeric_limits<FloatType>::max())),
+            m_drawRangesValid(false),
             m_showEdges(false),
             m_grayscale(false),
             m_tint(false),
@@ -146,11 +191,16 @@ namespace TrenchBroom {
             
             ~BrushRenderer();
 
+            /**
+             Adds the given brushes. Brushes that are already being rendered are rebuilt instead.
+             */
             void addBrushes(const Model::BrushList& brushes);
+            void removeBrushes(const Model::BrushList& brushes);
             void setBrushes(const Model::BrushList& brushes);
             void clear();
             
             void invalidate();
+            void invalidateBrushes(const Model::BrushList& brushes);
             
             void setFaceColor(const Color& faceColor);
             void setShowEdges(bool showEdges);
@@ -169,8 +219,15 @@ namespace TrenchBroom {
             void renderEdges(RenderBatch& renderBatch);
             
             void validate();
-            void validateVertices();
-            void validateIndices();
+            void cull(const Camera& camera);
+            void prepareVertices(Vbo& vertexVbo);
+            void prepareIndices(Vbo& indexVbo);
+            void collectDrawRanges();
+            
+            void addBrush(Model::Brush* brush);
+            void removeBrush(const Model::Brush* brush);
+            void invalidateBrush(const Model::Brush* brush);
+            void clearBrushes();
         private:
             BrushRenderer(const BrushRenderer& other);
             BrushRenderer& operator=(const BrushRenderer& other);
@@ -34,6 +34,8 @@
 #include "Renderer/TexturedIndexRangeRenderer.h"
 #include "Renderer/Transformation.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Renderer {
         EntityModelRenderer::EntityModelRenderer(Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext) :
@@ -71,8 +73,13 @@ namespace TrenchBroom {
             }
         }
 
+        void EntityModelRenderer::removeEntity(Model::Entity* entity) {
+            m_entities.erase(entity);
+        }
+
         void EntityModelRenderer::clear() {
             m_entities.clear();
+            m_renderList.clear();
         }
 
         bool EntityModelRenderer::applyTinting() const {
@@ -99,8 +106,21 @@ namespace TrenchBroom {
             m_showHiddenEntities = showHiddenEntities;
         }
 
-        void EntityModelRenderer::render(RenderBatch& renderBatch) {
-            renderBatch.add(this);
+        void EntityModelRenderer::render(RenderBatch& renderBatch, const Model::EntityList& entities) {
+            m_renderList.clear();
+            for (Model::Entity* entity : entities) {
+                if (!m_showHiddenEntities && !m_editorContext.visible(entity))
+                    continue;
+                
+                const EntityMap::const_iterator it = m_entities.find(entity);
+                if (it != std::end(m_entities))
+                    m_renderList.push_back(RenderEntry(it->second, entity));
+            }
+            
+            if (!m_renderList.empty()) {
+                std::sort(std::begin(m_renderList), std::end(m_renderList));
+                renderBatch.add(this);
+            }
         }
 
         void EntityModelRenderer::doPrepareVertices(Vbo& vertexVbo) {
@@ -120,12 +140,9 @@ namespace TrenchBroom {
             glAssert(glEnable(GL_TEXTURE_2D));
             glAssert(glActiveTexture(GL_TEXTURE0));
             
-            for (const auto& entry : m_entities) {
-                Model::Entity* entity = entry.first;
-                if (!m_showHiddenEntities && !m_editorContext.visible(entity))
-                    continue;
-                
-                TexturedIndexRangeRenderer* renderer = entry.second;
+            for (const RenderEntry& entry : m_renderList) {
+                TexturedIndexRangeRenderer* renderer = entry.first;
+                Model::Entity* entity = entry.second;
                 
                 const Mat4x4f translation(translationMatrix(entity->origin()));
                 const Mat4x4f rotation(entity->rotation());
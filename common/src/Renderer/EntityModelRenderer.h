@@ -27,6 +27,8 @@
 
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Assets {
@@ -47,11 +49,14 @@ namespace TrenchBroom {
         class EntityModelRenderer : public DirectRenderable {
         private:
             typedef std::map<Model::Entity*, TexturedIndexRangeRenderer*> EntityMap;
+            typedef std::pair<TexturedIndexRangeRenderer*, Model::Entity*> RenderEntry;
+            typedef std::vector<RenderEntry> RenderList;
             
             Assets::EntityModelManager& m_entityModelManager;
             const Model::EditorContext& m_editorContext;
             
             EntityMap m_entities;
+            RenderList m_renderList;
             
             bool m_applyTinting;
             Color m_tintColor;
@@ -83,8 +88,17 @@ namespace TrenchBroom {
                 }
             }
 
+            template <typename I>
+            void removeEntities(I cur, I end) {
+                while (cur != end) {
+                    removeEntity(*cur);
+                    ++cur;
+                }
+            }
+
             void addEntity(Model::Entity* entity);
             void updateEntity(Model::Entity* entity);
+            void removeEntity(Model::Entity* entity);
             void clear();
             
             bool applyTinting() const;
@@ -95,7 +109,11 @@ namespace TrenchBroom {
             bool showHiddenEntities() const;
             void setShowHiddenEntities(bool showHiddenEntities);
             
-            void render(RenderBatch& renderBatch);
+            /**
+             Renders the models of those of the given entities which have been added to this renderer. The
+             entities are grouped by model so that instances of the same model are drawn one after another.
+             */
+            void render(RenderBatch& renderBatch, const Model::EntityList& entities);
         private:
             void doPrepareVertices(Vbo& vertexVbo);
             void doRender(RenderContext& renderContext);
@@ -41,6 +41,10 @@
 #include "Renderer/TextAnchor.h"
 #include "Renderer/VertexSpec.h"
 
+#include <algorithm>
+#include <cmath>
+#include <set>
+
 namespace TrenchBroom {
     namespace Renderer {
         class EntityRenderer::EntityClassnameAnchor : public TextAnchor3D {
@@ -62,9 +66,13 @@ namespace TrenchBroom {
             }
         };
         
+        const float EntityRenderer::MinModelSize = 8.0f;
+        const Vec2f EntityRenderer::ClassnameCellSize = Vec2f(96.0f, 16.0f);
+        
         EntityRenderer::EntityRenderer(Assets::EntityModelManager& entityModelManager, const Model::EditorContext& editorContext) :
         m_entityModelManager(entityModelManager),
         m_editorContext(editorContext),
+        m_entityTree(BBox3(std::numeric_limits<FloatType>::max())),
         m_modelRenderer(m_entityModelManager, m_editorContext),
         m_boundsValid(false),
         m_showOverlays(true),
@@ -76,7 +84,10 @@ namespace TrenchBroom {
         m_showHiddenEntities(false) {}
         
         void EntityRenderer::setEntities(const Model::EntityList& entities) {
-            m_entities = entities;
+            m_entities = Model::EntitySet(std::begin(entities), std::end(entities));
+            m_entityTree.clear();
+            for (Model::Entity* entity : m_entities)
+                m_entityTree.addObject(entity->bounds(), entity);
             m_modelRenderer.setEntities(std::begin(m_entities), std::end(m_entities));
             invalidate();
         }
@@ -88,8 +99,12 @@ namespace TrenchBroom {
 
         void EntityRenderer::clear() {
             m_entities.clear();
+            m_entityTree.clear();
+            m_visibleEntities.clear();
             m_wireframeBoundsRenderer = DirectEdgeRenderer();
             m_solidBoundsRenderer = TriangleRenderer();
+            m_modelBoundsVertices = VertexArray();
+            m_modelBoundsIndices.clear();
             m_modelRenderer.clear();
         }
 
@@ -97,6 +112,25 @@ namespace TrenchBroom {
             m_modelRenderer.updateEntities(std::begin(m_entities), std::end(m_entities));
         }
 
+        void EntityRenderer::addEntity(Model::Entity* entity) {
+            if (m_entities.insert(entity).second)
+                m_entityTree.addObject(entity->bounds(), entity);
+            updateEntity(entity);
+        }
+        
+        void EntityRenderer::updateEntity(Model::Entity* entity) {
+            m_modelRenderer.updateEntity(entity);
+            invalidateBounds();
+        }
+        
+        void EntityRenderer::removeEntity(Model::Entity* entity) {
+            if (m_entities.erase(entity) > 0) {
+                m_entityTree.removeObject(entity);
+                m_modelRenderer.removeEntity(entity);
+                invalidateBounds();
+            }
+        }
+
         void EntityRenderer::setShowOverlays(const bool showOverlays) {
             m_showOverlays = showOverlays;
         }
@@ -151,6 +185,10 @@ namespace TrenchBroom {
 
         void EntityRenderer::render(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_entities.empty()) {
+                if (!m_boundsValid)
+                    validateBounds();
+                cull(renderContext.camera());
+                
                 renderBounds(renderContext, renderBatch);
                 renderModels(renderContext, renderBatch);
                 renderClassnames(renderContext, renderBatch);
@@ -158,6 +196,20 @@ namespace TrenchBroom {
             }
         }
         
+        void EntityRenderer::cull(const Camera& camera) {
+            Plane3f top, right, bottom, left;
+            camera.frustumPlanes(top, right, bottom, left);
+            
+            Plane3::List frustumPlanes;
+            frustumPlanes.push_back(Plane3(top));
+            frustumPlanes.push_back(Plane3(right));
+            frustumPlanes.push_back(Plane3(bottom));
+            frustumPlanes.push_back(Plane3(left));
+            
+            // the renderer is shared by all views, so the result is not cached between frames
+            m_visibleEntities = m_entityTree.findObjects(frustumPlanes);
+        }
+        
         void EntityRenderer::renderBounds(RenderContext& renderContext, RenderBatch& renderBatch) {
             if (!m_boundsValid)
                 validateBounds();
@@ -186,8 +238,41 @@ namespace TrenchBroom {
                 m_modelRenderer.setApplyTinting(m_tint);
                 m_modelRenderer.setTintColor(m_tintColor);
                 m_modelRenderer.setShowHiddenEntities(m_showHiddenEntities);
-                m_modelRenderer.render(renderBatch);
+                
+                // models that are too small on screen to show any detail are replaced by their bounds
+                const Camera& camera = renderContext.camera();
+                Model::EntityList modelEntities, boundsEntities;
+                for (Model::Entity* entity : m_visibleEntities) {
+                    if (!m_modelBoundsIndices.count(entity))
+                        continue;
+                    
+                    const BBox3& bounds = entity->bounds();
+                    const Vec3 size = bounds.size();
+                    const float scaling = camera.perspectiveScalingFactor(Vec3f(bounds.center()));
+                    if (scaling > 0.0f && size[size.firstComponent()] / scaling < MinModelSize)
+                        boundsEntities.push_back(entity);
+                    else
+                        modelEntities.push_back(entity);
+                }
+                
+                m_modelRenderer.render(renderBatch, modelEntities);
+                if (!boundsEntities.empty())
+                    renderModelBounds(boundsEntities, renderBatch);
+            }
+        }
+        
+        void EntityRenderer::renderModelBounds(const Model::EntityList& entities, RenderBatch& renderBatch) {
+            // the boxed models differ between the views that share this renderer, so the ranges are built per render
+            IndexRangeMap indexRanges;
+            for (const Model::Entity* entity : entities) {
+                if (m_showHiddenEntities || m_editorContext.visible(entity))
+                    indexRanges.add(GL_QUADS, MapUtils::find(m_modelBoundsIndices, entity, size_t(0)), 24);
             }
+            
+            TriangleRenderer* modelBoundsRenderer = new TriangleRenderer(m_modelBoundsVertices, indexRanges);
+            modelBoundsRenderer->setApplyTinting(m_tint);
+            modelBoundsRenderer->setTintColor(m_tintColor);
+            renderBatch.addOneShot(modelBoundsRenderer);
         }
         
         void EntityRenderer::renderClassnames(RenderContext& renderContext, RenderBatch& renderBatch) {
@@ -195,15 +280,33 @@ namespace TrenchBroom {
                 Renderer::RenderService renderService(renderContext, renderBatch);
                 renderService.setForegroundColor(m_overlayTextColor);
                 renderService.setBackgroundColor(m_overlayBackgroundColor);
+                if (m_showOccludedOverlays)
+                    renderService.setShowOccludedObjects();
+                else
+                    renderService.setHideOccludedObjects();
                 
-                for (const Model::Entity* entity : m_entities) {
-                    if (m_showHiddenEntities || m_editorContext.visible(entity)) {
-                        if (m_showOccludedOverlays)
-                            renderService.setShowOccludedObjects();
-                        else
-                            renderService.setHideOccludedObjects();
-                        renderService.renderString(entityString(entity), EntityClassnameAnchor(entity));
-                    }
+                // nearest entities first so that they take precedence when their classnames would overlap others
+                const Camera& camera = renderContext.camera();
+                typedef std::pair<float, const Model::Entity*> DistanceAndEntity;
+                std::vector<DistanceAndEntity> entities;
+                entities.reserve(m_visibleEntities.size());
+                
+                for (const Model::Entity* entity : m_visibleEntities) {
+                    if (m_showHiddenEntities || m_editorContext.visible(entity))
+                        entities.push_back(std::make_pair(camera.squaredDistanceTo(Vec3f(entity->bounds().center())), entity));
+                }
+                std::sort(std::begin(entities), std::end(entities));
+                
+                std::set<std::pair<int, int> > occupiedCells;
+                for (const DistanceAndEntity& entry : entities) {
+                    const Model::Entity* entity = entry.second;
+                    const EntityClassnameAnchor anchor(entity);
+                    
+                    const Vec3f position = camera.project(anchor.position(camera));
+                    const int x = static_cast<int>(std::floor(position.x() / ClassnameCellSize.x()));
+                    const int y = static_cast<int>(std::floor(position.y() / ClassnameCellSize.y()));
+                    if (occupiedCells.insert(std::make_pair(x, y)).second)
+                        renderService.renderString(entityString(entity), anchor);
                 }
             }
         }
@@ -220,7 +323,7 @@ namespace TrenchBroom {
             renderService.setForegroundColor(m_angleColor);
             
             Vec3f::List vertices(3);
-            for (const Model::Entity* entity : m_entities) {
+            for (const Model::Entity* entity : m_visibleEntities) {
                 if (!m_showHiddenEntities && !m_editorContext.visible(entity))
                     continue;
                 
@@ -307,6 +410,21 @@ namespace TrenchBroom {
             VertexSpecs::P3NC4::Vertex::List solidVertices;
             solidVertices.reserve(36 * m_entities.size());
             
+            VertexSpecs::P3NC4::Vertex::List modelBoundsVertices;
+            m_modelBoundsIndices.clear();
+            
+            for (Model::Entity* entity : m_entities) {
+                if (!m_entityTree.containsObject(entity->bounds(), entity))
+                    m_entityTree.updateObject(entity->bounds(), entity);
+                
+                if (m_entityModelManager.hasModel(entity)) {
+                    m_modelBoundsIndices[entity] = modelBoundsVertices.size();
+                    BuildColoredSolidBoundsVertices modelBoundsBuilder(modelBoundsVertices, boundsColor(entity));
+                    eachBBoxFace(entity->bounds(), modelBoundsBuilder);
+                }
+            }
+            m_modelBoundsVertices = VertexArray::swap(modelBoundsVertices);
+            
             if (m_overrideBoundsColor) {
                 VertexSpecs::P3::Vertex::List wireframeVertices;
                 wireframeVertices.reserve(24 * m_entities.size());
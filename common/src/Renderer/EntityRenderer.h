@@ -22,6 +22,9 @@
 
 #include "AttrString.h"
 #include "Color.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/AABBTree.h"
 #include "Model/ModelTypes.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/EntityModelRenderer.h"
@@ -30,6 +33,7 @@
 #include "Renderer/TriangleRenderer.h"
 #include "Renderer/Vbo.h"
 
+#include <limits>
 #include <map>
 
 namespace TrenchBroom {
@@ -42,19 +46,36 @@ namespace TrenchBroom {
     }
     
     namespace Renderer {
+        class Camera;
         class RenderBatch;
         class RenderContext;
         
         class EntityRenderer {
         private:
             class EntityClassnameAnchor;
+            typedef Model::AABBTree<FloatType, Model::Entity*> EntityTree;
+            typedef std::map<const Model::Entity*, size_t> IndexMap;
+            
+            /**
+             Models that appear smaller than this many pixels on screen are rendered as solid boxes.
+             */
+            static const float MinModelSize;
+            
+            /**
+             At most one classname is rendered per cell of a screen space grid with cells of this size.
+             */
+            static const Vec2f ClassnameCellSize;
 
             Assets::EntityModelManager& m_entityModelManager;
             const Model::EditorContext& m_editorContext;
-            Model::EntityList m_entities;
+            Model::EntitySet m_entities;
+            EntityTree m_entityTree;
+            Model::EntityList m_visibleEntities;
             
             DirectEdgeRenderer m_wireframeBoundsRenderer;
             TriangleRenderer m_solidBoundsRenderer;
+            VertexArray m_modelBoundsVertices;
+            IndexMap m_modelBoundsIndices;
             EntityModelRenderer m_modelRenderer;
             bool m_boundsValid;
             
@@ -79,6 +100,35 @@ namespace TrenchBroom {
             void clear();
             void reloadModels();
             
+            template <typename I>
+            void addEntities(I cur, I end) {
+                while (cur != end) {
+                    addEntity(*cur);
+                    ++cur;
+                }
+            }
+            
+            template <typename I>
+            void updateEntities(I cur, I end) {
+                while (cur != end) {
+                    updateEntity(*cur);
+                    ++cur;
+                }
+            }
+            
+            template <typename I>
+            void removeEntities(I cur, I end) {
+                while (cur != end) {
+                    removeEntity(*cur);
+                    ++cur;
+                }
+            }
+        private:
+            void addEntity(Model::Entity* entity);
+            void updateEntity(Model::Entity* entity);
+            void removeEntity(Model::Entity* entity);
+        public:
+            
             void setShowOverlays(bool showOverlays);
             void setOverlayTextColor(const Color& overlayTextColor);
             void setOverlayBackgroundColor(const Color& overlayBackgroundColor);
@@ -100,10 +150,12 @@ namespace TrenchBroom {
         public: // rendering
             void render(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
+            void cull(const Camera& camera);
             void renderBounds(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderWireframeBounds(RenderBatch& renderBatch);
             void renderSolidBounds(RenderBatch& renderBatch);
             void renderModels(RenderContext& renderContext, RenderBatch& renderBatch);
+            void renderModelBounds(const Model::EntityList& entities, RenderBatch& renderBatch);
             void renderClassnames(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderAngles(RenderContext& renderContext, RenderBatch& renderBatch);
             Vec3f::List arrowHead(float length, float width) const;
@@ -32,7 +32,7 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        struct FaceRenderer::RenderFunc : public TextureRenderFunc {
+        struct FaceRenderer::RenderBase::RenderFunc : public TextureRenderFunc {
             ActiveShader& shader;
             bool applyTexture;
             const Color& defaultColor;
@@ -59,6 +59,83 @@ namespace TrenchBroom {
             }
         };
         
+        FaceRenderer::RenderBase::RenderBase(const Color& faceColor) :
+        m_faceColor(faceColor),
+        m_grayscale(false),
+        m_tint(false),
+        m_alpha(1.0f) {}
+        
+        FaceRenderer::RenderBase::~RenderBase() {}
+        
+        void FaceRenderer::RenderBase::setGrayscale(const bool grayscale) {
+            m_grayscale = grayscale;
+        }
+        
+        void FaceRenderer::RenderBase::setTint(const bool tint) {
+            m_tint = tint;
+        }
+        
+        void FaceRenderer::RenderBase::setTintColor(const Color& color) {
+            m_tintColor = color;
+        }
+        
+        void FaceRenderer::RenderBase::setAlpha(const float alpha) {
+            m_alpha = alpha;
+        }
+        
+        void FaceRenderer::RenderBase::renderFaces(RenderContext& context) {
+            ShaderManager& shaderManager = context.shaderManager();
+            ActiveShader shader(shaderManager, Shaders::FaceShader);
+            PreferenceManager& prefs = PreferenceManager::instance();
+            
+            const bool applyTexture = context.showTextures();
+            const bool shadeFaces = context.shadeFaces();
+            const bool showFog = context.showFog();
+            
+            glAssert(glEnable(GL_TEXTURE_2D));
+            glAssert(glActiveTexture(GL_TEXTURE0));
+            shader.set("Brightness", prefs.get(Preferences::Brightness));
+            shader.set("RenderGrid", context.showGrid());
+            shader.set("GridSize", static_cast<float>(context.gridSize()));
+            shader.set("GridAlpha", prefs.get(Preferences::GridAlpha));
+            shader.set("ApplyTexture", applyTexture);
+            shader.set("Texture", 0);
+            shader.set("ApplyTinting", m_tint);
+            if (m_tint)
+                shader.set("TintColor", m_tintColor);
+            shader.set("GrayScale", m_grayscale);
+            shader.set("CameraPosition", context.camera().position());
+            shader.set("ShadeFaces", shadeFaces);
+            shader.set("ShowFog", showFog);
+            shader.set("Alpha", m_alpha);
+            
+            RenderFunc func(shader, applyTexture, m_faceColor);
+            if (m_alpha < 1.0f) {
+                glAssert(glDepthMask(GL_FALSE));
+                doRenderFaces(func);
+                glAssert(glDepthMask(GL_TRUE));
+            } else {
+                doRenderFaces(func);
+            }
+        }
+        
+        class FaceRenderer::Render : public FaceRenderer::RenderBase {
+        private:
+            TexturedIndexArrayRenderer& m_meshRenderer;
+        public:
+            Render(const Color& faceColor, TexturedIndexArrayRenderer& meshRenderer) :
+            RenderBase(faceColor),
+            m_meshRenderer(meshRenderer) {}
+            
+            void render(RenderContext& context) {
+                renderFaces(context);
+            }
+        private:
+            void doRenderFaces(TextureRenderFunc& func) {
+                m_meshRenderer.render(func);
+            }
+        };
+        
         FaceRenderer::FaceRenderer() :
         m_grayscale(false),
         m_tint(false),
@@ -131,39 +208,12 @@ namespace TrenchBroom {
                 return;
             
             if (m_vertexArray.setup()) {
-                ShaderManager& shaderManager = context.shaderManager();
-                ActiveShader shader(shaderManager, Shaders::FaceShader);
-                PreferenceManager& prefs = PreferenceManager::instance();
-                
-                const bool applyTexture = context.showTextures();
-                const bool shadeFaces = context.shadeFaces();
-                const bool showFog = context.showFog();
-                
-                glAssert(glEnable(GL_TEXTURE_2D));
-                glAssert(glActiveTexture(GL_TEXTURE0));
-                shader.set("Brightness", prefs.get(Preferences::Brightness));
-                shader.set("RenderGrid", context.showGrid());
-                shader.set("GridSize", static_cast<float>(context.gridSize()));
-                shader.set("GridAlpha", prefs.get(Preferences::GridAlpha));
-                shader.set("ApplyTexture", applyTexture);
-                shader.set("Texture", 0);
-                shader.set("ApplyTinting", m_tint);
-                if (m_tint)
-                    shader.set("TintColor", m_tintColor);
-                shader.set("GrayScale", m_grayscale);
-                shader.set("CameraPosition", context.camera().position());
-                shader.set("ShadeFaces", shadeFaces);
-                shader.set("ShowFog", showFog);
-                shader.set("Alpha", m_alpha);
-                
-                RenderFunc func(shader, applyTexture, m_faceColor);
-                if (m_alpha < 1.0f) {
-                    glAssert(glDepthMask(GL_FALSE));
-                    m_meshRenderer.render(func);
-                    glAssert(glDepthMask(GL_TRUE));
-                } else {
-                    m_meshRenderer.render(func);
-                }
+                Render render(m_faceColor, m_meshRenderer);
+                render.setGrayscale(m_grayscale);
+                render.setTint(m_tint);
+                render.setTintColor(m_tintColor);
+                render.setAlpha(m_alpha);
+                render.render(context);
                 m_vertexArray.cleanup();
             }
         }
@@ -38,8 +38,35 @@ namespace TrenchBroom {
         class Vbo;
         
         class FaceRenderer : public IndexedRenderable {
+        public:
+            /**
+             Sets up the face shader and its render state. Subclasses issue the actual draw calls, which allows
+             renderers that store their faces in a different layout to share the shader setup.
+             */
+            class RenderBase {
+            private:
+                struct RenderFunc;
+                
+                Color m_faceColor;
+                bool m_grayscale;
+                bool m_tint;
+                Color m_tintColor;
+                float m_alpha;
+            public:
+                RenderBase(const Color& faceColor);
+                virtual ~RenderBase();
+                
+                void setGrayscale(bool grayscale);
+                void setTint(bool tint);
+                void setTintColor(const Color& color);
+                void setAlpha(float alpha);
+            protected:
+                void renderFaces(RenderContext& context);
+            private:
+                virtual void doRenderFaces(TextureRenderFunc& func) = 0;
+            };
         private:
-            struct RenderFunc;
+            class Render;
             
             VertexArray m_vertexArray;
             TexturedIndexArrayRenderer m_meshRenderer;
@@ -58,7 +58,7 @@ namespace TrenchBroom {
         m_showOccludedBounds(false) {}
         
         void GroupRenderer::setGroups(const Model::GroupList& groups) {
-            m_groups = groups;
+            m_groups = Model::GroupSet(std::begin(groups), std::end(groups));
             invalidate();
         }
 
@@ -70,6 +70,20 @@ namespace TrenchBroom {
             m_groups.clear();
             m_boundsRenderer = DirectEdgeRenderer();
         }
+
+        void GroupRenderer::addGroup(Model::Group* group) {
+            m_groups.insert(group);
+            invalidate();
+        }
+        
+        void GroupRenderer::updateGroup(Model::Group* group) {
+            invalidate();
+        }
+        
+        void GroupRenderer::removeGroup(Model::Group* group) {
+            if (m_groups.erase(group) > 0)
+                invalidate();
+        }
         
         void GroupRenderer::setShowOverlays(const bool showOverlays) {
             m_showOverlays = showOverlays;
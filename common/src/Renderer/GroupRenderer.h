@@ -39,7 +39,7 @@ namespace TrenchBroom {
             class GroupNameAnchor;
             
             const Model::EditorContext& m_editorContext;
-            Model::GroupList m_groups;
+            Model::GroupSet m_groups;
             
             DirectEdgeRenderer m_boundsRenderer;
             bool m_boundsValid;
@@ -81,6 +81,11 @@ namespace TrenchBroom {
                     ++cur;
                 }
             }
+        private:
+            void addGroup(Model::Group* group);
+            void updateGroup(Model::Group* group);
+            void removeGroup(Model::Group* group);
+        public:
             
             void setShowOverlays(bool showOverlays);
             void setOverlayTextColor(const Color& overlayTextColor);
@@ -25,12 +25,16 @@
 #include "Preferences.h"
 #include "Assets/EntityDefinitionManager.h"
 #include "Model/Brush.h"
+#include "Model/BrushFace.h"
 #include "Model/CollectMatchingNodesVisitor.h"
+#include "Model/CollectNodesVisitor.h"
+#include "Model/CollectUniqueNodesVisitor.h"
 #include "Model/EditorContext.h"
 #include "Model/Entity.h"
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/Node.h"
+#include "Model/NodeCollection.h"
 #include "Model/NodeVisitor.h"
 #include "Model/Tutorial.h"
 #include "Model/World.h"
@@ -452,6 +456,45 @@ namespace TrenchBroom {
             invalidateEntityLinkRenderer();
         }
         
+        void MapRenderer::updateNodes(const Model::NodeList& nodes) {
+            CollectRenderableNodes collect(Renderer_All);
+            Model::Node::accept(std::begin(nodes), std::end(nodes), collect);
+            
+            updateRenderer(m_defaultRenderer, nodes, collect.defaultNodes());
+            updateRenderer(m_selectionRenderer, nodes, collect.selectedNodes());
+            updateRenderer(m_lockedRenderer, nodes, collect.lockedNodes());
+            invalidateEntityLinkRenderer();
+        }
+        
+        void MapRenderer::updateRenderer(ObjectRenderer* renderer, const Model::NodeList& nodes, const Model::NodeCollection& renderableNodes) {
+            const Model::NodeSet renderable(std::begin(renderableNodes), std::end(renderableNodes));
+            
+            Model::NodeCollection unrenderableNodes;
+            for (Model::Node* node : nodes) {
+                if (renderable.count(node) == 0)
+                    unrenderableNodes.addNode(node);
+            }
+            
+            renderer->removeObjects(unrenderableNodes.groups(),
+                                    unrenderableNodes.entities(),
+                                    unrenderableNodes.brushes());
+            renderer->addObjects(renderableNodes.groups(),
+                                 renderableNodes.entities(),
+                                 renderableNodes.brushes());
+        }
+        
+        void MapRenderer::removeNodes(const Model::NodeList& nodes) {
+            Model::NodeCollection removedNodes;
+            Model::CollectNodesVisitor collect;
+            Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), collect);
+            removedNodes.addNodes(collect.nodes());
+            
+            m_defaultRenderer->removeObjects(removedNodes.groups(), removedNodes.entities(), removedNodes.brushes());
+            m_selectionRenderer->removeObjects(removedNodes.groups(), removedNodes.entities(), removedNodes.brushes());
+            m_lockedRenderer->removeObjects(removedNodes.groups(), removedNodes.entities(), removedNodes.brushes());
+            invalidateEntityLinkRenderer();
+        }
+        
         void MapRenderer::invalidateRenderers(Renderer renderers) {
             if ((renderers & Renderer_Default) != 0)
                 m_defaultRenderer->invalidate();
@@ -532,16 +575,20 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::nodesWereAdded(const Model::NodeList& nodes) {
-            updateRenderers(Renderer_Default);
+            // the bounds of the ancestors of the added nodes have changed, too
+            Model::CollectUniqueNodesVisitor collect;
+            Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), collect);
+            Model::Node::escalate(std::begin(nodes), std::end(nodes), collect);
+            updateNodes(collect.nodes());
         }
         
         void MapRenderer::nodesWereRemoved(const Model::NodeList& nodes) {
-            updateRenderers(Renderer_Default);
+            removeNodes(nodes);
         }
         
         void MapRenderer::nodesDidChange(const Model::NodeList& nodes) {
             invalidateRenderers(Renderer_Selection);
-            invalidateEntityLinkRenderer();
+            updateNodes(nodes);
         }
         
         void MapRenderer::nodeVisibilityDidChange(const Model::NodeList& nodes) {
@@ -565,7 +612,25 @@ namespace TrenchBroom {
         }
         
         void MapRenderer::selectionDidChange(const View::Selection& selection) {
-            updateRenderers(Renderer_All); // need to update locked objects also because a selected object may have been reparented into a locked layer before deselection
+            // the deselected nodes are moved to the locked renderer if they were reparented into a locked layer while they were selected
+            updateNodes(collectChangedNodes(selection));
+        }
+        
+        Model::NodeList MapRenderer::collectChangedNodes(const View::Selection& selection) const {
+            Model::CollectUniqueNodesVisitor collect;
+            Model::Node::accept(std::begin(selection.selectedNodes()), std::end(selection.selectedNodes()), collect);
+            Model::Node::accept(std::begin(selection.deselectedNodes()), std::end(selection.deselectedNodes()), collect);
+            Model::Node::accept(std::begin(selection.partiallySelectedNodes()), std::end(selection.partiallySelectedNodes()), collect);
+            Model::Node::accept(std::begin(selection.partiallyDeselectedNodes()), std::end(selection.partiallyDeselectedNodes()), collect);
+            Model::Node::accept(std::begin(selection.recursivelySelectedNodes()), std::end(selection.recursivelySelectedNodes()), collect);
+            Model::Node::accept(std::begin(selection.recursivelyDeselectedNodes()), std::end(selection.recursivelyDeselectedNodes()), collect);
+            
+            for (Model::BrushFace* face : selection.selectedBrushFaces())
+                face->brush()->accept(collect);
+            for (Model::BrushFace* face : selection.deselectedBrushFaces())
+                face->brush()->accept(collect);
+            
+            return collect.nodes();
         }
         
         Model::BrushSet MapRenderer::collectBrushes(const Model::BrushFaceList& faces) {
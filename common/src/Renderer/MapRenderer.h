@@ -31,6 +31,10 @@ namespace TrenchBroom {
         class Path;
     }
     
+    namespace Model {
+        class NodeCollection;
+    }
+    
     namespace View {
         class Selection;
     }
@@ -100,6 +104,14 @@ namespace TrenchBroom {
             class CollectRenderableNodes;
             
             void updateRenderers(Renderer renderers);
+            
+            /**
+             Moves each of the given nodes into the renderers it belongs to and removes it from the others. The nodes
+             that remain in a renderer are rebuilt, but no other nodes are touched.
+             */
+            void updateNodes(const Model::NodeList& nodes);
+            void updateRenderer(ObjectRenderer* renderer, const Model::NodeList& nodes, const Model::NodeCollection& renderableNodes);
+            void removeNodes(const Model::NodeList& nodes);
             void invalidateRenderers(Renderer renderers);
             void invalidateEntityLinkRenderer();
             void reloadEntityModels();
@@ -123,6 +135,7 @@ namespace TrenchBroom {
             void brushFacesDidChange(const Model::BrushFaceList& faces);
             
             void selectionDidChange(const View::Selection& selection);
+            Model::NodeList collectChangedNodes(const View::Selection& selection) const;
             Model::BrushSet collectBrushes(const Model::BrushFaceList& faces);
             
             void textureCollectionsDidChange();
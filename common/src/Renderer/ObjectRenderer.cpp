@@ -31,6 +31,18 @@ namespace TrenchBroom {
             m_brushRenderer.setBrushes(brushes);
         }
 
+        void ObjectRenderer::addObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes) {
+            m_groupRenderer.addGroups(std::begin(groups), std::end(groups));
+            m_entityRenderer.addEntities(std::begin(entities), std::end(entities));
+            m_brushRenderer.addBrushes(brushes);
+        }
+        
+        void ObjectRenderer::removeObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes) {
+            m_groupRenderer.removeGroups(std::begin(groups), std::end(groups));
+            m_entityRenderer.removeEntities(std::begin(entities), std::end(entities));
+            m_brushRenderer.removeBrushes(brushes);
+        }
+
         void ObjectRenderer::invalidate() {
             m_groupRenderer.invalidate();
             m_entityRenderer.invalidate();
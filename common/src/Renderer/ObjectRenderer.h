@@ -48,6 +48,12 @@ namespace TrenchBroom {
             m_brushRenderer(brushFilter) {}
         public: // object management
             void setObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes);
+            
+            /**
+             Adds the given objects to this renderer. Objects that are already being rendered are refreshed.
+             */
+            void addObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes);
+            void removeObjects(const Model::GroupList& groups, const Model::EntityList& entities, const Model::BrushList& brushes);
             void invalidate();
             void clear();
             void reloadModels();
@@ -93,10 +93,15 @@ namespace TrenchBroom {
             m_oneshots.push_back(renderable);
         }
         
+        void RenderBatch::prepare() {
+            prepareVertices();
+            prepareIndices();
+        }
+        
         void RenderBatch::render(RenderContext& renderContext) {
             ActivateVbo activate(m_vertexVbo);
 
-            prepareRenderables();
+            prepare();
             renderRenderables(renderContext);
         }
 
@@ -104,11 +109,6 @@ namespace TrenchBroom {
             ensure(renderable != NULL, "renderable is null");
             m_batch.push_back(renderable);
         }
-
-        void RenderBatch::prepareRenderables() {
-            prepareVertices();
-            prepareIndices();
-        }
         
         void RenderBatch::prepareVertices() {
             ActivateVbo activate(m_vertexVbo);
@@ -62,11 +62,14 @@ namespace TrenchBroom {
             void addOneShot(DirectRenderable* renderable);
             void addOneShot(IndexedRenderable* renderable);
             
+            /**
+             Uploads the vertices and indices of the renderables in this batch without rendering them.
+             */
+            void prepare();
             void render(RenderContext& renderContext);
         private:
             void doAdd(Renderable* renderable);
             
-            void prepareRenderables();
             void prepareVertices();
             void prepareIndices();
             
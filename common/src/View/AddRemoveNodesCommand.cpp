@@ -21,6 +21,7 @@
 
 #include "CollectionUtils.h"
 #include "Macros.h"
+#include "Model/ModelUtils.h"
 #include "Model/Node.h"
 #include "View/MapDocumentCommandFacade.h"
 
@@ -113,5 +114,10 @@ namespace TrenchBroom {
         bool AddRemoveNodesCommand::doCollateWith(UndoableCommand::Ptr command) {
             return false;
         }
+        
+        size_t AddRemoveNodesCommand::doGetMemorySize() const {
+            // the nodes to add are not part of the map, so they belong to this command
+            return sizeof(AddRemoveNodesCommand) + Model::memorySize(m_nodesToAdd);
+        }
     }
 }
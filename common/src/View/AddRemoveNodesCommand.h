@@ -54,6 +54,8 @@ namespace TrenchBroom {
             bool doIsRepeatable(MapDocumentCommandFacade* document) const;
             
             bool doCollateWith(UndoableCommand::Ptr command);
+            
+            size_t doGetMemorySize() const;
         };
     }
 }
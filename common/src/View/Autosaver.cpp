@@ -20,17 +20,20 @@
 #include "Autosaver.h"
 
 #include "StringUtils.h"
-#include "SetAny.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/IOUtils.h"
+#include "IO/MapSnapshot.h"
+#include "Model/Game.h"
 #include "View/MapDocument.h"
 
 #include <cassert>
+#include <chrono>
+#include <exception>
 
 namespace TrenchBroom {
     namespace View {
         Autosaver::Autosaver(View::MapDocumentWPtr document, const time_t saveInterval, const time_t idleInterval, const size_t maxBackups) :
         m_document(document),
-        m_logger(NULL),
         m_saveInterval(saveInterval),
         m_idleInterval(idleInterval),
         m_maxBackups(maxBackups),
@@ -42,10 +45,16 @@ namespace TrenchBroom {
         
         Autosaver::~Autosaver() {
             unbindObservers();
+            finishBackup(NULL, true);
             triggerAutosave(NULL);
+            finishBackup(NULL, true);
         }
         
         void Autosaver::triggerAutosave(Logger* logger) {
+            // never wait for the previous backup, we'll try again the next time
+            if (!finishBackup(logger, false))
+                return;
+            
             const time_t currentTime = time(NULL);
             
             MapDocumentSPtr document = lock(m_document);
@@ -64,19 +73,55 @@ namespace TrenchBroom {
             if (!IO::Disk::fileExists(IO::Disk::fixPath(document->path())))
                 return;
             
-            SetAny<Logger*> setLogger(m_logger, logger);
             autosave(document);
         }
         
+        bool Autosaver::finishBackup(Logger* logger, const bool wait) {
+            if (!m_backup.valid())
+                return true;
+            if (!wait && m_backup.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return false;
+            
+            m_backup.get();
+            
+            // pass the messages of the worker thread on to the given logger on the calling thread
+            if (logger != NULL) {
+                m_logger.setParentLogger(logger);
+                m_logger.setParentLogger(NULL);
+            }
+            return true;
+        }
+        
         void Autosaver::autosave(MapDocumentSPtr document) {
-            const IO::Path& mapPath = document->path();
+            assert(!m_backup.valid());
+            
+            const IO::Path mapPath = document->path();
             assert(IO::Disk::fileExists(IO::Disk::fixPath(mapPath)));
             
+            const std::shared_ptr<IO::MapSnapshot> snapshot(new IO::MapSnapshot(document->game()->gameName(), document->world()));
+            m_lastSaveTime = time(NULL);
+            m_lastModificationCount = document->modificationCount();
+            
+            m_backup = std::async(std::launch::async, [this, snapshot, mapPath]() { writeBackup(*snapshot, mapPath); });
+        }
+        
+        void Autosaver::writeBackup(const IO::MapSnapshot& snapshot, const IO::Path& mapPath) const {
             const IO::Path mapFilename = mapPath.lastComponent();
             const IO::Path mapBasename = mapFilename.deleteExtension();
+            const IO::Path temporaryName(makeTemporaryBackupName(mapBasename));
             
             try {
                 IO::WritableDiskFileSystem fs = createBackupFileSystem(mapPath);
+                
+                try {
+                    IO::OpenFile open(fs.makeAbsolute(temporaryName), true);
+                    snapshot.write(open.file);
+                } catch (...) {
+                    if (fs.fileExists(temporaryName))
+                        fs.deleteFile(temporaryName);
+                    throw;
+                }
+                
                 IO::Path::List backups = collectBackups(fs, mapBasename);
                 
                 thinBackups(fs, backups);
@@ -85,18 +130,15 @@ namespace TrenchBroom {
                 assert(backups.size() < m_maxBackups);
                 const size_t backupNo = backups.size() + 1;
                 
-                const IO::Path backupFilePath = fs.makeAbsolute(makeBackupName(mapBasename, backupNo));
-
-                m_lastSaveTime = time(NULL);
-                m_lastModificationCount = document->modificationCount();
-                document->saveDocumentTo(backupFilePath);
-                
-                if (m_logger != NULL)
-                    m_logger->info("Created autosave backup at %s", backupFilePath.asString().c_str());
+                const IO::Path backupName(makeBackupName(mapBasename, backupNo));
+                fs.moveFile(temporaryName, backupName, false);
                 
-            } catch (FileSystemException e) {
-                if (m_logger != NULL)
-                    m_logger->error("Aborting autosave");
+                m_logger.info("Created autosave backup at %s", fs.makeAbsolute(backupName).asString().c_str());
+            } catch (const std::exception& e) {
+                // this runs on the worker thread, so nothing may escape into the future
+                m_logger.error("Aborting autosave: %s", e.what());
+            } catch (...) {
+                m_logger.error("Aborting autosave: Unknown error");
             }
         }
         
@@ -108,8 +150,7 @@ namespace TrenchBroom {
                 // ensures that the directory exists or is created if it doesn't
                 return IO::WritableDiskFileSystem(autosavePath, true);
             } catch (FileSystemException e) {
-                if (m_logger != NULL)
-                    m_logger->error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
+                m_logger.error("Cannot create autosave directory at %s", autosavePath.asString().c_str());
                 throw e;
             }
         }
@@ -153,12 +194,10 @@ namespace TrenchBroom {
                 const IO::Path filename = backups.front();
                 try {
                     fs.deleteFile(filename);
-                    if (m_logger != NULL)
-                        m_logger->debug("Deleted autosave backup %s", filename.asString().c_str());
+                    m_logger.debug("Deleted autosave backup %s", filename.asString().c_str());
                     backups.erase(std::begin(backups));
                 } catch (FileSystemException e) {
-                    if (m_logger != NULL)
-                        m_logger->error("Cannot delete autosave backup %s", filename.asString().c_str());
+                    m_logger.error("Cannot delete autosave backup %s", filename.asString().c_str());
                     throw e;
                 }
             }
@@ -180,6 +219,10 @@ namespace TrenchBroom {
             return str.str();
         }
         
+        String Autosaver::makeTemporaryBackupName(const IO::Path& mapBasename) const {
+            return mapBasename.asString() + ".autosave.tmp";
+        }
+        
         size_t extractBackupNo(const IO::Path& path) {
             const size_t no = StringUtils::stringToSize(path.deleteExtension().extension());
             assert(no > 0);
@@ -21,24 +21,36 @@
 #define TrenchBroom_Autosaver
 
 #include "IO/Path.h"
+#include "View/CachingLogger.h"
 #include "View/ViewTypes.h"
 
 #include <ctime>
+#include <future>
 
 namespace TrenchBroom {
     class Logger;
     
     namespace IO {
+        class MapSnapshot;
         class WritableDiskFileSystem;
     }
     
     namespace View {
         class Command;
         
+        /**
+         Creates backups of the document in regular intervals when the document has been modified and not edited
+         for a while. The document is copied on the calling thread, but the backup is written on a worker thread,
+         so that editing is never blocked by an autosave. Every backup is first written to a temporary file which
+         only replaces a backup once it has been written completely.
+         */
         class Autosaver {
         private:
             View::MapDocumentWPtr m_document;
-            Logger* m_logger;
+            
+            // only used by the worker thread while a backup is being written
+            mutable CachingLogger m_logger;
+            std::future<void> m_backup;
             
             time_t m_saveInterval;
             time_t m_idleInterval;
@@ -53,13 +65,16 @@ namespace TrenchBroom {
             
             void triggerAutosave(Logger* logger);
         private:
+            bool finishBackup(Logger* logger, bool wait);
             void autosave(View::MapDocumentSPtr document);
+            void writeBackup(const IO::MapSnapshot& snapshot, const IO::Path& mapPath) const;
             IO::WritableDiskFileSystem createBackupFileSystem(const IO::Path& mapPath) const;
             IO::Path::List collectBackups(const IO::WritableDiskFileSystem& fs, const IO::Path& mapBasename) const;
             bool isBackup(const IO::Path& backupPath, const IO::Path& mapBasename) const;
             void thinBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups) const;
             void cleanBackups(IO::WritableDiskFileSystem& fs, IO::Path::List& backups, const IO::Path& mapBasename) const;
             String makeBackupName(const IO::Path& mapBasename, const size_t index) const;
+            String makeTemporaryBackupName(const IO::Path& mapBasename) const;
         private:
             void bindObservers();
             void unbindObservers();
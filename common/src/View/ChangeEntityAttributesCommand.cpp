@@ -120,5 +120,12 @@ namespace TrenchBroom {
             m_newValue = other->m_newValue;
             return true;
         }
+        
+        size_t ChangeEntityAttributesCommand::doGetMemorySize() const {
+            size_t size = sizeof(ChangeEntityAttributesCommand) + m_oldName.capacity() + m_newName.capacity() + m_newValue.capacity();
+            for (const auto& entry : m_snapshots)
+                size += sizeof(entry) + entry.second.memorySize();
+            return size;
+        }
     }
 }
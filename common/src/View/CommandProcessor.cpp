@@ -98,6 +98,18 @@ namespace TrenchBroom {
             return false;
         }
         
+        static size_t sumMemorySize(const CommandList& commands) {
+            size_t size = 0;
+            for (UndoableCommand::Ptr command : commands)
+                size += command->memorySize();
+            return size;
+        }
+        
+        size_t CommandGroup::doGetMemorySize() const {
+            return sumMemorySize(m_commands);
+        }
+        
+        const size_t CommandProcessor::DefaultMemoryBudget = 256 * 1024 * 1024;
         const wxLongLong CommandProcessor::CollationInterval(1000);
         
         struct CommandProcessor::SubmitAndStoreResult {
@@ -111,6 +123,9 @@ namespace TrenchBroom {
         
         CommandProcessor::CommandProcessor(MapDocumentCommandFacade* document) :
         m_document(document),
+        m_memoryBudget(DefaultMemoryBudget),
+        m_lastCommandMemorySize(0),
+        m_nextCommandMemorySize(0),
         m_clearRepeatableCommandStack(false),
         m_lastCommandTimestamp(0),
         m_groupLevel(0) {
@@ -161,8 +176,8 @@ namespace TrenchBroom {
             if (!success)
                 return false;
             
-            m_lastCommandStack.clear();
-            m_nextCommandStack.clear();
+            clearLastCommands();
+            clearNextCommands();
             return true;
         }
         
@@ -229,11 +244,20 @@ namespace TrenchBroom {
             assert(m_groupLevel == 0);
             
             clearRepeatableCommands();
-            m_lastCommandStack.clear();
-            m_nextCommandStack.clear();
+            clearLastCommands();
+            clearNextCommands();
             m_lastCommandTimestamp = 0;
         }
         
+        size_t CommandProcessor::memoryUsage() const {
+            return m_lastCommandMemorySize + m_nextCommandMemorySize;
+        }
+        
+        void CommandProcessor::setMemoryBudget(const size_t memoryBudget) {
+            m_memoryBudget = memoryBudget;
+            enforceMemoryBudget();
+        }
+        
         CommandProcessor::SubmitAndStoreResult CommandProcessor::submitAndStoreCommand(UndoableCommand::Ptr command, const bool collate) {
             SubmitAndStoreResult result;
             result.submitted = doCommand(command);
@@ -241,8 +265,7 @@ namespace TrenchBroom {
                 return result;
             
             result.stored = storeCommand(command, collate);
-            if (!m_nextCommandStack.empty())
-                m_nextCommandStack.clear();
+            clearNextCommands();
             return result;
         }
         
@@ -331,10 +354,17 @@ namespace TrenchBroom {
             
             if (collatable(collate, timestamp)) {
                 UndoableCommand::Ptr lastCommand = m_lastCommandStack.back();
-                if (lastCommand->collateWith(command))
+                const size_t memorySize = lastCommand->memorySize();
+                if (lastCommand->collateWith(command)) {
+                    // collating may change the undo information of the last command
+                    m_lastCommandMemorySize = m_lastCommandMemorySize - memorySize + lastCommand->memorySize();
+                    enforceMemoryBudget();
                     return false;
+                }
             }
             m_lastCommandStack.push_back(command);
+            m_lastCommandMemorySize += command->memorySize();
+            enforceMemoryBudget();
             return true;
         }
         
@@ -342,9 +372,27 @@ namespace TrenchBroom {
             return collate && !m_lastCommandStack.empty() && timestamp - m_lastCommandTimestamp <= CollationInterval;
         }
         
+        void CommandProcessor::enforceMemoryBudget() {
+            // only the undo stack is budgeted, since only its commands can be discarded; the redo stack only holds
+            // commands which were on the undo stack before, and it is cleared when the next command is stored
+            size_t count = 0;
+            while (m_lastCommandMemorySize > m_memoryBudget && count + 1 < m_lastCommandStack.size()) {
+                const UndoableCommand::Ptr command = m_lastCommandStack[count++];
+                const size_t size = command->memorySize();
+                m_document->debug("Discarding undo information for '%s' (%u KB)", command->name().c_str(), static_cast<unsigned int>(size / 1024));
+                m_lastCommandMemorySize -= size;
+            }
+            
+            if (count > 0) {
+                const CommandStack::iterator first = std::begin(m_lastCommandStack);
+                m_lastCommandStack.erase(first, first + static_cast<CommandStack::difference_type>(count));
+            }
+        }
+        
         void CommandProcessor::pushNextCommand(UndoableCommand::Ptr command) {
             assert(m_groupLevel == 0);
             m_nextCommandStack.push_back(command);
+            m_nextCommandMemorySize += command->memorySize();
         }
         
         void CommandProcessor::pushRepeatableCommand(UndoableCommand::Ptr command) {
@@ -365,6 +413,7 @@ namespace TrenchBroom {
                 throw CommandProcessorException("Command stack is empty");
             UndoableCommand::Ptr lastCommand = m_lastCommandStack.back();
             m_lastCommandStack.pop_back();
+            m_lastCommandMemorySize -= lastCommand->memorySize();
             return lastCommand;
         }
         
@@ -374,9 +423,20 @@ namespace TrenchBroom {
                 throw CommandProcessorException("Command stack is empty");
             UndoableCommand::Ptr nextCommand = m_nextCommandStack.back();
             m_nextCommandStack.pop_back();
+            m_nextCommandMemorySize -= nextCommand->memorySize();
             return nextCommand;
         }
         
+        void CommandProcessor::clearLastCommands() {
+            m_lastCommandStack.clear();
+            m_lastCommandMemorySize = 0;
+        }
+        
+        void CommandProcessor::clearNextCommands() {
+            m_nextCommandStack.clear();
+            m_nextCommandMemorySize = 0;
+        }
+        
         void CommandProcessor::popLastRepeatableCommand(UndoableCommand::Ptr command) {
             if (!m_repeatableCommandStack.empty() && m_repeatableCommandStack.back() == command)
                 m_repeatableCommandStack.pop_back();
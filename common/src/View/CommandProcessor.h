@@ -62,17 +62,26 @@ namespace TrenchBroom {
             UndoableCommand::Ptr doRepeat(MapDocumentCommandFacade* document) const;
 
             bool doCollateWith(UndoableCommand::Ptr command);
+            
+            size_t doGetMemorySize() const;
         };
         
         class CommandProcessor {
+        public:
+            static const size_t DefaultMemoryBudget;
         private:
             static const wxLongLong CollationInterval;
             
             MapDocumentCommandFacade* m_document;
+            size_t m_memoryBudget;
             
             typedef CommandList CommandStack;
             CommandStack m_lastCommandStack;
             CommandStack m_nextCommandStack;
+            
+            // the memory sizes of the commands on the undo and redo stacks, as reported when they were pushed
+            size_t m_lastCommandMemorySize;
+            size_t m_nextCommandMemorySize;
             CommandStack m_repeatableCommandStack;
             bool m_clearRepeatableCommandStack;
             wxLongLong m_lastCommandTimestamp;
@@ -111,6 +120,17 @@ namespace TrenchBroom {
             void clearRepeatableCommands();
             
             void clear();
+            
+            /**
+             Returns the approximate number of bytes used by the commands on the undo and redo stacks.
+             */
+            size_t memoryUsage() const;
+            
+            /**
+             Sets the number of bytes that the commands on the undo stack may use. If they use more, the oldest
+             commands are removed from the undo stack, but the last command always remains undoable.
+             */
+            void setMemoryBudget(size_t memoryBudget);
         private:
             SubmitAndStoreResult submitAndStoreCommand(UndoableCommand::Ptr command, bool collate);
             bool doCommand(Command::Ptr command);
@@ -125,6 +145,7 @@ namespace TrenchBroom {
 
             bool pushLastCommand(UndoableCommand::Ptr command, bool collate);
             bool collatable(bool collate, wxLongLong timestamp) const;
+            void enforceMemoryBudget();
             
             void pushNextCommand(UndoableCommand::Ptr command);
             void pushRepeatableCommand(UndoableCommand::Ptr command);
@@ -132,6 +153,8 @@ namespace TrenchBroom {
             
             UndoableCommand::Ptr popLastCommand();
             UndoableCommand::Ptr popNextCommand();
+            void clearLastCommands();
+            void clearNextCommands();
             void popLastRepeatableCommand(UndoableCommand::Ptr command);
         };
     }
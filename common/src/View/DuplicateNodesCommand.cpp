@@ -19,6 +19,7 @@
 
 #include "DuplicateNodesCommand.h"
 
+#include "Model/ModelUtils.h"
 #include "Model/Node.h"
 #include "Model/NodeVisitor.h"
 #include "View/MapDocumentCommandFacade.h"
@@ -114,5 +115,15 @@ namespace TrenchBroom {
         bool DuplicateNodesCommand::doCollateWith(UndoableCommand::Ptr command) {
             return false;
         }
+        
+        size_t DuplicateNodesCommand::doGetMemorySize() const {
+            size_t size = sizeof(DuplicateNodesCommand);
+            size += (m_previouslySelectedNodes.capacity() + m_nodesToSelect.capacity()) * sizeof(Model::Node*);
+            
+            // the duplicates belong to this command while they are not part of the map
+            if (state() == CommandState_Default)
+                size += Model::memorySize(m_addedNodes);
+            return size;
+        }
     }
 }
@@ -52,6 +52,8 @@ namespace TrenchBroom {
             UndoableCommand::Ptr doRepeat(MapDocumentCommandFacade* document) const;
             
             bool doCollateWith(UndoableCommand::Ptr command);
+            
+            size_t doGetMemorySize() const;
         };
     }
 }
@@ -164,6 +164,8 @@ namespace TrenchBroom {
             MapDocumentSPtr document = lock(m_document);
             Model::World* world = document->world();
             if (world != NULL) {
+                world->validateAllIssues();
+                
                 const Model::IssueGeneratorList& issueGenerators = world->registeredIssueGenerators();
                 Model::CollectMatchingIssuesVisitor<IssueVisible> visitor(issueGenerators, IssueVisible(m_hiddenGenerators, m_showHiddenIssues));
                 world->acceptAndRecurse(visitor);
@@ -33,16 +33,15 @@
 #include "Model/BrushBuilder.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushGeometry.h"
+#include "Model/BrushVolumeQuery.h"
 #include "Model/ChangeBrushFaceAttributesRequest.h"
 #include "Model/CollectAttributableNodesVisitor.h"
-#include "Model/CollectContainedNodesVisitor.h"
 #include "Model/CollectMatchingBrushFacesVisitor.h"
 #include "Model/CollectNodesVisitor.h"
 #include "Model/CollectNodesByVisibilityVisitor.h"
 #include "Model/CollectSelectableNodesVisitor.h"
 #include "Model/CollectSelectableNodesWithFilePositionVisitor.h"
 #include "Model/CollectSelectedNodesVisitor.h"
-#include "Model/CollectTouchingNodesVisitor.h"
 #include "Model/CollectUniqueNodesVisitor.h"
 #include "Model/ComputeNodeBoundsVisitor.h"
 #include "Model/EditorContext.h"
@@ -264,6 +263,9 @@ namespace TrenchBroom {
         }
         
         void MapDocument::exportDocumentAs(const Model::ExportFormat format, const IO::Path& path) {
+            // the texture sizes are required to compute the texture coordinates
+            if (m_textureManager->finishLoading())
+                textureCollectionsWereLoaded();
             m_game->exportMap(m_world, format, path);
         }
 
@@ -451,10 +453,8 @@ namespace TrenchBroom {
         void MapDocument::selectTouching(const bool del) {
             const Model::BrushList& brushes = m_selectedNodes.brushes();
             
-            Model::CollectTouchingNodesVisitor<Model::BrushList::const_iterator> visitor(std::begin(brushes), std::end(brushes), editorContext());
-            m_world->acceptAndRecurse(visitor);
-            
-            const Model::NodeList nodes = visitor.nodes();
+            const Model::BrushVolumeQuery query(m_world, brushes, editorContext());
+            const Model::NodeList nodes = query.touchingNodes();
             
             Transaction transaction(this, "Select Touching");
             if (del)
@@ -467,10 +467,8 @@ namespace TrenchBroom {
         void MapDocument::selectInside(const bool del) {
             const Model::BrushList& brushes = m_selectedNodes.brushes();
 
-            Model::CollectContainedNodesVisitor<Model::BrushList::const_iterator> visitor(std::begin(brushes), std::end(brushes), editorContext());
-            m_world->acceptAndRecurse(visitor);
-            
-            const Model::NodeList nodes = visitor.nodes();
+            const Model::BrushVolumeQuery query(m_world, brushes, editorContext());
+            const Model::NodeList nodes = query.containedNodes();
 
             Transaction transaction(this, "Select Inside");
             if (del)
@@ -932,8 +930,10 @@ namespace TrenchBroom {
             Model::NodeList toRemove;
             toRemove.push_back(subtrahend);
             
-            for (Model::Brush* minuend : minuends) {
-                const Model::BrushList result = minuend->subtract(*m_world, m_worldBounds, currentTextureName(), subtrahend);
+            const std::vector<Model::BrushList> fragments = Model::Brush::subtractFromBrushes(minuends, *m_world, m_worldBounds, currentTextureName(), subtrahend);
+            for (size_t i = 0; i < minuends.size(); ++i) {
+                Model::Brush* minuend = minuends[i];
+                const Model::BrushList& result = fragments[i];
                 if (!result.empty()) {
                     VectorUtils::append(toAdd[minuend->parent()], result);
                     toRemove.push_back(minuend);
@@ -960,10 +960,14 @@ namespace TrenchBroom {
             Model::BrushList::const_iterator it, end;
             for (it = std::begin(brushes), end = std::end(brushes); it != end && valid; ++it) {
                 Model::Brush* brush = *it;
-                try {
-                    result->intersect(m_worldBounds, brush);
-                } catch (const GeometryException&) {
+                if (!result->intersects(brush)) {
                     valid = false;
+                } else {
+                    try {
+                        result->intersect(m_worldBounds, brush);
+                    } catch (const GeometryException&) {
+                        valid = false;
+                    }
                 }
             }
             
@@ -1218,7 +1222,8 @@ namespace TrenchBroom {
         }
         
         void MapDocument::commitPendingAssets() {
-            m_textureManager->commitChanges();
+            if (m_textureManager->commitChanges())
+                textureCollectionsWereLoaded();
         }
         
         void MapDocument::pick(const Ray3& pickRay, Model::PickResult& pickResult) const {
@@ -1351,6 +1356,11 @@ namespace TrenchBroom {
             loadTextures();
             setTextures();
         }
+        
+        void MapDocument::textureCollectionsWereLoaded() {
+            setTextures();
+            textureCollectionsDidChangeNotifier();
+        }
 
         class SetEntityDefinition : public Model::NodeVisitor {
         private:
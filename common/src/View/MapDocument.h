@@ -384,6 +384,7 @@ namespace TrenchBroom {
             void loadTextures();
             void unloadTextures();
             void reloadTextures();
+            void textureCollectionsWereLoaded();
             
             void setEntityDefinitions();
             void setEntityDefinitions(const Model::NodeList& nodes);
@@ -435,23 +435,18 @@ namespace TrenchBroom {
             groupWasClosedNotifier(previousGroup);
         }
 
-        void
-        MapDocumentCommandFacade::performTransform(const Mat4x4 &transform,
-                                                   const bool lockTextures) {
-          const Model::NodeList &nodes = m_selectedNodes.nodes();
-          const Model::NodeList parents = collectParents(nodes);
-
-          Notifier1<const Model::NodeList &>::NotifyBeforeAndAfter
-              notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier,
-                            parents);
-          Notifier1<const Model::NodeList &>::NotifyBeforeAndAfter notifyNodes(
-              nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
-
-          Model::TransformObjectVisitor visitor(transform, lockTextures,
-                                                m_worldBounds);
-          Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
-
-          invalidateSelectionBounds();
+        void MapDocumentCommandFacade::performTransform(const Mat4x4& transform, const bool lockTextures) {
+            const Model::NodeList& nodes = m_selectedNodes.nodes();
+            const Model::NodeList parents = collectParents(nodes);
+            
+            Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
+            Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
+            
+            Model::TransformObjectVisitor visitor(transform, lockTextures, m_worldBounds);
+            Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
+            visitor.transformBrushes();
+            
+            invalidateSelectionBounds();
         }
 
         Model::EntityAttributeSnapshot::Map MapDocumentCommandFacade::performSetAttribute(const Model::AttributeName& name, const Model::AttributeValue& value) {
@@ -822,8 +817,7 @@ namespace TrenchBroom {
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
             Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
             
-            for (Model::Brush* brush : brushes)
-                brush->rebuildGeometry(m_worldBounds);
+            Model::Brush::rebuildBrushGeometry(brushes, m_worldBounds);
 
             invalidateSelectionBounds();
         }
@@ -837,6 +831,7 @@ namespace TrenchBroom {
                 Notifier1<const Model::NodeList&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
                 
                 snapshot->restoreNodes(m_worldBounds);
+                setTextures(nodes);
                 
                 invalidateSelectionBounds();
             }
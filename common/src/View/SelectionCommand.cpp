@@ -154,5 +154,11 @@ namespace TrenchBroom {
         bool SelectionCommand::doCollateWith(UndoableCommand::Ptr command) {
             return false;
         }
+        
+        size_t SelectionCommand::doGetMemorySize() const {
+            return (sizeof(SelectionCommand) +
+                    (m_nodes.capacity() + m_previouslySelectedNodes.capacity()) * sizeof(Model::Node*) +
+                    (m_faces.capacity() + m_previouslySelectedFaces.capacity()) * sizeof(Model::BrushFace*));
+        }
     }
 }
@@ -65,5 +65,9 @@ namespace TrenchBroom {
             SnapBrushVerticesCommand* other = static_cast<SnapBrushVerticesCommand*>(command.get());
             return other->m_snapTo == m_snapTo;
         }
+
+        size_t SnapBrushVerticesCommand::doGetMemorySize() const {
+            return m_snapshot != NULL ? m_snapshot->memorySize() : 0;
+        }
     }
 }
@@ -233,7 +233,8 @@ namespace TrenchBroom {
         void TextureBrowserView::doClear() {}
         
         void TextureBrowserView::doRender(Layout& layout, const float y, const float height) {
-            m_textureManager.commitChanges();
+            // adding decoded collections is left to the document, which must rebind the face textures
+            m_textureManager.prepareChanges();
             
             const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
             const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
@@ -94,5 +94,9 @@ namespace TrenchBroom {
             m_transform = m_transform * other->m_transform;
             return true;
         }
+
+        size_t TransformObjectsCommand::doGetMemorySize() const {
+            return m_snapshot != NULL ? m_snapshot->memorySize() : 0;
+        }
     }
 }
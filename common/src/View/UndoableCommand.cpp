@@ -58,6 +58,10 @@ namespace TrenchBroom {
             return doCollateWith(command);
         }
 
+        size_t UndoableCommand::memorySize() const {
+            return doGetMemorySize();
+        }
+
         bool UndoableCommand::doIsRepeatDelimiter() const {
             return false;
         }
@@ -66,6 +70,11 @@ namespace TrenchBroom {
             throw CommandProcessorException("Command is not repeatable");
         }
 
+        size_t UndoableCommand::doGetMemorySize() const {
+            // commands without undo information of their own still occupy some memory
+            return sizeof(UndoableCommand) + name().capacity();
+        }
+
         size_t UndoableCommand::documentModificationCount() const {
             throw CommandProcessorException("Command does not modify the document");
         }
@@ -43,6 +43,22 @@ namespace TrenchBroom {
         const Model::Hit::HitType VertexHandleManager::EdgeHandleHit   = Model::Hit::freeHitType();
         const Model::Hit::HitType VertexHandleManager::FaceHandleHit   = Model::Hit::freeHitType();
         
+        VertexHandleManager::HandleRadius::HandleRadius(const Renderer::Camera& camera) :
+        m_camera(camera),
+        m_radius(2.0 * pref(Preferences::HandleRadius)) {}
+        
+        FloatType VertexHandleManager::HandleRadius::operator()(const BBox3& bounds) const {
+            // the scaling factor is the absolute value of a linear function, so its maximum is attained at a corner
+            float scaling = 0.0f;
+            for (size_t i = 0; i < 8; ++i) {
+                const BBox3::Corner x = (i & 1) ? BBox3::Corner_Max : BBox3::Corner_Min;
+                const BBox3::Corner y = (i & 2) ? BBox3::Corner_Max : BBox3::Corner_Min;
+                const BBox3::Corner z = (i & 4) ? BBox3::Corner_Max : BBox3::Corner_Min;
+                scaling = std::max(scaling, std::abs(m_camera.perspectiveScalingFactor(Vec3f(bounds.vertex(x, y, z)))));
+            }
+            return m_radius * static_cast<FloatType>(scaling);
+        }
+        
         VertexHandleManager::VertexHandleManager(View::MapDocumentWPtr document) :
         m_totalVertexCount(0),
         m_selectedVertexCount(0),
@@ -54,27 +70,27 @@ namespace TrenchBroom {
         m_renderStateValid(false) {}
         
         const Model::VertexToBrushesMap& VertexHandleManager::unselectedVertexHandles() const {
-            return m_unselectedVertexHandles;
+            return m_unselectedVertexHandles.handles();
         }
         
         const Model::VertexToBrushesMap& VertexHandleManager::selectedVertexHandles() const {
-            return m_selectedVertexHandles;
+            return m_selectedVertexHandles.handles();
         }
         
         const Model::VertexToEdgesMap& VertexHandleManager::unselectedEdgeHandles() const {
-            return m_unselectedEdgeHandles;
+            return m_unselectedEdgeHandles.handles();
         }
         
         const Model::VertexToEdgesMap& VertexHandleManager::selectedEdgeHandles() const {
-            return m_selectedEdgeHandles;
+            return m_selectedEdgeHandles.handles();
         }
         
         const Model::VertexToFacesMap& VertexHandleManager::unselectedFaceHandles() const {
-            return m_unselectedFaceHandles;
+            return m_unselectedFaceHandles.handles();
         }
         
         const Model::VertexToFacesMap& VertexHandleManager::selectedFaceHandles() const {
-            return m_selectedFaceHandles;
+            return m_selectedFaceHandles.handles();
         }
         
         Vec3::List VertexHandleManager::vertexHandlePositions() const {
@@ -515,53 +531,19 @@ namespace TrenchBroom {
         }
 
         void VertexHandleManager::pick(const Ray3& ray, const Renderer::Camera& camera, Model::PickResult& pickResult, bool splitMode) const {
-            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode) {
-                for (const auto& entry : m_unselectedVertexHandles) {
-                    const Vec3& position = entry.first;
-                    const Model::Hit hit = pickHandle(ray, camera, position, VertexHandleHit);
-                    if (hit.isMatch())
-                        pickResult.addHit(hit);
-                }
-            }
-
-            for (const auto& entry : m_selectedVertexHandles) {
-                const Vec3& position = entry.first;
-                const Model::Hit hit = pickHandle(ray, camera, position, VertexHandleHit);
-                if (hit.isMatch())
-                    pickResult.addHit(hit);
-            }
-            
-            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode) {
-                for (const auto& entry : m_unselectedEdgeHandles) {
-                    const Vec3& position = entry.first;
-                    const Model::Hit hit = pickHandle(ray, camera, position, EdgeHandleHit);
-                    if (hit.isMatch())
-                        pickResult.addHit(hit);
-                }
-            }
+            const HandleRadius radius(camera);
             
-            for (const auto& entry : m_selectedEdgeHandles) {
-                const Vec3& position = entry.first;
-                const Model::Hit hit = pickHandle(ray, camera, position, EdgeHandleHit);
-                if (hit.isMatch())
-                    pickResult.addHit(hit);
-            }
+            if ((m_selectedEdgeHandles.empty() && m_selectedFaceHandles.empty()) || splitMode)
+                pickHandles(ray, camera, m_unselectedVertexHandles.findHandles(ray, radius), VertexHandleHit, pickResult);
+            pickHandles(ray, camera, m_selectedVertexHandles.findHandles(ray, radius), VertexHandleHit, pickResult);
             
-            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode) {
-                for (const auto& entry : m_unselectedFaceHandles) {
-                    const Vec3& position = entry.first;
-                    const Model::Hit hit = pickHandle(ray, camera, position, FaceHandleHit);
-                    if (hit.isMatch())
-                        pickResult.addHit(hit);
-                }
-            }
+            if (m_selectedVertexHandles.empty() && m_selectedFaceHandles.empty() && !splitMode)
+                pickHandles(ray, camera, m_unselectedEdgeHandles.findHandles(ray, radius), EdgeHandleHit, pickResult);
+            pickHandles(ray, camera, m_selectedEdgeHandles.findHandles(ray, radius), EdgeHandleHit, pickResult);
             
-            for (const auto& entry : m_selectedFaceHandles) {
-                const Vec3& position = entry.first;
-                const Model::Hit hit = pickHandle(ray, camera, position, FaceHandleHit);
-                if (hit.isMatch())
-                    pickResult.addHit(hit);
-            }
+            if (m_selectedVertexHandles.empty() && m_selectedEdgeHandles.empty() && !splitMode)
+                pickHandles(ray, camera, m_unselectedFaceHandles.findHandles(ray, radius), FaceHandleHit, pickResult);
+            pickHandles(ray, camera, m_selectedFaceHandles.findHandles(ray, radius), FaceHandleHit, pickResult);
         }
 
         void VertexHandleManager::render(Renderer::RenderContext& renderContext, Renderer::RenderBatch& renderBatch, const bool splitMode) {
@@ -639,45 +621,45 @@ namespace TrenchBroom {
         
         Vec3::List VertexHandleManager::findVertexHandlePositions(const Model::BrushSet& brushes, const Vec3& query, const FloatType maxDistance) {
             Vec3::List result;
-            
-            for (const Model::Brush* brush : brushes) {
-                for (const Model::BrushVertex* vertex : brush->vertices()) {
-                    if (query.squaredDistanceTo(vertex->position()) <= maxDistance * maxDistance)
-                        result.push_back(vertex->position());
-                }
-            }
-            
+            findHandlePositions(m_unselectedVertexHandles, brushes, query, maxDistance, result);
+            findHandlePositions(m_selectedVertexHandles, brushes, query, maxDistance, result);
             return result;
         }
 
         Vec3::List VertexHandleManager::findEdgeHandlePositions(const Model::BrushSet& brushes, const Vec3& query, const FloatType maxDistance) {
             Vec3::List result;
-
-            for (const Model::Brush* brush : brushes) {
-                for (const Model::BrushEdge* edge : brush->edges()) {
-                    const Vec3 center = edge->center();
-                    if (query.squaredDistanceTo(center) <= maxDistance * maxDistance)
-                        result.push_back(center);
-                }
-            }
-            
+            findHandlePositions(m_unselectedEdgeHandles, brushes, query, maxDistance, result);
+            findHandlePositions(m_selectedEdgeHandles, brushes, query, maxDistance, result);
             return result;
         }
         
         Vec3::List VertexHandleManager::findFaceHandlePositions(const Model::BrushSet& brushes, const Vec3& query, const FloatType maxDistance) {
             Vec3::List result;
-
-            for (const Model::Brush* brush : brushes) {
-                for (const Model::BrushFace* face : brush->faces()) {
-                    const Vec3 center = face->center();
-                    if (query.squaredDistanceTo(center) <= maxDistance * maxDistance)
-                        result.push_back(center);
-                }
-            }
-            
+            findHandlePositions(m_unselectedFaceHandles, brushes, query, maxDistance, result);
+            findHandlePositions(m_selectedFaceHandles, brushes, query, maxDistance, result);
             return result;
         }
+        
+        Model::Brush* VertexHandleManager::brush(Model::Brush* brush) {
+            return brush;
+        }
+        
+        Model::Brush* VertexHandleManager::brush(Model::BrushEdge* edge) {
+            return edge->firstFace()->payload()->brush();
+        }
+        
+        Model::Brush* VertexHandleManager::brush(Model::BrushFace* face) {
+            return face->brush();
+        }
 
+        void VertexHandleManager::pickHandles(const Ray3& ray, const Renderer::Camera& camera, const Vec3::List& positions, const Model::Hit::HitType type, Model::PickResult& pickResult) const {
+            for (const Vec3& position : positions) {
+                const Model::Hit hit = pickHandle(ray, camera, position, type);
+                if (hit.isMatch())
+                    pickResult.addHit(hit);
+            }
+        }
+        
         Model::Hit VertexHandleManager::pickHandle(const Ray3& ray, const Renderer::Camera& camera, const Vec3& position, Model::Hit::HitType type) const {
             const FloatType distance = camera.pickPointHandle(ray, position, pref(Preferences::HandleRadius));
             if (!Math::isnan(distance)) {
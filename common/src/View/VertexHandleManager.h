@@ -27,6 +27,7 @@
 #include "Model/ModelTypes.h"
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/PointGuideRenderer.h"
+#include "View/VertexHandleMap.h"
 #include "View/ViewTypes.h"
 
 #include <map>
@@ -49,12 +50,29 @@ namespace TrenchBroom {
             static const Model::Hit::HitType EdgeHandleHit;
             static const Model::Hit::HitType FaceHandleHit;
         private:
-            Model::VertexToBrushesMap m_unselectedVertexHandles;
-            Model::VertexToBrushesMap m_selectedVertexHandles;
-            Model::VertexToEdgesMap m_unselectedEdgeHandles;
-            Model::VertexToEdgesMap m_selectedEdgeHandles;
-            Model::VertexToFacesMap m_unselectedFaceHandles;
-            Model::VertexToFacesMap m_selectedFaceHandles;
+            /**
+             Computes an upper bound of the pick radius of the handles within a box. The radius is scaled with the
+             distance to the camera, so the bound is attained at one of the corners of the box.
+             */
+            class HandleRadius {
+            private:
+                const Renderer::Camera& m_camera;
+                FloatType m_radius;
+            public:
+                HandleRadius(const Renderer::Camera& camera);
+                FloatType operator()(const BBox3& bounds) const;
+            };
+            
+            typedef VertexHandleMap<Model::Brush> VertexHandles;
+            typedef VertexHandleMap<Model::BrushEdge> EdgeHandles;
+            typedef VertexHandleMap<Model::BrushFace> FaceHandles;
+            
+            VertexHandles m_unselectedVertexHandles;
+            VertexHandles m_selectedVertexHandles;
+            EdgeHandles m_unselectedEdgeHandles;
+            EdgeHandles m_selectedEdgeHandles;
+            FaceHandles m_unselectedFaceHandles;
+            FaceHandles m_selectedFaceHandles;
             
             size_t m_totalVertexCount;
             size_t m_selectedVertexCount;
@@ -164,11 +182,10 @@ namespace TrenchBroom {
             void renderGuide(Renderer::RenderContext& renderContext, Renderer::RenderBatch& renderBatch, const Vec3& position);
         private:
             template <typename Element>
-            inline bool removeHandle(const Vec3& position, Element* element, std::map<Vec3, std::set<Element*>, Vec3::LexicographicOrder >& map) {
-                typedef std::set<Element*> Set;
-                typedef std::map<Vec3, Set, Vec3::LexicographicOrder> Map;
+            inline bool removeHandle(const Vec3& position, Element* element, VertexHandleMap<Element>& map) {
+                typedef typename VertexHandleMap<Element>::ElementSet Set;
                 
-                typename Map::iterator mapIt = map.find(position);
+                typename VertexHandleMap<Element>::iterator mapIt = map.find(position);
                 if (mapIt == std::end(map))
                     return false;
                 
@@ -184,11 +201,10 @@ namespace TrenchBroom {
             }
             
             template <typename Element>
-            inline size_t moveHandle(const Vec3& position, std::map<Vec3, std::set<Element*>, Vec3::LexicographicOrder >& from, std::map<Vec3, std::set<Element*>, Vec3::LexicographicOrder >& to) {
-                typedef std::set<Element*> Set;
-                typedef std::map<Vec3, Set, Vec3::LexicographicOrder> Map;
+            inline size_t moveHandle(const Vec3& position, VertexHandleMap<Element>& from, VertexHandleMap<Element>& to) {
+                typedef typename VertexHandleMap<Element>::ElementSet Set;
                 
-                typename Map::iterator mapIt = from.find(position);
+                typename VertexHandleMap<Element>::iterator mapIt = from.find(position);
                 if (mapIt == std::end(from))
                     return 0;
                 
@@ -201,8 +217,8 @@ namespace TrenchBroom {
                 return elementCount;
             }
 
-            template <typename T, typename O>
-            void handlePositions(const std::map<Vec3, T, O>& handles, Vec3::List& result) const {
+            template <typename Element>
+            void handlePositions(const VertexHandleMap<Element>& handles, Vec3::List& result) const {
                 result.reserve(result.size() + handles.size());
                 
                 for (const auto& entry : handles) {
@@ -215,6 +231,23 @@ namespace TrenchBroom {
             Vec3::List findEdgeHandlePositions(const Model::BrushSet& brushes, const Vec3& query, FloatType maxDistance);
             Vec3::List findFaceHandlePositions(const Model::BrushSet& brushes, const Vec3& query, FloatType maxDistance);
             
+            template <typename Element>
+            void findHandlePositions(const VertexHandleMap<Element>& handles, const Model::BrushSet& brushes, const Vec3& query, const FloatType maxDistance, Vec3::List& result) const {
+                for (const auto& mapIt : handles.findHandles(query, maxDistance)) {
+                    for (Element* element : mapIt->second) {
+                        if (brushes.count(brush(element)) > 0) {
+                            result.push_back(mapIt->first);
+                            break;
+                        }
+                    }
+                }
+            }
+            
+            static Model::Brush* brush(Model::Brush* brush);
+            static Model::Brush* brush(Model::BrushEdge* edge);
+            static Model::Brush* brush(Model::BrushFace* face);
+            
+            void pickHandles(const Ray3& ray, const Renderer::Camera& camera, const Vec3::List& positions, Model::Hit::HitType type, Model::PickResult& pickResult) const;
             Model::Hit pickHandle(const Ray3& ray, const Renderer::Camera& camera, const Vec3& position, Model::Hit::HitType type) const;
             void validateRenderState(bool splitMode);
         };
@@ -0,0 +1,139 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VertexHandleMap
+#define TrenchBroom_VertexHandleMap
+
+#include "Macros.h"
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/AABBTree.h"
+
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace View {
+        /**
+         Maps handle positions to the elements (brushes, edges or faces) that share a handle at that position. The
+         positions are also kept in a spatial index so that the handles near a pick ray or a point can be found
+         without looking at every handle.
+         */
+        template <typename Element>
+        class VertexHandleMap {
+        public:
+            typedef std::set<Element*> ElementSet;
+            typedef std::map<Vec3, ElementSet, Vec3::LexicographicOrder> Map;
+            typedef typename Map::iterator iterator;
+            typedef typename Map::const_iterator const_iterator;
+        private:
+            // the index refers to the keys of the map, which remain valid until their entries are erased
+            typedef Model::AABBTree<FloatType, const Vec3*> Index;
+
+            Map m_handles;
+            Index m_index;
+        public:
+            VertexHandleMap() :
+            m_index(BBox3(std::numeric_limits<FloatType>::max())) {}
+
+            const Map& handles() const {
+                return m_handles;
+            }
+
+            bool empty() const {
+                return m_handles.empty();
+            }
+
+            size_t size() const {
+                return m_handles.size();
+            }
+
+            iterator begin() {
+                return std::begin(m_handles);
+            }
+
+            iterator end() {
+                return std::end(m_handles);
+            }
+
+            const_iterator begin() const {
+                return std::begin(m_handles);
+            }
+
+            const_iterator end() const {
+                return std::end(m_handles);
+            }
+
+            iterator find(const Vec3& position) {
+                return m_handles.find(position);
+            }
+
+            const_iterator find(const Vec3& position) const {
+                return m_handles.find(position);
+            }
+
+            ElementSet& operator[](const Vec3& position) {
+                const std::pair<iterator, bool> result = m_handles.insert(std::make_pair(position, ElementSet()));
+                if (result.second)
+                    m_index.addObject(BBox3(position, position), &result.first->first);
+                return result.first->second;
+            }
+
+            void erase(iterator it) {
+                m_index.removeObject(&it->first);
+                m_handles.erase(it);
+            }
+
+            void clear() {
+                m_handles.clear();
+                m_index.clear();
+            }
+
+            /**
+             Returns the positions of the handles that may be hit by the given ray. For a given box, the given
+             function must return an upper bound of the handle radius for all handles within the box.
+             */
+            template <typename R>
+            Vec3::List findHandles(const Ray3& ray, R maxRadius) const {
+                Vec3::List result;
+                for (const Vec3* position : m_index.findObjectsNearRay(ray, maxRadius))
+                    result.push_back(*position);
+                return result;
+            }
+
+            /**
+             Returns the iterators of the handles whose positions are within the given distance of the given point.
+             */
+            std::vector<const_iterator> findHandles(const Vec3& point, const FloatType maxDistance) const {
+                std::vector<const_iterator> result;
+                for (const Vec3* position : m_index.findObjects(BBox3(point, point).expanded(maxDistance))) {
+                    if (point.squaredDistanceTo(*position) <= maxDistance * maxDistance)
+                        result.push_back(m_handles.find(*position));
+                }
+                return result;
+            }
+
+            deleteCopyAndAssignment(VertexHandleMap)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_VertexHandleMap) */
@@ -0,0 +1,383 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stack>
+#include <thread>
+#include <vector>
+
+class PooledObject : public Allocator<PooledObject> {
+public:
+    double m_values[3];
+    size_t m_id;
+    
+    PooledObject(const size_t id) :
+    m_id(id) {
+        m_values[0] = m_values[1] = m_values[2] = static_cast<double>(id);
+    }
+};
+
+TEST(AllocatorTest, allocateAndFree) {
+    std::vector<PooledObject*> objects;
+    for (size_t i = 0; i < 1000; ++i)
+        objects.push_back(new PooledObject(i));
+    
+    for (size_t i = 0; i < objects.size(); ++i) {
+        ASSERT_EQ(i, objects[i]->m_id);
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(objects[i]) % alignof(PooledObject));
+    }
+    
+    std::sort(std::begin(objects), std::end(objects));
+    ASSERT_TRUE(std::adjacent_find(std::begin(objects), std::end(objects)) == std::end(objects));
+    
+    for (PooledObject* object : objects)
+        delete object;
+}
+
+TEST(AllocatorTest, allocateOnSeveralThreads) {
+    const size_t threadCount = 4;
+    const size_t objectCount = 10000;
+    
+    std::vector<std::vector<PooledObject*> > objects(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.push_back(std::thread([&objects, t, objectCount]() {
+            for (size_t i = 0; i < objectCount; ++i) {
+                objects[t].push_back(new PooledObject(t * objectCount + i));
+                if (i % 3 == 0) {
+                    delete objects[t].back();
+                    objects[t].pop_back();
+                }
+            }
+        }));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    
+    std::vector<PooledObject*> all;
+    for (size_t t = 0; t < threadCount; ++t) {
+        for (PooledObject* object : objects[t]) {
+            ASSERT_EQ(t, object->m_id / objectCount);
+            all.push_back(object);
+        }
+    }
+    
+    std::sort(std::begin(all), std::end(all));
+    ASSERT_TRUE(std::adjacent_find(std::begin(all), std::end(all)) == std::end(all));
+    
+    // free the objects on another thread than the one that allocated them
+    std::thread([&all]() {
+        for (PooledObject* object : all)
+            delete object;
+    }).join();
+}
+
+TEST(AllocatorTest, allocateInArena) {
+    std::vector<PooledObject*> objects;
+    {
+        AllocatorArena arena;
+        ASSERT_EQ(0u, arena.allocatedBytes());
+        {
+            const AllocatorArena::Scope scope(arena);
+            ASSERT_TRUE(AllocatorArena::current() != NULL);
+            for (size_t i = 0; i < 100; ++i)
+                objects.push_back(new PooledObject(i));
+        }
+        ASSERT_TRUE(AllocatorArena::current() == NULL);
+        
+        // the objects were placed into the arena
+        ASSERT_LE(100 * sizeof(PooledObject), arena.allocatedBytes());
+        
+        // objects created outside of the scope are pooled
+        PooledObject* pooled = new PooledObject(100);
+        delete pooled;
+        ASSERT_GE(100 * (sizeof(PooledObject) + sizeof(void*)), arena.allocatedBytes());
+    }
+    
+    // the objects outlive the arena object
+    for (size_t i = 0; i < objects.size(); ++i)
+        ASSERT_EQ(i, objects[i]->m_id);
+    
+    std::thread([&objects]() {
+        for (PooledObject* object : objects)
+            delete object;
+    }).join();
+}
+
+TEST(AllocatorTest, nestedArenaScopes) {
+    AllocatorArena outer;
+    AllocatorArena inner;
+    
+    const AllocatorArena::Scope outerScope(outer);
+    delete new PooledObject(0);
+    
+    {
+        const AllocatorArena::Scope innerScope(inner);
+        delete new PooledObject(1);
+    }
+    
+    delete new PooledObject(2);
+    
+    ASSERT_EQ(2 * inner.allocatedBytes(), outer.allocatedBytes());
+}
+
+// The allocator as it was before it supported threads and arenas, copied from the previous version of Allocator.h.
+// It serves as the baseline for the benchmark below.
+template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+class PreviousAllocator {
+private:
+    class Chunk {
+    private:
+        unsigned char m_blocks[BlocksPerChunk * sizeof(T)];
+        unsigned char m_firstFreeBlock;
+        unsigned char m_numFreeBlocks;
+    public:
+        Chunk() :
+        m_firstFreeBlock(0),
+        m_numFreeBlocks(BlocksPerChunk - 1) {
+            for (size_t i = 0; i < BlocksPerChunk - 1; i++)
+                m_blocks[i * sizeof(T)] = static_cast<unsigned char>(i + 1);
+        }
+        
+        bool contains(const T* t) const {
+            const unsigned char* block = reinterpret_cast<const unsigned char*>(t);
+            if (block < m_blocks)
+                return false;
+            size_t offset = static_cast<size_t>(block - m_blocks);
+            return offset < (BlocksPerChunk - 1) * sizeof(T);
+        }
+        
+        T* allocate() {
+            if (m_numFreeBlocks == 0)
+                return NULL;
+            
+            unsigned char* block = m_blocks + m_firstFreeBlock * sizeof(T);
+            m_firstFreeBlock = *block;
+            m_numFreeBlocks--;
+            return reinterpret_cast<T*>(block);
+        }
+        
+        void deallocate(T* t) {
+            assert(m_numFreeBlocks < BlocksPerChunk - 1);
+            assert(contains(t));
+            
+            unsigned char* block = reinterpret_cast<unsigned char*>(t);
+            assert(block >= m_blocks);
+            size_t offset = static_cast<size_t>(block - m_blocks);
+            assert(offset % sizeof(T) == 0);
+            
+            size_t index = offset / sizeof(T);
+            assert(index < BlocksPerChunk);
+            
+            *block = m_firstFreeBlock;
+            m_firstFreeBlock = static_cast<unsigned char>(index);
+            m_numFreeBlocks++;
+        }
+        
+        bool empty() const {
+            return m_numFreeBlocks == BlocksPerChunk - 1;
+        }
+        
+        bool full() const {
+            return m_numFreeBlocks == 0;
+        }
+    };
+    
+    typedef std::vector<Chunk*> ChunkList;
+    typedef std::stack<T*> Pool;
+    
+    static Pool& pool() {
+        static Pool p;
+        return p;
+    }
+    
+    static ChunkList& fullChunks() {
+        static ChunkList chunks;
+        return chunks;
+    }
+    
+    static ChunkList& mixedChunks() {
+        static ChunkList chunks;
+        return chunks;
+    }
+    
+    static ChunkList emptyChunks() {
+        static ChunkList chunks;
+        return chunks;
+    }
+public:
+    void* operator new(size_t size) {
+        assert(size == sizeof(T));
+        
+        if (!pool().empty()) {
+            T* t = pool().top();
+            pool().pop();
+            return t;
+        }
+        
+        Chunk* chunk = NULL;
+        if (mixedChunks().empty()) {
+            if (!emptyChunks().empty()) {
+                chunk = emptyChunks().back();
+                emptyChunks().pop_back();
+            } else {
+                chunk = new Chunk();
+            }
+        } else {
+            chunk = mixedChunks().back();
+            mixedChunks().pop_back();
+        }
+        
+        assert(!chunk->full());
+        T* block = chunk->allocate();
+        
+        if (chunk->full())
+            fullChunks().push_back(chunk);
+        else
+            mixedChunks().push_back(chunk);
+        return block;
+    }
+    
+    void operator delete(void* block) {
+        T* t = reinterpret_cast<T*>(block);
+        
+        if (PoolSize > 0 && pool().size() < PoolSize) {
+            pool().push(t);
+            return;
+        }
+        
+        typename ChunkList::reverse_iterator fullIt, fullEnd, mixedIt, mixedEnd;
+        fullIt = fullChunks().rbegin();
+        fullEnd = fullChunks().rend();
+        mixedIt = mixedChunks().rbegin();
+        mixedEnd = mixedChunks().rend();
+        
+        Chunk* chunk = NULL;
+        while (fullIt < fullEnd || mixedIt < mixedEnd) {
+            if (fullIt < fullEnd) {
+                Chunk* fullChunk = *fullIt;
+                if (fullChunk->contains(t)) {
+                    chunk = fullChunk;
+                    break;
+                }
+                ++fullIt;
+            }
+            if (mixedIt < mixedEnd) {
+                Chunk* mixedChunk = *mixedIt;
+                if (mixedChunk->contains(t)) {
+                    chunk = mixedChunk;
+                    break;
+                }
+                ++mixedIt;
+            }
+        }
+        
+        assert(chunk != NULL);
+        
+        if (chunk->full()) {
+            fullChunks().erase((fullIt + 1).base());
+            mixedChunks().push_back(chunk);
+        }
+        
+        chunk->deallocate(t);
+        
+        if (chunk->empty()) {
+            mixedChunks().erase((mixedIt + 1).base());
+            if (emptyChunks().size() < 2)
+                emptyChunks().push_back(chunk);
+            else
+                delete chunk;
+        }
+    }
+};
+
+class PreviousPooledObject : public PreviousAllocator<PreviousPooledObject> {
+public:
+    double m_values[3];
+    size_t m_id;
+    
+    PreviousPooledObject(const size_t id) :
+    m_id(id) {
+        m_values[0] = m_values[1] = m_values[2] = static_cast<double>(id);
+    }
+};
+
+class PlainObject {
+public:
+    double m_values[3];
+    size_t m_id;
+    
+    PlainObject(const size_t id) :
+    m_id(id) {
+        m_values[0] = m_values[1] = m_values[2] = static_cast<double>(id);
+    }
+};
+
+template <typename T>
+static double benchmarkAllocator(const size_t rounds, const size_t objectCount) {
+    typedef std::chrono::high_resolution_clock Clock;
+    
+    std::vector<T*> objects;
+    objects.reserve(objectCount);
+    
+    const Clock::time_point start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < objectCount; ++i)
+            objects.push_back(new T(i));
+        
+        // free every other object first to fragment the pool, like clipping a brush does
+        for (size_t i = 0; i < objectCount; i += 2)
+            delete objects[i];
+        for (size_t i = 1; i < objectCount; i += 2)
+            delete objects[i];
+        objects.clear();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// prints the time it takes to allocate and free objects with the allocator, the previous allocator and new / delete
+TEST(AllocatorTest, DISABLED_benchmark) {
+    const size_t rounds = 20;
+    const size_t objectCount = 20000;
+    
+    const double pooled = benchmarkAllocator<PooledObject>(rounds, objectCount);
+    const double previous = benchmarkAllocator<PreviousPooledObject>(rounds, objectCount);
+    const double plain = benchmarkAllocator<PlainObject>(rounds, objectCount);
+    
+    double arena = 0.0;
+    {
+        AllocatorArena allocatorArena;
+        const AllocatorArena::Scope scope(allocatorArena);
+        arena = benchmarkAllocator<PooledObject>(rounds, objectCount);
+    }
+    
+    std::cout << "Allocating and freeing " << rounds << " x " << objectCount << " objects:" << std::endl;
+    std::cout << "  Allocator:          " << pooled << "ms" << std::endl;
+    std::cout << "  Allocator (arena):  " << arena << "ms" << std::endl;
+    std::cout << "  Previous allocator: " << previous << "ms" << std::endl;
+    std::cout << "  new / delete:       " << plain << "ms" << std::endl;
+}
@@ -0,0 +1,100 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/TextureName.h"
+
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        TEST(TextureNameTest, defaultName) {
+            const TextureName name;
+            ASSERT_EQ(String(""), name.asString());
+            ASSERT_EQ(TextureName(""), name);
+        }
+        
+        TEST(TextureNameTest, internName) {
+            const TextureName first("base_wall");
+            const TextureName second(String("base_") + "wall");
+            const TextureName other("base_floor");
+            
+            ASSERT_EQ(String("base_wall"), first.asString());
+            ASSERT_EQ(first, second);
+            ASSERT_EQ(&first.asString(), &second.asString());
+            ASSERT_EQ(first.id(), second.id());
+            
+            ASSERT_NE(first, other);
+            ASSERT_NE(first.id(), other.id());
+        }
+        
+        TEST(TextureNameTest, caseVariantsShareID) {
+            const TextureName lower("sky_blue");
+            const TextureName upper("SKY_Blue");
+            
+            ASSERT_NE(lower, upper);
+            ASSERT_EQ(String("sky_blue"), lower.asString());
+            ASSERT_EQ(String("SKY_Blue"), upper.asString());
+            ASSERT_EQ(lower.id(), upper.id());
+        }
+        
+        TEST(TextureNameTest, findIdDoesNotIntern) {
+            ASSERT_EQ(TextureName::NoId, TextureName::findId("never_interned"));
+            ASSERT_EQ(TextureName::NoId, TextureName::findId("never_interned"));
+            
+            const TextureName name("Door_Metal");
+            ASSERT_EQ(name.id(), TextureName::findId("Door_Metal"));
+            ASSERT_EQ(name.id(), TextureName::findId("door_metal"));
+            ASSERT_EQ(name.id(), TextureName::findId("DOOR_METAL"));
+        }
+        
+        TEST(TextureNameTest, internConcurrently) {
+            static const size_t ThreadCount = 4;
+            static const size_t NameCount = 200;
+            
+            std::vector<std::vector<TextureName> > names(ThreadCount);
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < ThreadCount; ++i) {
+                threads.push_back(std::thread([i, &names]() {
+                    for (size_t j = 0; j < NameCount; ++j) {
+                        StringStream str;
+                        // every other thread uses upper case variants of the names
+                        str << (i % 2 == 0 ? "concurrent_" : "CONCURRENT_") << j;
+                        names[i].push_back(TextureName(str.str()));
+                    }
+                }));
+            }
+            for (std::thread& thread : threads)
+                thread.join();
+            
+            for (size_t j = 0; j < NameCount; ++j) {
+                for (size_t i = 1; i < ThreadCount; ++i) {
+                    ASSERT_EQ(names[0][j].id(), names[i][j].id());
+                    if (i % 2 == 0) {
+                        ASSERT_EQ(names[0][j], names[i][j]);
+                    } else {
+                        ASSERT_NE(names[0][j], names[i][j]);
+                    }
+                }
+            }
+        }
+    }
+}
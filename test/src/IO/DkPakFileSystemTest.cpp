@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include "Exceptions.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/FileMatcher.h"
 #include "IO/DkPakFileSystem.h"
@@ -149,5 +150,40 @@ namespace TrenchBroom {
             
             ASSERT_TRUE(fs.openFile(Path("amnet.cfg")) != NULL);
         }
+        
+        TEST(DkPakFileSystemTest, openCompressedFile) {
+            const Path pakPath = Disk::getCurrentWorkingDir() + Path("data/IO/Pak/dkpak_compressed.pak");
+            const MappedFile::Ptr pakFile = Disk::openFile(pakPath);
+            assert(pakFile != NULL);
+            
+            const DkPakFileSystem fs(pakPath, pakFile);
+            
+            // uses every kind of block: literal bytes, a run of zeros, a run of a byte, and back references to
+            // the preceding two bytes, which overlaps the copied range, and to the preceding twelve bytes
+            const MappedFile::Ptr compressed = fs.openFile(Path("compressed.bin"));
+            ASSERT_TRUE(compressed != NULL);
+            
+            const char expected[] = { 'a', 'b', 'c', 'd', 'e', 0, 0, 0, 'z', 'z', 'z', 'z', 'z', 'z', 'z', 'z', 'e', 0, 0, 0, 'z' };
+            ASSERT_EQ(sizeof(expected), compressed->size());
+            ASSERT_TRUE(std::equal(compressed->begin(), compressed->end(), expected));
+            
+            const MappedFile::Ptr plain = fs.openFile(Path("plain.txt"));
+            ASSERT_TRUE(plain != NULL);
+            ASSERT_EQ(String("uncompressed\n"), String(plain->begin(), plain->end()));
+        }
+        
+        TEST(DkPakFileSystemTest, openMalformedCompressedFile) {
+            const Path pakPath = Disk::getCurrentWorkingDir() + Path("data/IO/Pak/dkpak_malformed.pak");
+            const MappedFile::Ptr pakFile = Disk::openFile(pakPath);
+            assert(pakFile != NULL);
+            
+            const DkPakFileSystem fs(pakPath, pakFile);
+            
+            // literal bytes and a run of zeros that exceed the uncompressed size, and a back reference to data
+            // before the beginning of the output
+            ASSERT_THROW(fs.openFile(Path("overflow.bin")), FileFormatException);
+            ASSERT_THROW(fs.openFile(Path("zeros.bin")), FileFormatException);
+            ASSERT_THROW(fs.openFile(Path("backref.bin")), FileFormatException);
+        }
     }
 }
@@ -23,8 +23,10 @@
 #include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/FileMatcher.h"
 #include "IO/IdMipTextureReader.h"
 #include "IO/Path.h"
+#include "IO/TextureCollectionLoader.h"
 #include "IO/TextureReader.h"
 #include "IO/WadFileSystem.h"
 
@@ -72,5 +74,62 @@ namespace TrenchBroom {
             assertTexture("blowjob_machine",   128, 128, wadFS, textureLoader);
             assertTexture("lasthopeofhuman",   128, 128, wadFS, textureLoader);
         }
+        
+        TEST(IdMipTextureReaderTest, testReadTextureCollection) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader textureLoader(nameStrategy, palette);
+            
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath);
+            
+            MappedFile::List files;
+            for (const Path& path : wadFS.findItems(Path(""), FileExtensionMatcher("D")))
+                files.push_back(wadFS.openFile(path));
+            ASSERT_EQ(21u, files.size());
+            
+            // the textures are decoded in parallel, but must be identical to the sequentially decoded ones
+            const Assets::TextureCollection* collection = TextureCollectionLoader::readTextureCollection(wadPath, files, textureLoader);
+            ASSERT_TRUE(collection->loaded());
+            ASSERT_EQ(wadPath, collection->path());
+            
+            const Assets::TextureList& textures = collection->textures();
+            ASSERT_EQ(files.size(), textures.size());
+            for (size_t i = 0; i < files.size(); ++i) {
+                const Assets::Texture* expected = textureLoader.readTexture(files[i]);
+                ASSERT_EQ(expected->name(), textures[i]->name());
+                ASSERT_EQ(expected->width(), textures[i]->width());
+                ASSERT_EQ(expected->height(), textures[i]->height());
+                ASSERT_EQ(expected->averageColor(), textures[i]->averageColor());
+                delete expected;
+            }
+            
+            delete collection;
+        }
+        
+        TEST(IdMipTextureReaderTest, testDecodeOnFirstUse) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader textureLoader(nameStrategy, palette);
+            
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath);
+            
+            const MappedFile::Ptr file = wadFS.openFile(Path("cr8_czg_3.D"));
+            const Assets::Texture* decoded = textureLoader.readTexture(file->begin(), file->end(), file->path());
+            const Assets::Texture* deferred = textureLoader.readTexture(file);
+            
+            ASSERT_EQ(decoded->name(), deferred->name());
+            ASSERT_EQ(decoded->width(), deferred->width());
+            ASSERT_EQ(decoded->height(), deferred->height());
+            ASSERT_EQ(decoded->averageColor(), deferred->averageColor());
+            
+            delete decoded;
+            delete deferred;
+        }
     }
 }
@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/MapSnapshot.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/Entity.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+
+#include <cstdio>
+
+namespace TrenchBroom {
+    namespace IO {
+        static String readFile(FILE* file) {
+            String result;
+            std::rewind(file);
+            char buffer[4096];
+            size_t read;
+            while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, read);
+            return result;
+        }
+        
+        TEST(MapSnapshotTest, writeSnapshotOfModifiedWorld) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Standard, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            map.addOrUpdateAttribute("message", "holy damn");
+            
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::Brush* brush1 = builder.createCube(64.0, "tex1");
+            Model::Brush* brush2 = builder.createCuboid(BBox3(Vec3(64.0, 0.0, 0.0), Vec3(128.0, 32.0, 16.0)), "tex2");
+            map.defaultLayer()->addChild(brush1);
+            map.defaultLayer()->addChild(brush2);
+            
+            Model::Entity* entity = map.createEntity();
+            entity->addOrUpdateAttribute("classname", "func_door");
+            entity->addOrUpdateAttribute("speed", "100");
+            Model::Brush* brush3 = builder.createCube(16.0, "tex3");
+            entity->addChild(brush3);
+            map.defaultLayer()->addChild(entity);
+            
+            StringStream expected;
+            expected << "// Game: Quake\n// Format: Standard\n";
+            NodeWriter expectedWriter(&map, expected);
+            expectedWriter.writeMap();
+            
+            const MapSnapshot snapshot("Quake", &map);
+            
+            // the snapshot must not be affected by any changes to the world
+            map.addOrUpdateAttribute("message", "changed");
+            brush1->faces().front()->setXOffset(12.0f);
+            map.defaultLayer()->removeChild(brush2);
+            delete brush2;
+            entity->addOrUpdateAttribute("speed", "200");
+            entity->removeChild(brush3);
+            delete brush3;
+            
+            FILE* file = std::tmpfile();
+            ASSERT_TRUE(file != NULL);
+            
+            snapshot.write(file);
+            const String result = readFile(file);
+            std::fclose(file);
+            
+            ASSERT_EQ(expected.str(), result);
+        }
+    }
+}
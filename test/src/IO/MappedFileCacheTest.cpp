@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "IO/MappedFile.h"
+#include "IO/MappedFileCache.h"
+#include "IO/Path.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        static MappedFile::Ptr createFile(const size_t size) {
+            return MappedFile::Ptr(new MappedFileBuffer(Path("file"), new char[size], size));
+        }
+        
+        TEST(MappedFileCacheTest, getAndPut) {
+            MappedFileCache cache(100);
+            const int key1 = 0, key2 = 0;
+            
+            ASSERT_TRUE(cache.get(&key1).get() == NULL);
+            
+            const MappedFile::Ptr file1 = createFile(10);
+            cache.put(&key1, file1);
+            ASSERT_EQ(file1, cache.get(&key1));
+            ASSERT_TRUE(cache.get(&key2).get() == NULL);
+            ASSERT_EQ(10u, cache.size());
+            
+            const MappedFile::Ptr file2 = createFile(20);
+            cache.put(&key1, file2);
+            ASSERT_EQ(file2, cache.get(&key1));
+            ASSERT_EQ(20u, cache.size());
+            
+            cache.remove(&key1);
+            ASSERT_TRUE(cache.get(&key1).get() == NULL);
+            ASSERT_EQ(0u, cache.size());
+        }
+        
+        TEST(MappedFileCacheTest, evictLeastRecentlyUsed) {
+            MappedFileCache cache(100);
+            const int key1 = 0, key2 = 0, key3 = 0;
+            
+            cache.put(&key1, createFile(40));
+            cache.put(&key2, createFile(40));
+            
+            // key1 is now the most recently used file
+            ASSERT_TRUE(cache.get(&key1).get() != NULL);
+            
+            cache.put(&key3, createFile(40));
+            ASSERT_TRUE(cache.get(&key1).get() != NULL);
+            ASSERT_TRUE(cache.get(&key2).get() == NULL);
+            ASSERT_TRUE(cache.get(&key3).get() != NULL);
+            ASSERT_EQ(80u, cache.size());
+        }
+        
+        TEST(MappedFileCacheTest, skipFilesLargerThanCapacity) {
+            MappedFileCache cache(100);
+            const int key1 = 0, key2 = 0;
+            
+            cache.put(&key1, createFile(40));
+            cache.put(&key2, createFile(101));
+            
+            ASSERT_TRUE(cache.get(&key1).get() != NULL);
+            ASSERT_TRUE(cache.get(&key2).get() == NULL);
+            ASSERT_EQ(40u, cache.size());
+        }
+    }
+}
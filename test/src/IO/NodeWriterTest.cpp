@@ -23,11 +23,14 @@
 #include "IO/NodeWriter.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
 #include "Model/Group.h"
 #include "Model/Layer.h"
 #include "Model/MapFormat.h"
 #include "Model/World.h"
 
+#include <cstdio>
+
 namespace TrenchBroom {
     namespace IO {
         TEST(NodeWriterTest, writeEmptyMap) {
@@ -373,5 +376,78 @@ namespace TrenchBroom {
             
             delete brush;
         }
+
+        static String readFile(FILE* file) {
+            String result;
+            std::rewind(file);
+            char buffer[4096];
+            size_t read;
+            while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+                result.append(buffer, read);
+            return result;
+        }
+        
+        static String formatQuake2Face(const Model::BrushFace* face) {
+            const Model::BrushFace::Points& points = face->points();
+            char buffer[1024];
+            std::snprintf(buffer, sizeof(buffer), "( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) ( %.17g %.17g %.17g ) %s %.6g %.6g %.6g %.6g %.6g %d %d %.6g\n",
+                          points[0].x(), points[0].y(), points[0].z(),
+                          points[1].x(), points[1].y(), points[1].z(),
+                          points[2].x(), points[2].y(), points[2].z(),
+                          face->textureName().c_str(),
+                          face->xOffset(), face->yOffset(), face->rotation(), face->xScale(), face->yScale(),
+                          face->surfaceContents(), face->surfaceFlags(), face->surfaceValue());
+            return buffer;
+        }
+        
+        TEST(NodeWriterTest, writeMapToFile) {
+            const BBox3 worldBounds(8192.0);
+            
+            Model::World map(Model::MapFormat::Quake2, NULL, worldBounds);
+            map.addOrUpdateAttribute("classname", "worldspawn");
+            
+            // enough brushes to be written in several chunks
+            Model::BrushBuilder builder(&map, worldBounds);
+            Model::BrushArray brushes;
+            for (size_t i = 0; i < 300; ++i) {
+                const Vec3 min(static_cast<FloatType>(i) * 0.1, -static_cast<FloatType>(i) * 64.0, 4000.125);
+                StringStream textureName;
+                textureName << "tex" << i;
+                
+                Model::Brush* brush = builder.createCuboid(BBox3(min, min + Vec3(32.0, 16.0, 8.25)), textureName.str());
+                Model::BrushFace* face = brush->faces().front();
+                face->setXOffset(static_cast<float>(i) / 3.0f);
+                face->setRotation(-22.5f);
+                face->setSurfaceContents(static_cast<int>(i));
+                face->setSurfaceFlags(-1);
+                face->setSurfaceValue(1e7f);
+                map.defaultLayer()->addChild(brush);
+                brushes.push_back(brush);
+            }
+            
+            FILE* file = std::tmpfile();
+            ASSERT_TRUE(file != NULL);
+            
+            NodeWriter writer(&map, file);
+            writer.writeMap();
+            const String result = readFile(file);
+            std::fclose(file);
+            
+            StringStream expected;
+            expected << "// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+            size_t line = 4;
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                ASSERT_EQ(line + 1, brushes[i]->lineNumber());
+                expected << "// brush " << i << "\n{\n";
+                const Model::BrushFaceArray& faces = brushes[i]->faces();
+                for (const Model::BrushFace* face : faces)
+                    expected << formatQuake2Face(face);
+                expected << "}\n";
+                line += 3 + faces.size();
+            }
+            expected << "}\n";
+            
+            ASSERT_EQ(expected.str(), result);
+        }
     }
 }
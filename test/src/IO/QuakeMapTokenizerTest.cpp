@@ -0,0 +1,312 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "StringUtils.h"
+#include "IO/StandardMapParser.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        typedef QuakeMapTokenizer::Token Token;
+
+        TEST(QuakeMapTokenizerTest, numbers) {
+            const String testString("( 1 -2 +3 2.5 -.5 1e3 1.5e-2 ) 1.5x - 3)");
+            QuakeMapTokenizer tokenizer(testString);
+
+            ASSERT_EQ(QuakeMapToken::OParenthesis, tokenizer.nextToken().type());
+
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(1, token.toInteger<int>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(-2, token.toInteger<int>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(3, token.toInteger<int>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Decimal, token.type());
+            ASSERT_DOUBLE_EQ(2.5, token.toFloat<double>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Decimal, token.type());
+            ASSERT_DOUBLE_EQ(-0.5, token.toFloat<double>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Decimal, token.type());
+            ASSERT_DOUBLE_EQ(1000.0, token.toFloat<double>());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Decimal, token.type());
+            ASSERT_DOUBLE_EQ(0.015, token.toFloat<double>());
+
+            ASSERT_EQ(QuakeMapToken::CParenthesis, tokenizer.nextToken().type());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String("1.5x"), token.data());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(String("-"), token.data());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Integer, token.type());
+            ASSERT_EQ(String("3"), token.data());
+
+            ASSERT_EQ(QuakeMapToken::CParenthesis, tokenizer.nextToken().type());
+            ASSERT_EQ(QuakeMapToken::Eof, tokenizer.nextToken().type());
+        }
+
+        TEST(QuakeMapTokenizerTest, numberConversionMatchesCLibrary) {
+            const char* numbers[] = {
+                "0", "-0", "1", "-1", "0.1", "0.2", "0.3", "-123.456", "3.14159265358979", "3.141592653589793238",
+                "1e22", "1e23", "1e-22", "1.5e-30", "100000000000000000000", "0.000000000000000000000000001",
+                ".5", "5.", "12345678901234567890", "1E5", "1e", "+7", "4096.125", "-0.000244140625"
+            };
+
+            for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+                const String number(numbers[i]);
+                const Token token(QuakeMapToken::Decimal, number.c_str(), number.c_str() + number.size(), 0, 1, 1);
+                ASSERT_EQ(std::atof(numbers[i]), token.toFloat<double>()) << number;
+                ASSERT_EQ(static_cast<float>(std::atof(numbers[i])), token.toFloat<float>()) << number;
+                if (number.size() < 10) {
+                    ASSERT_EQ(std::atoi(numbers[i]), token.toInteger<int>()) << number;
+                }
+            }
+        }
+
+        TEST(QuakeMapTokenizerTest, quotedStrings) {
+            const String testString("\"classname\" \"a \\\"quoted\\\" value\\\\\" \"\"");
+            QuakeMapTokenizer tokenizer(testString);
+
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String("classname"), token.data());
+            ASSERT_EQ(1u, token.column());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String("a \\\"quoted\\\" value\\\\"), token.data());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String(""), token.data());
+
+            ASSERT_EQ(QuakeMapToken::Eof, tokenizer.nextToken().type());
+        }
+
+        TEST(QuakeMapTokenizerTest, unterminatedQuotedString) {
+            const String testString("\"classname");
+            QuakeMapTokenizer tokenizer(testString);
+            ASSERT_THROW(tokenizer.nextToken(), ParserException);
+        }
+
+        TEST(QuakeMapTokenizerTest, commentsAndLines) {
+            const String testString("// a comment which is longer than a few words { ( }\r\n{\n  /// key 1\n\t}\n");
+            QuakeMapTokenizer tokenizer(testString);
+
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::OBrace, token.type());
+            ASSERT_EQ(2u, token.line());
+            ASSERT_EQ(1u, token.column());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::Comment, token.type());
+            ASSERT_EQ(3u, token.line());
+            ASSERT_EQ(3u, token.column());
+
+            tokenizer.setSkipEol(false);
+            ASSERT_EQ(QuakeMapToken::String, tokenizer.nextToken().type());
+            ASSERT_EQ(QuakeMapToken::Integer, tokenizer.nextToken().type());
+            ASSERT_EQ(QuakeMapToken::Eol, tokenizer.nextToken().type());
+            tokenizer.setSkipEol(true);
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::CBrace, token.type());
+            ASSERT_EQ(4u, token.line());
+            ASSERT_EQ(2u, token.column());
+
+            ASSERT_EQ(QuakeMapToken::Eof, tokenizer.nextToken().type());
+        }
+
+        TEST(QuakeMapTokenizerTest, peekAndNext) {
+            const String testString("{ 1\n2 }");
+            QuakeMapTokenizer tokenizer(testString);
+
+            Token peeked = tokenizer.peekToken();
+            ASSERT_EQ(QuakeMapToken::OBrace, peeked.type());
+            ASSERT_EQ(QuakeMapToken::OBrace, tokenizer.peekToken().type());
+
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(peeked.begin(), token.begin());
+            ASSERT_EQ(QuakeMapToken::Integer, tokenizer.peekToken().type());
+
+            const TokenizerState::Snapshot snapshot = tokenizer.snapshot();
+            ASSERT_EQ(String("1"), tokenizer.nextToken().data());
+
+            token = tokenizer.peekToken();
+            ASSERT_EQ(String("2"), token.data());
+            ASSERT_EQ(2u, token.line());
+
+            tokenizer.restore(snapshot);
+            ASSERT_EQ(String("1"), tokenizer.peekToken().data());
+            ASSERT_EQ(String("1"), tokenizer.nextToken().data());
+
+            token = tokenizer.nextToken();
+            ASSERT_EQ(String("2"), token.data());
+            ASSERT_EQ(2u, token.line());
+            ASSERT_EQ(1u, token.column());
+
+            ASSERT_EQ(QuakeMapToken::CBrace, tokenizer.nextToken().type());
+            ASSERT_EQ(QuakeMapToken::Eof, tokenizer.peekToken().type());
+
+            tokenizer.reset();
+            ASSERT_EQ(QuakeMapToken::OBrace, tokenizer.nextToken().type());
+        }
+
+        TEST(QuakeMapTokenizerTest, textureNames) {
+            const String testString("( 0 0 0 ) {water +0sky -1 0");
+            QuakeMapTokenizer tokenizer(testString);
+
+            for (size_t i = 0; i < 5; ++i)
+                tokenizer.nextToken();
+            ASSERT_EQ(String("{water"), tokenizer.readAnyString(QuakeMapTokenizer::Whitespace()));
+
+            Token token = tokenizer.nextToken();
+            ASSERT_EQ(QuakeMapToken::String, token.type());
+            ASSERT_EQ(String("+0sky"), token.data());
+            ASSERT_EQ(QuakeMapToken::Integer, tokenizer.nextToken().type());
+            ASSERT_EQ(QuakeMapToken::Integer, tokenizer.nextToken().type());
+        }
+
+        static String makeBrushMap(const size_t brushCount) {
+            StringStream str;
+            str << "// Game: Quake\n// Format: Standard\n";
+            str << "{\n\"classname\" \"worldspawn\"\n\"wad\" \"quake.wad\"\n";
+            for (size_t i = 0; i < brushCount; ++i) {
+                const int x = static_cast<int>(i % 64) * 64 - 2048;
+                const int y = static_cast<int>(i / 64 % 64) * 64 - 2048;
+                const int z = static_cast<int>(i / 4096) * 64;
+                str << "// brush " << i << "\n{\n";
+                str << "( " << x << " " << y << " " << z << " ) ( " << x << " " << y + 1 << " " << z << " ) ( " << x << " " << y << " " << z + 1 << " ) rock1_2 0 0 0 1 1\n";
+                str << "( " << x << " " << y << " " << z << " ) ( " << x << " " << y << " " << z + 1 << " ) ( " << x + 1 << " " << y << " " << z << " ) rock1_2 16 -8 0 1 1\n";
+                str << "( " << x << " " << y << " " << z << " ) ( " << x + 1 << " " << y << " " << z << " ) ( " << x << " " << y + 1 << " " << z << " ) rock1_2 0 0 0 1 1\n";
+                str << "( " << x + 64 << " " << y + 64 << " " << z + 64 << " ) ( " << x + 64 << " " << y + 65 << " " << z + 64 << " ) ( " << x + 65 << " " << y + 64 << " " << z + 64 << " ) rock1_2 0 0 0 1 1\n";
+                str << "( " << x + 64 << " " << y + 64 << " " << z + 64 << " ) ( " << x + 65 << " " << y + 64 << " " << z + 64 << " ) ( " << x + 64 << " " << y + 64 << " " << z + 65 << " ) rock1_2 0 0 0 1 1\n";
+                str << "( " << x + 64 << " " << y + 64.5 << " " << z + 64 << " ) ( " << x + 64 << " " << y + 64.5 << " " << z + 65 << " ) ( " << x + 64.25 << " " << y + 64.5 << " " << z + 64 << " ) rock1_2 0.5 -0.25 22.5 0.5 -0.5\n";
+                str << "}\n";
+            }
+            str << "}\n";
+            return str.str();
+        }
+
+        TEST(QuakeMapTokenizerTest, brushMap) {
+            const size_t brushCount = 3;
+            const String map = makeBrushMap(brushCount);
+
+            // an entity with two key value pairs, and 6 faces with 21 tokens each per brush
+            size_t tokenCount = 0;
+            size_t decimalCount = 0;
+            std::vector<size_t> braceLines;
+
+            QuakeMapTokenizer tokenizer(map);
+            Token token = tokenizer.nextToken();
+            while (token.type() != QuakeMapToken::Eof) {
+                ++tokenCount;
+                if (token.type() == QuakeMapToken::Decimal)
+                    ++decimalCount;
+                if (token.type() == QuakeMapToken::OBrace)
+                    braceLines.push_back(token.line());
+                token = tokenizer.nextToken();
+            }
+
+            ASSERT_EQ(6u + brushCount * (2u + 6u * 21u), tokenCount);
+            ASSERT_EQ(brushCount * 9u, decimalCount);
+            ASSERT_EQ(brushCount + 1u, braceLines.size());
+            ASSERT_EQ(3u, braceLines[0]);
+            for (size_t i = 0; i < brushCount; ++i)
+                ASSERT_EQ(7u + 9u * i, braceLines[i + 1]);
+
+            // peeking before every token must not change the token sequence or the converted values
+            QuakeMapTokenizer nextTokenizer(map);
+            QuakeMapTokenizer peekTokenizer(map);
+            do {
+                const Token peeked = peekTokenizer.peekToken();
+                const Token next = peekTokenizer.nextToken();
+                token = nextTokenizer.nextToken();
+
+                ASSERT_EQ(token.type(), peeked.type());
+                ASSERT_EQ(token.type(), next.type());
+                ASSERT_EQ(token.data(), next.data());
+                ASSERT_EQ(token.line(), next.line());
+                ASSERT_EQ(token.column(), next.column());
+                if (token.hasType(QuakeMapToken::Integer | QuakeMapToken::Decimal)) {
+                    ASSERT_EQ(token.toFloat<double>(), next.toFloat<double>());
+                }
+            } while (token.type() != QuakeMapToken::Eof);
+        }
+
+        // prints the tokenizer throughput on a map with 50k brushes, about 22MB
+        TEST(QuakeMapTokenizerTest, DISABLED_benchmark) {
+            typedef std::chrono::high_resolution_clock Clock;
+
+            const String map = makeBrushMap(50000);
+            const double megabytes = static_cast<double>(map.size()) / (1024.0 * 1024.0);
+            const size_t runs = 5;
+
+            size_t tokenCount = 0;
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < runs; ++i) {
+                QuakeMapTokenizer tokenizer(map);
+                while (tokenizer.nextToken().type() != QuakeMapToken::Eof)
+                    ++tokenCount;
+            }
+            const double tokenize = std::chrono::duration<double>(Clock::now() - start).count() / runs;
+
+            double sum = 0.0;
+            start = Clock::now();
+            for (size_t i = 0; i < runs; ++i) {
+                QuakeMapTokenizer tokenizer(map);
+                Token token = tokenizer.peekToken();
+                while (token.type() != QuakeMapToken::Eof) {
+                    tokenizer.nextToken();
+                    if (token.hasType(QuakeMapToken::Integer | QuakeMapToken::Decimal))
+                        sum += token.toFloat<double>();
+                    token = tokenizer.peekToken();
+                }
+            }
+            const double convert = std::chrono::duration<double>(Clock::now() - start).count() / runs;
+
+            std::cout << "Tokenizing " << megabytes << " MB (" << tokenCount / runs << " tokens, sum " << sum / runs << "):" << std::endl;
+            std::cout << "  next:                   " << megabytes / tokenize << " MB/s" << std::endl;
+            std::cout << "  peek, next and convert: " << megabytes / convert << " MB/s" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "IO/DiskIO.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/FileMatcher.h"
+#include "IO/IdMipTextureReader.h"
+#include "IO/Path.h"
+#include "IO/TextureCache.h"
+#include "IO/TextureCollectionLoader.h"
+#include "IO/TextureReader.h"
+#include "IO/WadFileSystem.h"
+
+#include <wx/filefn.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST(TextureCacheTest, readWrittenCollection) {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("data/palette.lmp"));
+            
+            TextureReader::TextureNameStrategy nameStrategy;
+            IdMipTextureReader textureLoader(nameStrategy, palette);
+            
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("data/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath);
+            
+            MappedFile::List files;
+            for (const Path& path : wadFS.findItems(Path(""), FileExtensionMatcher("D")))
+                files.push_back(wadFS.openFile(path));
+            
+            const Path cacheDirectory = Disk::getCurrentWorkingDir() + Path("texturecachetest");
+            const TextureCache cache(cacheDirectory, "idmip");
+            ASSERT_TRUE(cache.readTextureCollection(wadPath, files) == NULL);
+            
+            const Assets::TextureCollection* expected = TextureCollectionLoader::readTextureCollection(wadPath, files, textureLoader);
+            
+            // mip textures are decoded lazily, and they are not decoded just to be cached
+            cache.writeTextureCollection(wadPath, files, *expected);
+            ASSERT_TRUE(cache.readTextureCollection(wadPath, files) == NULL);
+            for (const Assets::Texture* texture : expected->textures())
+                ASSERT_FALSE(texture->decoded());
+            
+            for (const Assets::Texture* texture : expected->textures())
+                texture->buffers();
+            cache.writeTextureCollection(wadPath, files, *expected);
+            
+            const Assets::TextureCollection* cached = cache.readTextureCollection(wadPath, files);
+            ASSERT_TRUE(cached != NULL);
+            ASSERT_EQ(wadPath, cached->path());
+            
+            const Assets::TextureList& expectedTextures = expected->textures();
+            const Assets::TextureList& cachedTextures = cached->textures();
+            ASSERT_EQ(expectedTextures.size(), cachedTextures.size());
+            for (size_t i = 0; i < expectedTextures.size(); ++i) {
+                ASSERT_EQ(expectedTextures[i]->name(), cachedTextures[i]->name());
+                ASSERT_EQ(expectedTextures[i]->width(), cachedTextures[i]->width());
+                ASSERT_EQ(expectedTextures[i]->height(), cachedTextures[i]->height());
+                ASSERT_EQ(expectedTextures[i]->averageColor(), cachedTextures[i]->averageColor());
+                
+                const Assets::TextureBuffer::Array& expectedBuffers = expectedTextures[i]->buffers();
+                const Assets::TextureBuffer::Array& cachedBuffers = cachedTextures[i]->buffers();
+                ASSERT_EQ(expectedBuffers.size(), cachedBuffers.size());
+                for (size_t j = 0; j < expectedBuffers.size(); ++j) {
+                    ASSERT_EQ(expectedBuffers[j].size(), cachedBuffers[j].size());
+                    ASSERT_EQ(0, memcmp(expectedBuffers[j].ptr(), cachedBuffers[j].ptr(), expectedBuffers[j].size()));
+                }
+            }
+            
+            // the cached collection must not be used if the textures have changed or if it was cached for another format
+            files.pop_back();
+            ASSERT_TRUE(cache.readTextureCollection(wadPath, files) == NULL);
+            files.push_back(wadFS.openFile(Path("cr8_czg_1.D")));
+            ASSERT_TRUE(cache.readTextureCollection(wadPath, files) == NULL);
+            
+            const TextureCache otherCache(cacheDirectory, "hlmip");
+            ASSERT_TRUE(otherCache.readTextureCollection(wadPath, files) == NULL);
+            
+            delete cached;
+            delete expected;
+            
+            Disk::deleteFiles(cacheDirectory, FileExtensionMatcher("tbtc"));
+            ::wxRmdir(cacheDirectory.asString());
+        }
+        
+        TEST(TextureCacheTest, hash) {
+            const String str1 = "some content";
+            const String str2 = "some contenu";
+            
+            ASSERT_EQ(TextureCache::hash(str1.data(), str1.data() + str1.size()), TextureCache::hash(str1.data(), str1.data() + str1.size()));
+            ASSERT_NE(TextureCache::hash(str1.data(), str1.data() + str1.size()), TextureCache::hash(str2.data(), str2.data() + str2.size()));
+            ASSERT_EQ(14695981039346656037ULL, TextureCache::hash(str1.data(), str1.data()));
+        }
+    }
+}
@@ -632,6 +632,115 @@ namespace TrenchBroom {
             delete world;
         }
         
+        inline void assertEqualNodes(const Model::Node* expected, const Model::Node* actual) {
+            ASSERT_EQ(expected->name(), actual->name());
+            ASSERT_EQ(expected->lineNumber(), actual->lineNumber());
+            ASSERT_EQ(expected->lineCount(), actual->lineCount());
+            ASSERT_EQ(expected->bounds(), actual->bounds());
+            ASSERT_EQ(expected->childCount(), actual->childCount());
+            
+            const Model::NodeArray& expectedChildren = expected->children();
+            const Model::NodeArray& actualChildren = actual->children();
+            for (size_t i = 0; i < expectedChildren.size(); ++i)
+                assertEqualNodes(expectedChildren[i], actualChildren[i]);
+        }
+        
+        TEST(WorldReaderTest, parseInParallel) {
+            StringStream str;
+            str << "{\n"
+                << "\"classname\" \"worldspawn\"\n"
+                << "\"message\" \"yay\"\n";
+            // enough brushes to be split into several chunks
+            for (size_t i = 0; i < 600; ++i) {
+                const int x = static_cast<int>(i) * 32;
+                str << "// brush " << i << "\n"
+                    << "{\n"
+                    << "( " << x      << " 0 0 ) ( " << x      << " 1 0 ) ( " << x      << " 0 1 ) {fence 0 0 0 1 1\n"
+                    << "( " << x + 16 << " 0 0 ) ( " << x + 16 << " 0 1 ) ( " << x + 16 << " 1 0 ) none 0 0 0 1 1\n"
+                    << "( " << x      << " 0 0 ) ( " << x      << " 0 1 ) ( " << x + 1  << " 0 0 ) none 0 0 0 1 1\n"
+                    << "( " << x      << " 16 0 ) ( " << x + 1 << " 16 0 ) ( " << x     << " 16 1 ) none 0 0 0 1 1\n"
+                    << "( " << x      << " 0 0 ) ( " << x + 1  << " 0 0 ) ( " << x      << " 1 0 ) none 0 0 0 1 1\n"
+                    << "( " << x      << " 0 16 ) ( " << x     << " 1 16 ) ( " << x + 1 << " 0 16 ) none 0 0 0 1 1\n"
+                    << "}\n";
+            }
+            str << "}\n"
+                << "{\n"
+                << "\"classname\" \"func_group\"\n"
+                << "\"_tb_type\" \"_tb_layer\"\n"
+                << "\"_tb_name\" \"My Layer\"\n"
+                << "\"_tb_id\" \"1\"\n"
+                << "{\n"
+                << "( -800 288 1024 ) ( -736 288 1024 ) ( -736 224 1024 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "( -800 288 1024 ) ( -800 224 1024 ) ( -800 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "( -736 224 1024 ) ( -736 288 1024 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "( -736 288 1024 ) ( -800 288 1024 ) ( -800 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "( -800 224 1024 ) ( -736 224 1024 ) ( -736 224 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "( -800 224 576 ) ( -736 224 576 ) ( -736 288 576 ) rtz/c_mf_v3c 56 -32 0 1 1\n"
+                << "}\n"
+                << "}\n"
+                << "{\n"
+                << "\"classname\" \"info_player_start\"\n"
+                << "\"_tb_layer\" \"1\"\n"
+                << "\"origin\" \"1 22 -3\"\n"
+                << "}\n";
+            const String data = str.str();
+            BBox3 worldBounds(32768);
+            
+            IO::TestParserStatus status;
+            WorldReader sequentialReader(data, NULL);
+            Model::World* expected = sequentialReader.read(Model::MapFormat::Standard, worldBounds, status);
+            
+            WorldReader parallelReader(data, NULL);
+            parallelReader.setParallel(true);
+            Model::World* actual = parallelReader.read(Model::MapFormat::Standard, worldBounds, status);
+            
+            ASSERT_EQ(2u, actual->childCount());
+            ASSERT_EQ(600u, actual->children().front()->childCount());
+            ASSERT_EQ(2u, actual->children().back()->childCount());
+            ASSERT_STREQ("yay", actual->attribute("message").c_str());
+            
+            // every brush spans nine lines including its comment, and its position starts at its opening brace
+            const Model::NodeArray& brushes = actual->children().front()->children();
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                ASSERT_EQ(5u + 9u * i, brushes[i]->lineNumber());
+                ASSERT_EQ(7u, brushes[i]->lineCount());
+            }
+            
+            assertEqualNodes(expected, actual);
+            
+            delete actual;
+            delete expected;
+        }
+        
+        TEST(WorldReaderTest, parseInParallelFallsBackOnUnsplittableFile) {
+            // attributes after the brushes of an entity cannot be split
+            const String data("{\n"
+                              "\"classname\" \"worldspawn\"\n"
+                              "{\n"
+                              "( -0 -0 -16 ) ( -0 -0  -0 ) ( 64 -0 -16 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( -0 64 -16 ) ( -0 -0  -0 ) none 0 0 0 1 1\n"
+                              "( -0 -0 -16 ) ( 64 -0 -16 ) ( -0 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( -0 64  -0 ) ( 64 64 -16 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 64 -16 ) ( 64 -0  -0 ) none 0 0 0 1 1\n"
+                              "( 64 64  -0 ) ( 64 -0  -0 ) ( -0 64  -0 ) none 0 0 0 1 1\n"
+                              "}\n"
+                              "\"message\" \"yay\"\n"
+                              "}\n");
+            BBox3 worldBounds(8192);
+            
+            IO::TestParserStatus status;
+            WorldReader reader(data, NULL);
+            reader.setParallel(true);
+            
+            Model::World* world = reader.read(Model::MapFormat::Standard, worldBounds, status);
+            ASSERT_EQ(1u, world->childCount());
+            ASSERT_EQ(1u, world->children().front()->childCount());
+            ASSERT_EQ(3u, world->children().front()->children().front()->lineNumber());
+            ASSERT_EQ(7u, world->children().front()->children().front()->lineCount());
+            
+            delete world;
+        }
+        
         TEST(WorldReaderTest, parseMultipleClassnames) {
             // See https://github.com/kduske/TrenchBroom/issues/1485
             
@@ -0,0 +1,349 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Exceptions.h"
+#include "VecMath.h"
+#include "Model/AABBTree.h"
+#include "Model/Octree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        typedef AABBTree<double, int> Tree;
+        typedef std::map<int, BBox3d> BoxMap;
+
+        static const BBox3d WorldBounds(-8192.0, +8192.0);
+
+        static BBox3d randomBox(std::mt19937& random, const double range, const double maxSize) {
+            std::uniform_real_distribution<double> position(-range, range);
+            std::uniform_real_distribution<double> size(1.0, maxSize);
+
+            const Vec3d min(position(random), position(random), position(random));
+            return BBox3d(min, min + Vec3d(size(random), size(random), size(random)));
+        }
+
+        static Ray3d randomRay(std::mt19937& random, const double range) {
+            std::uniform_real_distribution<double> position(-range, range);
+            const Vec3d origin(position(random), position(random), position(random));
+            const Vec3d target(position(random), position(random), position(random));
+            return Ray3d(origin, (target - origin).normalized());
+        }
+
+        static std::vector<int> sorted(std::vector<int> objects) {
+            std::sort(std::begin(objects), std::end(objects));
+            return objects;
+        }
+
+        template <typename P>
+        static std::vector<int> bruteForce(const BoxMap& boxes, P predicate) {
+            std::vector<int> result;
+            for (const auto& entry : boxes) {
+                if (predicate(entry.second))
+                    result.push_back(entry.first);
+            }
+            return result;
+        }
+
+        static void assertQueriesMatch(const Tree& tree, const BoxMap& boxes, std::mt19937& random) {
+            ASSERT_EQ(boxes.size(), tree.size());
+
+            for (size_t i = 0; i < 20; ++i) {
+                const Ray3d ray = randomRay(random, 1024.0);
+                const BBox3d query = randomBox(random, 1024.0, 256.0);
+                const Vec3d point = query.center();
+
+                const std::vector<int> expectedRayHits = bruteForce(boxes, [&ray](const BBox3d& box) { return !Math::isnan(box.intersectWithRay(ray)); });
+                const std::vector<int> expectedBoxHits = bruteForce(boxes, [&query](const BBox3d& box) { return box.intersects(query); });
+                const std::vector<int> expectedPointHits = bruteForce(boxes, [&point](const BBox3d& box) { return box.contains(point); });
+
+                ASSERT_EQ(expectedRayHits, sorted(tree.findObjects(ray)));
+                ASSERT_EQ(expectedBoxHits, sorted(tree.findObjects(query)));
+                ASSERT_EQ(expectedPointHits, sorted(tree.findObjects(point)));
+            }
+        }
+
+        TEST(AABBTreeTest, insertObject) {
+            Tree tree(WorldBounds);
+
+            const int a = 1;
+            const BBox3d aBounds(1.0, 2.0);
+            tree.addObject(aBounds, a);
+            ASSERT_TRUE(tree.containsObject(aBounds, a));
+            ASSERT_EQ(1u, tree.size());
+        }
+
+        TEST(AABBTreeTest, insertTooLargeObject) {
+            Tree tree(BBox3d(-128.0, +128.0));
+            ASSERT_THROW(tree.addObject(BBox3d(-129.0, 2.0), 1), AABBTreeException);
+        }
+
+        TEST(AABBTreeTest, insertObjectTwice) {
+            Tree tree(WorldBounds);
+            tree.addObject(BBox3d(1.0, 2.0), 1);
+            ASSERT_THROW(tree.addObject(BBox3d(1.0, 2.0), 1), AABBTreeException);
+        }
+
+        TEST(AABBTreeTest, removeObject) {
+            Tree tree(WorldBounds);
+
+            const BBox3d aBounds(1.0, 2.0);
+            tree.addObject(aBounds, 1);
+            tree.removeObject(1);
+            ASSERT_FALSE(tree.containsObject(aBounds, 1));
+            ASSERT_TRUE(tree.empty());
+            ASSERT_TRUE(tree.findObjects(Vec3d(1.5, 1.5, 1.5)).empty());
+            ASSERT_THROW(tree.removeObject(1), AABBTreeException);
+        }
+
+        TEST(AABBTreeTest, updateObject) {
+            Tree tree(WorldBounds);
+
+            std::mt19937 random(1);
+            for (int i = 0; i < 1000; ++i)
+                tree.addObject(randomBox(random, 1024.0, 64.0), i);
+
+            const BBox3d newBounds(4096.0, 4100.0);
+            tree.updateObject(newBounds, 7);
+            ASSERT_TRUE(tree.containsObject(newBounds, 7));
+            ASSERT_EQ(std::vector<int>(1, 7), tree.findObjects(Vec3d(4098.0, 4098.0, 4098.0)));
+            ASSERT_THROW(tree.updateObject(newBounds, 1000), AABBTreeException);
+        }
+
+        TEST(AABBTreeTest, queriesMatchBruteForce) {
+            Tree tree(WorldBounds);
+            BoxMap boxes;
+
+            std::mt19937 random(2);
+            for (int i = 0; i < 3000; ++i) {
+                const BBox3d box = randomBox(random, 1024.0, 128.0);
+                tree.addObject(box, i);
+                boxes[i] = box;
+            }
+            assertQueriesMatch(tree, boxes, random);
+
+            // mix updates, removals and insertions so that the tree refits, has pending objects and is rebuilt
+            std::uniform_int_distribution<int> object(0, 2999);
+            for (int i = 0; i < 2000; ++i) {
+                const int o = object(random);
+                const BBox3d box = randomBox(random, 1024.0, 128.0);
+                if (boxes.count(o) == 0) {
+                    tree.addObject(box, o);
+                    boxes[o] = box;
+                } else if (i % 3 == 0) {
+                    tree.removeObject(o);
+                    boxes.erase(o);
+                } else {
+                    tree.updateObject(box, o);
+                    boxes[o] = box;
+                }
+
+                if (i % 250 == 0)
+                    assertQueriesMatch(tree, boxes, random);
+            }
+            assertQueriesMatch(tree, boxes, random);
+        }
+
+        TEST(AABBTreeTest, findNearest) {
+            Tree tree(WorldBounds);
+            BoxMap boxes;
+
+            std::mt19937 random(3);
+            for (int i = 0; i < 3000; ++i) {
+                const BBox3d box = randomBox(random, 1024.0, 64.0);
+                tree.addObject(box, i);
+                boxes[i] = box;
+            }
+
+            const auto intersect = [&boxes](const Ray3d& ray, const int o) { return boxes[o].intersectWithRay(ray); };
+            for (size_t i = 0; i < 100; ++i) {
+                const Ray3d ray = randomRay(random, 1024.0);
+
+                bool expectedFound = false;
+                double expectedDistance = std::numeric_limits<double>::max();
+                for (const auto& entry : boxes) {
+                    const double distance = entry.second.intersectWithRay(ray);
+                    if (!Math::isnan(distance) && distance < expectedDistance) {
+                        expectedDistance = distance;
+                        expectedFound = true;
+                    }
+                }
+
+                int object = -1;
+                double distance = 0.0;
+                const bool found = tree.findNearest(ray, [&](const int o) { return intersect(ray, o); }, object, distance);
+                ASSERT_EQ(expectedFound, found);
+                if (found) {
+                    ASSERT_DOUBLE_EQ(expectedDistance, distance);
+                    ASSERT_DOUBLE_EQ(distance, boxes[object].intersectWithRay(ray));
+                }
+            }
+        }
+
+        TEST(AABBTreeTest, findObjectsNearRay) {
+            Tree tree(WorldBounds);
+            std::map<int, Vec3d> points;
+
+            std::mt19937 random(5);
+            std::uniform_real_distribution<double> position(-1024.0, 1024.0);
+            for (int i = 0; i < 3000; ++i) {
+                const Vec3d point(position(random), position(random), position(random));
+                tree.addObject(BBox3d(point, point), i);
+                points[i] = point;
+            }
+
+            // the radius grows with the distance along the x axis, like the size of a handle in a perspective view
+            const auto radius = [](const Vec3d& point) { return 4.0 + std::abs(point.x()) / 64.0; };
+            const auto maxRadius = [](const BBox3d& box) { return 4.0 + std::max(std::abs(box.min.x()), std::abs(box.max.x())) / 64.0; };
+
+            for (size_t i = 0; i < 20; ++i) {
+                const Ray3d ray = randomRay(random, 1024.0);
+
+                std::vector<int> expected;
+                for (const auto& entry : points) {
+                    if (!Math::isnan(ray.intersectWithSphere(entry.second, radius(entry.second))))
+                        expected.push_back(entry.first);
+                }
+
+                const std::vector<int> candidates = tree.findObjectsNearRay(ray, maxRadius);
+                for (const int o : expected)
+                    ASSERT_TRUE(std::find(std::begin(candidates), std::end(candidates), o) != std::end(candidates));
+                ASSERT_LT(candidates.size(), points.size() / 10);
+            }
+        }
+
+        TEST(AABBTreeTest, findObjectsInFrustum) {
+            Tree tree(WorldBounds);
+            tree.addObject(BBox3d(Vec3d(-1.0, -1.0, -1.0), Vec3d(1.0, 1.0, 1.0)), 1);
+            tree.addObject(BBox3d(Vec3d(10.0, 10.0, 10.0), Vec3d(12.0, 12.0, 12.0)), 2);
+            tree.addObject(BBox3d(Vec3d(4.0, -1.0, -1.0), Vec3d(6.0, 1.0, 1.0)), 3);
+
+            // an axis aligned box from -5 to +5 with outward facing planes
+            Plane3d::List planes;
+            planes.push_back(Plane3d(5.0, Vec3d::PosX));
+            planes.push_back(Plane3d(5.0, Vec3d::NegX));
+            planes.push_back(Plane3d(5.0, Vec3d::PosY));
+            planes.push_back(Plane3d(5.0, Vec3d::NegY));
+            planes.push_back(Plane3d(5.0, Vec3d::PosZ));
+            planes.push_back(Plane3d(5.0, Vec3d::NegZ));
+
+            std::vector<int> expected;
+            expected.push_back(1);
+            expected.push_back(3);
+            ASSERT_EQ(expected, sorted(tree.findObjects(planes)));
+        }
+
+        typedef std::chrono::high_resolution_clock Clock;
+
+        static double elapsed(const Clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        // prints the insert, update and pick times of the octree and the AABB tree for a layer with 100k objects
+        TEST(AABBTreeTest, DISABLED_benchmarkAgainstOctree) {
+            const size_t objectCount = 100000;
+            const size_t updateCount = 10000;
+            const size_t rayCount = 1000;
+
+            std::mt19937 random(4);
+            std::vector<BBox3d> boxes;
+            for (size_t i = 0; i < objectCount; ++i)
+                boxes.push_back(randomBox(random, 4096.0, 128.0));
+
+            std::vector<std::pair<int, BBox3d> > updates;
+            std::uniform_int_distribution<int> object(0, static_cast<int>(objectCount) - 1);
+            for (size_t i = 0; i < updateCount; ++i) {
+                const int o = object(random);
+                updates.push_back(std::make_pair(o, boxes[static_cast<size_t>(o)].translated(Vec3d(16.0, 0.0, 0.0))));
+            }
+
+            std::vector<Ray3d> rays;
+            for (size_t i = 0; i < rayCount; ++i)
+                rays.push_back(randomRay(random, 4096.0));
+
+            Octree<double, int> octree(WorldBounds, 64.0);
+            Tree tree(WorldBounds);
+
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < objectCount; ++i)
+                octree.addObject(boxes[i], static_cast<int>(i));
+            const double octreeInsert = elapsed(start);
+
+            // the first query builds the tree
+            start = Clock::now();
+            for (size_t i = 0; i < objectCount; ++i)
+                tree.addObject(boxes[i], static_cast<int>(i));
+            tree.findObjects(Vec3d::Null);
+            const double treeInsert = elapsed(start);
+
+            start = Clock::now();
+            for (const auto& update : updates)
+                octree.updateObject(update.second, update.first);
+            const double octreeUpdate = elapsed(start);
+
+            start = Clock::now();
+            for (const auto& update : updates)
+                tree.updateObject(update.second, update.first);
+            tree.findObjects(Vec3d::Null);
+            const double treeUpdate = elapsed(start);
+
+            size_t octreeCandidates = 0;
+            start = Clock::now();
+            for (const Ray3d& ray : rays)
+                octreeCandidates += octree.findObjects(ray).size();
+            const double octreePick = elapsed(start);
+
+            size_t treeCandidates = 0;
+            start = Clock::now();
+            for (const Ray3d& ray : rays)
+                treeCandidates += tree.findObjects(ray).size();
+            const double treePick = elapsed(start);
+
+            std::map<int, BBox3d> current;
+            for (size_t i = 0; i < objectCount; ++i)
+                current[static_cast<int>(i)] = boxes[i];
+            for (const auto& update : updates)
+                current[update.first] = update.second;
+
+            size_t hits = 0;
+            start = Clock::now();
+            for (const Ray3d& ray : rays) {
+                int o;
+                double distance;
+                if (tree.findNearest(ray, [&](const int i) { return current[i].intersectWithRay(ray); }, o, distance))
+                    ++hits;
+            }
+            const double treeNearest = elapsed(start);
+
+            std::cout << "Octree vs. AABB tree with " << objectCount << " objects:" << std::endl;
+            std::cout << "  insert:                " << octreeInsert << "ms vs. " << treeInsert << "ms" << std::endl;
+            std::cout << "  " << updateCount << " updates:         " << octreeUpdate << "ms vs. " << treeUpdate << "ms" << std::endl;
+            std::cout << "  " << rayCount << " ray queries:      " << octreePick << "ms vs. " << treePick << "ms" << std::endl;
+            std::cout << "    candidates:          " << octreeCandidates << " vs. " << treeCandidates << std::endl;
+            std::cout << "  " << rayCount << " nearest queries:  " << treeNearest << "ms (" << hits << " hits)" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "CollectionUtils.h"
+#include "Model/AttributableNodeLinkIndex.h"
+#include "Model/Entity.h"
+#include "Model/EntityAttributes.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        TEST(AttributableNodeLinkIndexTest, findTargets) {
+            AttributableNodeLinkIndex index;
+            
+            Entity* entity1 = new Entity();
+            Entity* entity2 = new Entity();
+            
+            index.addAttribute(entity1, AttributeNames::Targetname, "door");
+            index.addAttribute(entity2, AttributeNames::Targetname, "door");
+            index.addAttribute(entity2, "message", "door");
+            
+            AttributableNodeList targets;
+            index.findTargets("notfound", targets);
+            ASSERT_TRUE(targets.empty());
+            
+            index.findTargets("door", targets);
+            ASSERT_EQ(2u, targets.size());
+            ASSERT_TRUE(VectorUtils::contains(targets, entity1));
+            ASSERT_TRUE(VectorUtils::contains(targets, entity2));
+            
+            index.removeAttribute(entity1, AttributeNames::Targetname, "door");
+            
+            targets.clear();
+            index.findTargets("door", targets);
+            ASSERT_EQ(1u, targets.size());
+            ASSERT_EQ(entity2, targets.front());
+            
+            delete entity1;
+            delete entity2;
+        }
+        
+        TEST(AttributableNodeLinkIndexTest, findSourcesWithNumberedAttributes) {
+            AttributableNodeLinkIndex index;
+            
+            Entity* entity1 = new Entity();
+            Entity* entity2 = new Entity();
+            
+            index.addAttribute(entity1, AttributeNames::Target, "door");
+            index.addAttribute(entity1, AttributeNames::Target + "2", "door");
+            index.addAttribute(entity2, AttributeNames::Killtarget + "1", "door");
+            
+            AttributableNodeList sources;
+            index.findLinkSources("door", sources);
+            ASSERT_EQ(1u, sources.size());
+            ASSERT_EQ(entity1, sources.front());
+            
+            sources.clear();
+            index.findKillSources("door", sources);
+            ASSERT_EQ(1u, sources.size());
+            ASSERT_EQ(entity2, sources.front());
+            
+            // the node is still a source because of its other target attribute
+            index.removeAttribute(entity1, AttributeNames::Target, "door");
+            
+            sources.clear();
+            index.findLinkSources("door", sources);
+            ASSERT_EQ(1u, sources.size());
+            ASSERT_EQ(entity1, sources.front());
+            
+            index.removeAttribute(entity1, AttributeNames::Target + "2", "door");
+            
+            sources.clear();
+            index.findLinkSources("door", sources);
+            ASSERT_TRUE(sources.empty());
+            
+            delete entity1;
+            delete entity2;
+        }
+    }
+}
@@ -2129,6 +2129,35 @@ namespace TrenchBroom {
             ASSERT_FALSE(result.empty());
         }
         
+        TEST(BrushTest, subtractFromBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            
+            BrushBuilder builder(&world, worldBounds);
+            Brush* overlapping = builder.createCuboid(BBox3(Vec3(-32.0, -16.0, -32.0), Vec3(32.0, 16.0, 32.0)), "minuend");
+            Brush* touching    = builder.createCuboid(BBox3(Vec3( 16.0, -16.0, -32.0), Vec3(48.0, 16.0,  0.0)), "minuend");
+            Brush* disjoint    = builder.createCuboid(BBox3(Vec3(256.0, 256.0, 256.0), Vec3(288.0, 288.0, 288.0)), "minuend");
+            Brush* subtrahend  = builder.createCuboid(BBox3(Vec3(-16.0, -32.0, -64.0), Vec3(16.0, 32.0,  0.0)), "subtrahend");
+            
+            BrushList minuends;
+            minuends.push_back(overlapping);
+            minuends.push_back(touching);
+            minuends.push_back(disjoint);
+            
+            const std::vector<BrushList> result = Brush::subtractFromBrushes(minuends, world, worldBounds, "default", subtrahend);
+            ASSERT_EQ(3u, result.size());
+            
+            const BrushList expected = overlapping->subtract(world, worldBounds, "default", subtrahend);
+            ASSERT_EQ(expected.size(), result[0].size());
+            ASSERT_TRUE(result[1].empty());
+            ASSERT_TRUE(result[2].empty());
+            
+            VectorUtils::deleteAll(expected);
+            VectorUtils::deleteAll(result[0]);
+            VectorUtils::clearAndDelete(minuends);
+            delete subtrahend;
+        }
+        
         TEST(BrushTest, testAlmostDegenerateBrush) {
             // https://github.com/kduske/TrenchBroom/issues/1194
             const String data("{\n"
@@ -2578,5 +2607,117 @@ namespace TrenchBroom {
                 }
             }
         }
+        
+        static void assertTransformedGeometryMatchesRebuild(const Mat4x4& transformation) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            Vec3::List points;
+            points.push_back(Vec3(-32.0, -16.0,  -8.0));
+            points.push_back(Vec3( 40.0, -20.0,  -8.0));
+            points.push_back(Vec3(  8.0,  48.0,  -8.0));
+            points.push_back(Vec3(-24.0,  24.0,  -8.0));
+            points.push_back(Vec3(  0.0,   0.0,  56.0));
+            points.push_back(Vec3( 16.0,   8.0,  40.0));
+            
+            Brush* brush = builder.createBrush(points, "asdf");
+            brush->transform(transformation, false, worldBounds);
+            
+            // cloning a brush builds its geometry from the face planes
+            Brush* rebuilt = static_cast<Brush*>(brush->clone(worldBounds));
+            ASSERT_EQ(rebuilt->vertexCount(), brush->vertexCount());
+            ASSERT_EQ(rebuilt->edgeCount(), brush->edgeCount());
+            ASSERT_EQ(rebuilt->faceCount(), brush->faceCount());
+            
+            for (const BrushVertex* vertex : rebuilt->vertices())
+                ASSERT_TRUE(brush->hasVertex(vertex->position()));
+            
+            for (const BrushFace* face : brush->faces()) {
+                ASSERT_TRUE(face->geometry() != NULL);
+                ASSERT_EQ(face, face->geometry()->payload());
+                ASSERT_GT(face->boundary().normal.dot(face->geometry()->normal()), 0.99);
+            }
+            
+            delete rebuilt;
+            delete brush;
+        }
+        
+        TEST(BrushTest, transformGeometry) {
+            assertTransformedGeometryMatchesRebuild(translationMatrix(Vec3(16.0, -32.0, 8.5)));
+            assertTransformedGeometryMatchesRebuild(Mat4x4::Rot90ZCW);
+            assertTransformedGeometryMatchesRebuild(rotationMatrix(Vec3(1.0, 2.0, 3.0).normalized(), Math::radians(33.0)));
+            assertTransformedGeometryMatchesRebuild(translationMatrix(Vec3(64.0, 0.0, 0.0)) * rotationMatrix(Vec3::PosZ, Math::radians(15.0)));
+            assertTransformedGeometryMatchesRebuild(Mat4x4::MirX);
+            assertTransformedGeometryMatchesRebuild(Mat4x4::MirZ * Mat4x4::Rot90XCCW);
+            assertTransformedGeometryMatchesRebuild(scalingMatrix(Vec3(2.0, 2.0, 2.0)));
+            
+            // these are not handled by transforming the geometry directly
+            assertTransformedGeometryMatchesRebuild(scalingMatrix(Vec3(0.5, 0.5, 0.5)));
+            assertTransformedGeometryMatchesRebuild(scalingMatrix(Vec3(1.0, 2.0, 3.0)));
+        }
+
+        TEST(BrushTest, transformBrushes) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            BrushArray brushes;
+            BrushArray expected;
+            for (size_t x = 0; x < 8; ++x) {
+                for (size_t y = 0; y < 8; ++y) {
+                    Brush* brush = builder.createCube(32.0, "asdf");
+                    brush->transform(translationMatrix(Vec3(64.0 * x, 64.0 * y, 0.0)), false, worldBounds);
+                    brushes.push_back(brush);
+                    expected.push_back(static_cast<Brush*>(brush->clone(worldBounds)));
+                }
+            }
+            
+            // non-uniform scaling requires the geometries to be rebuilt
+            const Mat4x4 transformation = scalingMatrix(Vec3(1.0, 1.5, 2.0)) * rotationMatrix(Vec3::PosZ, Math::radians(30.0));
+            for (Brush* brush : expected)
+                brush->transform(transformation, true, worldBounds);
+            Brush::transformBrushes(brushes, transformation, true, worldBounds);
+            
+            for (size_t i = 0; i < brushes.size(); ++i) {
+                ASSERT_EQ(expected[i]->bounds(), brushes[i]->bounds());
+                ASSERT_EQ(expected[i]->vertexCount(), brushes[i]->vertexCount());
+                for (const BrushVertex* vertex : expected[i]->vertices())
+                    ASSERT_TRUE(brushes[i]->hasVertex(vertex->position()));
+                
+                ASSERT_EQ(expected[i]->faceCount(), brushes[i]->faceCount());
+                for (size_t j = 0; j < brushes[i]->faceCount(); ++j) {
+                    const BrushFace* expectedFace = expected[i]->faces()[j];
+                    const BrushFace* face = brushes[i]->faces()[j];
+                    ASSERT_EQ(expectedFace->boundary(), face->boundary());
+                    ASSERT_FLOAT_EQ(expectedFace->xOffset(), face->xOffset());
+                    ASSERT_FLOAT_EQ(expectedFace->yOffset(), face->yOffset());
+                    ASSERT_FLOAT_EQ(expectedFace->rotation(), face->rotation());
+                }
+            }
+            
+            VectorUtils::clearAndDelete(expected);
+            VectorUtils::clearAndDelete(brushes);
+        }
+        
+        TEST(BrushTest, transformBrushesWithInvalidBrush) {
+            const BBox3 worldBounds(4096.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            BrushBuilder builder(&world, worldBounds);
+            
+            BrushArray brushes;
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(32.0, 32.0, 32.0)), "asdf"));
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(3000.0, 0.0, 0.0), Vec3(3032.0, 32.0, 32.0)), "asdf"));
+            brushes.push_back(builder.createCuboid(BBox3(Vec3(0.0, 64.0, 0.0), Vec3(32.0, 96.0, 32.0)), "asdf"));
+            
+            // the second brush ends up outside of the world bounds
+            ASSERT_THROW(Brush::transformBrushes(brushes, scalingMatrix(Vec3(2.0, 1.0, 1.0)), false, worldBounds), GeometryException);
+            
+            // the other brushes are transformed nevertheless
+            ASSERT_EQ(BBox3(Vec3(0.0,  0.0, 0.0), Vec3(64.0, 32.0, 32.0)), brushes[0]->bounds());
+            ASSERT_EQ(BBox3(Vec3(0.0, 64.0, 0.0), Vec3(64.0, 96.0, 32.0)), brushes[2]->bounds());
+            
+            VectorUtils::clearAndDelete(brushes);
+        }
     }
 }
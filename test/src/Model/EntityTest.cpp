@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Color.h"
+#include "Assets/EntityDefinition.h"
+#include "Assets/ModelDefinition.h"
+#include "IO/ELParser.h"
+#include "IO/Path.h"
+#include "Model/Entity.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static Assets::PointEntityDefinition* createDefinition(const String& modelExpression) {
+            const Assets::ModelDefinition modelDefinition(IO::ELParser::parse(modelExpression));
+            return new Assets::PointEntityDefinition("item_shells", Color(1.0f, 1.0f, 1.0f, 1.0f), BBox3(8.0), "", Assets::AttributeDefinitionArray(), modelDefinition);
+        }
+        
+        TEST(EntityTest, modelSpecificationFollowsAttributes) {
+            Assets::PointEntityDefinition* definition = createDefinition("{{ spawnflags == 1 -> 'maps/b_shell1.bsp', 'maps/b_shell0.bsp' }}");
+            
+            Entity* entity = new Entity();
+            entity->setDefinition(definition);
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell0.bsp")), entity->modelSpecification());
+            
+            entity->addOrUpdateAttribute("spawnflags", "1");
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell1.bsp")), entity->modelSpecification());
+            
+            entity->addOrUpdateAttribute("targetname", "shells");
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell1.bsp")), entity->modelSpecification());
+            
+            entity->addOrUpdateAttribute("spawnflags", "2");
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell0.bsp")), entity->modelSpecification());
+            
+            entity->addOrUpdateAttribute("spawnflags", "1");
+            entity->removeAttribute("spawnflags");
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell0.bsp")), entity->modelSpecification());
+            
+            delete entity;
+            delete definition;
+        }
+        
+        TEST(EntityTest, modelSpecificationFollowsDefinition) {
+            Assets::PointEntityDefinition* definition1 = createDefinition("'maps/b_shell0.bsp'");
+            Assets::PointEntityDefinition* definition2 = createDefinition("{ 'path': 'maps/b_shell1.bsp', 'skin': skin }");
+            
+            Entity* entity = new Entity();
+            entity->addOrUpdateAttribute("skin", "2");
+            
+            entity->setDefinition(definition1);
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell0.bsp")), entity->modelSpecification());
+            
+            entity->setDefinition(definition2);
+            ASSERT_EQ(Assets::ModelSpecification(IO::Path("maps/b_shell1.bsp"), 2), entity->modelSpecification());
+            
+            entity->setDefinition(NULL);
+            ASSERT_EQ(Assets::ModelSpecification(), entity->modelSpecification());
+            
+            delete entity;
+            delete definition1;
+            delete definition2;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Model/Entity.h"
+#include "Model/EntityAttributes.h"
+#include "Model/Issue.h"
+#include "Model/Layer.h"
+#include "Model/MapFormat.h"
+#include "Model/MissingClassnameIssueGenerator.h"
+#include "Model/World.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        TEST(WorldTest, validateAllIssues) {
+            const BBox3 worldBounds(8192.0);
+            World world(MapFormat::Standard, NULL, worldBounds);
+            world.registerIssueGenerator(new MissingClassnameIssueGenerator());
+            
+            Entity* entity1 = world.createEntity();
+            Entity* entity2 = world.createEntity();
+            entity2->addOrUpdateAttribute(AttributeNames::Classname, "light");
+            world.defaultLayer()->addChild(entity1);
+            world.defaultLayer()->addChild(entity2);
+            
+            world.validateAllIssues();
+            ASSERT_TRUE(entity1->issuesValid());
+            ASSERT_TRUE(entity2->issuesValid());
+            
+            const IssueGeneratorList& issueGenerators = world.registeredIssueGenerators();
+            ASSERT_EQ(1u, entity1->issues(issueGenerators).size());
+            ASSERT_TRUE(entity2->issues(issueGenerators).empty());
+            
+            entity1->addOrUpdateAttribute(AttributeNames::Classname, "info_null");
+            ASSERT_FALSE(entity1->issuesValid());
+            ASSERT_TRUE(entity2->issuesValid());
+            
+            world.validateAllIssues();
+            ASSERT_TRUE(entity1->issuesValid());
+            ASSERT_TRUE(entity1->issues(issueGenerators).empty());
+        }
+    }
+}
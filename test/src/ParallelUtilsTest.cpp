@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ParallelUtils.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom {
+    TEST(ParallelUtilsTest, parallelForCallsEveryIndexOnce) {
+        for (size_t count = 0; count < 100; ++count) {
+            std::vector<std::atomic<size_t> > calls(count);
+            for (std::atomic<size_t>& c : calls)
+                c = 0;
+            
+            ParallelUtils::parallelFor(count, [&calls](const size_t i) { ++calls[i]; });
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(1u, calls[i].load());
+        }
+    }
+    
+    TEST(ParallelUtilsTest, parallelForRethrowsException) {
+        std::atomic<size_t> callCount(0);
+        ASSERT_THROW(ParallelUtils::parallelFor(1000, [&callCount](const size_t i) {
+            ++callCount;
+            if (i == 10)
+                throw std::runtime_error("test");
+        }), std::runtime_error);
+        ASSERT_LT(0u, callCount.load());
+        
+        // the pool is still usable afterwards
+        std::atomic<size_t> sum(0);
+        ParallelUtils::parallelFor(100, [&sum](const size_t i) { sum += i; });
+        ASSERT_EQ(4950u, sum.load());
+    }
+    
+    TEST(ParallelUtilsTest, nestedParallelFor) {
+        std::atomic<size_t> sum(0);
+        ParallelUtils::parallelFor(16, [&sum](const size_t) {
+            ParallelUtils::parallelFor(100, [&sum](const size_t j) { sum += j; });
+        });
+        ASSERT_EQ(16u * 4950u, sum.load());
+    }
+    
+    TEST(ParallelUtilsTest, serialScopeRunsOnCallingThreadInOrder) {
+        const std::thread::id caller = std::this_thread::get_id();
+        std::vector<size_t> indices;
+        bool otherThread = false;
+        
+        {
+            ParallelUtils::SerialScope serial;
+            ParallelUtils::parallelFor(1000, [&](const size_t i) {
+                if (std::this_thread::get_id() != caller)
+                    otherThread = true;
+                indices.push_back(i);
+            });
+        }
+        
+        ASSERT_FALSE(otherThread);
+        ASSERT_EQ(1000u, indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            ASSERT_EQ(i, indices[i]);
+        ASSERT_FALSE(ParallelUtils::SerialScope::active());
+    }
+}
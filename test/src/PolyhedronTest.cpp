@@ -1386,6 +1386,40 @@ TEST(PolyhedronTest, removeVertexFromClippedCube) {
     ASSERT_TRUE(hasTriangleOf(p, p4, p6, p7)); // slanted
 }
 
+TEST(PolyhedronTest, moveVertexByRemovingAndAddingIt) {
+    const Vec3d p1(  0.0,   0.0,   0.0);
+    const Vec3d p2(  0.0,   0.0, +64.0);
+    const Vec3d p3(  0.0, +64.0,   0.0);
+    const Vec3d p4(  0.0, +64.0, +64.0);
+    const Vec3d p5(+64.0,   0.0,   0.0);
+    const Vec3d p6(+64.0,   0.0, +64.0);
+    const Vec3d p7(+64.0, +64.0,   0.0);
+    const Vec3d p8(+64.0, +64.0, +64.0);
+    const Vec3d p9(+32.0, +32.0, +96.0);
+    
+    Vec3d::List positions;
+    positions.push_back(p1);
+    positions.push_back(p2);
+    positions.push_back(p3);
+    positions.push_back(p4);
+    positions.push_back(p5);
+    positions.push_back(p6);
+    positions.push_back(p7);
+    positions.push_back(p8);
+    
+    Polyhedron3d p(positions);
+    p.removeVertex(p.findVertexByPosition(p8));
+    p.addPoint(p9);
+    
+    positions.back() = p9;
+    const Polyhedron3d expected(positions);
+    
+    ASSERT_EQ(expected.vertexCount(), p.vertexCount());
+    ASSERT_EQ(expected.edgeCount(), p.edgeCount());
+    ASSERT_EQ(expected.faceCount(), p.faceCount());
+    ASSERT_TRUE(p.hasVertices(positions));
+}
+
 class ClipCallback : public Polyhedron3d::Callback {
 private:
     typedef std::set<Face*> FaceSet;
@@ -2197,3 +2231,52 @@ bool hasPolygonOf(const Polyhedron3d& p, const Vec3d& p1, const Vec3d& p2, const
     points.push_back(p5);
     return p.hasFace(points);
 }
+
+static void assertTransformed(const Vec3d::List& points, const Mat4x4d& transformation) {
+    Polyhedron3d p(points);
+    p.transform(transformation);
+    
+    Vec3d::List transformedPoints;
+    for (const Vec3d& point : points)
+        transformedPoints.push_back(transformation * point);
+    const Polyhedron3d expected(transformedPoints);
+    
+    ASSERT_EQ(expected.vertexCount(), p.vertexCount());
+    ASSERT_EQ(expected.edgeCount(), p.edgeCount());
+    ASSERT_EQ(expected.faceCount(), p.faceCount());
+    ASSERT_TRUE(expected.bounds().min.equals(p.bounds().min));
+    ASSERT_TRUE(expected.bounds().max.equals(p.bounds().max));
+    
+    // the faces must have the same vertices in the same (counter clockwise) order
+    const Face* firstFace = expected.faces().front();
+    const Face* currentFace = firstFace;
+    do {
+        ASSERT_TRUE(p.hasFace(currentFace->vertexPositions()));
+        currentFace = currentFace->next();
+    } while (currentFace != firstFace);
+    
+    const Vertex* firstVertex = p.vertices().front();
+    const Vertex* currentVertex = firstVertex;
+    do {
+        ASSERT_EQ(currentVertex, currentVertex->leaving()->origin());
+        currentVertex = currentVertex->next();
+    } while (currentVertex != firstVertex);
+}
+
+TEST(PolyhedronTest, transform) {
+    Vec3d::List points;
+    points.push_back(Vec3d(-32.0, -16.0,  -8.0));
+    points.push_back(Vec3d( 40.0, -20.0,  -8.0));
+    points.push_back(Vec3d(  8.0,  48.0,  -8.0));
+    points.push_back(Vec3d(-24.0,  24.0,  -8.0));
+    points.push_back(Vec3d(  0.0,   0.0,  56.0));
+    points.push_back(Vec3d( 16.0,   8.0,  40.0));
+    
+    assertTransformed(points, translationMatrix(Vec3d(16.0, -32.0, 8.0)));
+    assertTransformed(points, Mat4x4d::Rot90ZCW);
+    assertTransformed(points, scalingMatrix(Vec3d(2.0, 2.0, 2.0)));
+    assertTransformed(points, scalingMatrix(Vec3d(1.0, 2.0, 3.0)));
+    assertTransformed(points, Mat4x4d::MirX);
+    assertTransformed(points, Mat4x4d::MirY * Mat4x4d::Rot90XCCW);
+    assertTransformed(points, scalingMatrix(Vec3d(-1.0, -1.0, -1.0)));
+}
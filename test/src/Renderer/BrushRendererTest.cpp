@@ -0,0 +1,313 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "CollectionUtils.h"
+#include "ParallelUtils.h"
+#include "GL/GLMock.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/MapFormat.h"
+#include "Model/World.h"
+#include "Renderer/BrushRenderer.h"
+#include "Renderer/FontManager.h"
+#include "Renderer/PerspectiveCamera.h"
+#include "Renderer/RenderBatch.h"
+#include "Renderer/RenderContext.h"
+#include "Renderer/ShaderManager.h"
+#include "Renderer/Vbo.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        typedef std::map<const Model::Brush*, size_t> RebuildCounts;
+        typedef std::vector<unsigned char> Buffer;
+        
+        /**
+         Provides all faces and edges and counts how often each brush is rebuilt. Brushes are rebuilt in
+         parallel and the renderer copies its filter, so the counts are shared and guarded by a mutex.
+         */
+        class CountingFilter : public BrushRenderer::Filter {
+        private:
+            std::mutex* m_mutex;
+            RebuildCounts* m_counts;
+        public:
+            CountingFilter(std::mutex& mutex, RebuildCounts& counts) :
+            m_mutex(&mutex),
+            m_counts(&counts) {}
+            
+            CountingFilter(const CountingFilter& other) :
+            Filter(),
+            m_mutex(other.m_mutex),
+            m_counts(other.m_counts) {}
+        private:
+            void doProvideFaces(const Model::Brush* brush, BrushRenderer::FaceAcceptor& faceAcceptor) const {
+                for (const Model::BrushFace* face : brush->faces())
+                    faceAcceptor.accept(face);
+            }
+            
+            void doProvideEdges(const Model::Brush* brush, BrushRenderer::EdgeAcceptor& edgeAcceptor) const {
+                for (const Model::BrushEdge* edge : brush->edges())
+                    edgeAcceptor.accept(edge);
+            }
+            
+            // called exactly once per rebuilt brush
+            bool doIsTransparent(const Model::Brush* brush) const {
+                std::lock_guard<std::mutex> lock(*m_mutex);
+                ++(*m_counts)[brush];
+                return false;
+            }
+        };
+        
+        /**
+         Records the data that is written to the vertex and index buffers, keyed by the buffer target.
+         */
+        class BufferCapture {
+        private:
+            typedef std::map<GLenum, Buffer> BufferMap;
+            BufferMap m_buffers;
+        public:
+            BufferCapture(GLMock& glMock) {
+                ON_CALL(glMock, BufferSubData(testing::_, testing::_, testing::_, testing::_)).WillByDefault(testing::Invoke(this, &BufferCapture::write));
+            }
+            
+            const Buffer& buffer(const GLenum target) {
+                return m_buffers[target];
+            }
+            
+            void clear() {
+                m_buffers.clear();
+            }
+        private:
+            void write(const GLenum target, const GLintptr offset, const GLsizeiptr size, const GLvoid* data) {
+                Buffer& buffer = m_buffers[target];
+                const size_t begin = static_cast<size_t>(offset);
+                const size_t end = begin + static_cast<size_t>(size);
+                if (buffer.size() < end)
+                    buffer.resize(end, 0);
+                std::memcpy(&buffer[begin], data, static_cast<size_t>(size));
+            }
+            
+            deleteCopyAndAssignment(BufferCapture)
+        };
+        
+        typedef std::chrono::high_resolution_clock Clock;
+        
+        static double elapsed(const Clock::time_point& start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        
+        // cuboids, wedges and pyramids, so that the faces have different numbers of vertices
+        static Model::BrushList createBrushes(const Model::BrushBuilder& builder, const size_t count) {
+            Model::BrushList brushes;
+            for (size_t i = 0; i < count; ++i) {
+                const Vec3 origin(static_cast<FloatType>(i % 16) * 64.0, static_cast<FloatType>(i / 16) * 64.0, 0.0);
+                
+                Vec3::List points;
+                points.push_back(origin);
+                points.push_back(origin + Vec3(32.0,  0.0, 0.0));
+                points.push_back(origin + Vec3( 0.0, 32.0, 0.0));
+                points.push_back(origin + Vec3(32.0, 32.0, 0.0));
+                
+                switch (i % 3) {
+                    case 0:
+                        points.push_back(origin + Vec3( 0.0,  0.0, 32.0));
+                        points.push_back(origin + Vec3(32.0,  0.0, 32.0));
+                        points.push_back(origin + Vec3( 0.0, 32.0, 32.0));
+                        points.push_back(origin + Vec3(32.0, 32.0, 32.0));
+                        break;
+                    case 1:
+                        points.push_back(origin + Vec3( 0.0,  0.0, 32.0));
+                        points.push_back(origin + Vec3( 0.0, 32.0, 32.0));
+                        break;
+                    default:
+                        points.push_back(origin + Vec3(16.0, 16.0, 32.0));
+                        break;
+                }
+                
+                brushes.push_back(builder.createBrush(points, "texture"));
+            }
+            return brushes;
+        }
+        
+        static void upload(const Model::BrushList& brushes, RenderContext& renderContext) {
+            Vbo vertexVbo(0xFFFFFF);
+            Vbo indexVbo(0xFFFFF, GL_ELEMENT_ARRAY_BUFFER);
+            
+            BrushRenderer renderer(false);
+            renderer.setBrushes(brushes);
+            
+            RenderBatch renderBatch(vertexVbo, indexVbo);
+            renderer.render(renderContext, renderBatch);
+            renderBatch.prepare();
+        }
+        
+        static void render(BrushRenderer& renderer, RenderContext& renderContext, Vbo& vertexVbo, Vbo& indexVbo) {
+            // rendering only validates the renderer since the batch is never rendered
+            RenderBatch renderBatch(vertexVbo, indexVbo);
+            renderer.render(renderContext, renderBatch);
+        }
+        
+        static void assertRebuilt(const Model::BrushList& expected, RebuildCounts& counts) {
+            ASSERT_EQ(expected.size(), counts.size());
+            for (const Model::Brush* brush : expected)
+                ASSERT_EQ(1u, counts[brush]);
+            counts.clear();
+        }
+        
+        TEST(BrushRendererTest, rebuildOnlyInvalidBrushes) {
+            testing::NiceMock<GLMock> glMock;
+            
+            const BBox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, NULL, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+            
+            const size_t brushCount = 64;
+            const size_t brushesPerRow = 8;
+            
+            Model::BrushList brushes;
+            for (size_t i = 0; i < brushCount; ++i) {
+                const Vec3 min(static_cast<FloatType>(i % brushesPerRow) * 64.0, static_cast<FloatType>(i / brushesPerRow) * 64.0, 0.0);
+                brushes.push_back(builder.createCuboid(BBox3(min, min + Vec3(32.0, 32.0, 32.0)), "texture"));
+            }
+            
+            PerspectiveCamera camera;
+            FontManager fontManager;
+            ShaderManager shaderManager;
+            RenderContext renderContext(RenderContext::RenderMode_3D, camera, fontManager, shaderManager);
+            
+            Vbo vertexVbo(0xFFFFFF);
+            Vbo indexVbo(0xFFFFF, GL_ELEMENT_ARRAY_BUFFER);
+            
+            std::mutex mutex;
+            RebuildCounts counts;
+            BrushRenderer renderer(CountingFilter(mutex, counts));
+            renderer.setBrushes(brushes);
+            
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            assertRebuilt(brushes, counts);
+            
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            assertRebuilt(Model::BrushList(), counts);
+            
+            const Model::BrushList invalid(std::begin(brushes) + 8, std::begin(brushes) + 24);
+            renderer.invalidateBrushes(invalid);
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            assertRebuilt(invalid, counts);
+            
+            Model::Brush* added = builder.createCuboid(BBox3(Vec3(0.0, 0.0, 128.0), Vec3(32.0, 32.0, 160.0)), "texture");
+            renderer.addBrushes(Model::BrushList(1, added));
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            assertRebuilt(Model::BrushList(1, added), counts);
+            brushes.push_back(added);
+            
+            renderer.invalidate();
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            assertRebuilt(brushes, counts);
+            
+            renderer.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+        
+        TEST(BrushRendererTest, parallelRebuildMatchesSerialRebuild) {
+            testing::NiceMock<GLMock> glMock;
+            BufferCapture capture(glMock);
+            
+            const BBox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, NULL, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+            Model::BrushList brushes = createBrushes(builder, 600);
+            
+            PerspectiveCamera camera;
+            FontManager fontManager;
+            ShaderManager shaderManager;
+            RenderContext renderContext(RenderContext::RenderMode_3D, camera, fontManager, shaderManager);
+            
+            {
+                ParallelUtils::SerialScope serial;
+                upload(brushes, renderContext);
+            }
+            const Buffer serialVertices = capture.buffer(GL_ARRAY_BUFFER);
+            const Buffer serialIndices = capture.buffer(GL_ELEMENT_ARRAY_BUFFER);
+            ASSERT_FALSE(serialVertices.empty());
+            ASSERT_FALSE(serialIndices.empty());
+            
+            capture.clear();
+            upload(brushes, renderContext);
+            ASSERT_EQ(serialVertices, capture.buffer(GL_ARRAY_BUFFER));
+            ASSERT_EQ(serialIndices, capture.buffer(GL_ELEMENT_ARRAY_BUFFER));
+            
+            VectorUtils::clearAndDelete(brushes);
+        }
+        
+        // prints the time it takes to build and to fully rebuild the renderer for a map with 100k faces
+        TEST(BrushRendererTest, DISABLED_benchmarkRebuild) {
+            testing::NiceMock<GLMock> glMock;
+            
+            const BBox3 worldBounds(8192.0);
+            Model::World world(Model::MapFormat::Standard, NULL, worldBounds);
+            Model::BrushBuilder builder(&world, worldBounds);
+            
+            // cubes have six faces each
+            const size_t brushCount = 100000 / 6;
+            const size_t brushesPerRow = 128;
+            
+            Model::BrushList brushes;
+            for (size_t i = 0; i < brushCount; ++i) {
+                const Vec3 min(static_cast<FloatType>(i % brushesPerRow) * 64.0, static_cast<FloatType>(i / brushesPerRow) * 64.0, 0.0);
+                brushes.push_back(builder.createCuboid(BBox3(min, min + Vec3(32.0, 32.0, 32.0)), "texture"));
+            }
+            
+            PerspectiveCamera camera;
+            FontManager fontManager;
+            ShaderManager shaderManager;
+            RenderContext renderContext(RenderContext::RenderMode_3D, camera, fontManager, shaderManager);
+            
+            Vbo vertexVbo(0xFFFFFF);
+            Vbo indexVbo(0xFFFFF, GL_ELEMENT_ARRAY_BUFFER);
+            
+            BrushRenderer renderer(false);
+            renderer.setBrushes(brushes);
+            
+            Clock::time_point start = Clock::now();
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            const double build = elapsed(start);
+            
+            renderer.invalidate();
+            start = Clock::now();
+            render(renderer, renderContext, vertexVbo, indexVbo);
+            const double rebuild = elapsed(start);
+            
+            std::cout << "Brush renderer with " << 6 * brushCount << " faces:" << std::endl;
+            std::cout << "  build:   " << build << "ms" << std::endl;
+            std::cout << "  rebuild: " << rebuild << "ms" << std::endl;
+            
+            renderer.clear();
+            VectorUtils::clearAndDelete(brushes);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TrenchBroom.h"
+#include "VecMath.h"
+#include "Model/AABBTree.h"
+#include "Renderer/PerspectiveCamera.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        typedef Model::AABBTree<FloatType, int> Tree;
+        
+        static Plane3::List frustumPlanes(const Camera& camera) {
+            Plane3f top, right, bottom, left;
+            camera.frustumPlanes(top, right, bottom, left);
+            
+            Plane3::List planes;
+            planes.push_back(Plane3(top));
+            planes.push_back(Plane3(right));
+            planes.push_back(Plane3(bottom));
+            planes.push_back(Plane3(left));
+            return planes;
+        }
+        
+        static std::vector<int> cull(const Tree& tree, const Camera& camera) {
+            std::vector<int> result = tree.findObjects(frustumPlanes(camera));
+            std::sort(std::begin(result), std::end(result));
+            return result;
+        }
+        
+        TEST(PerspectiveCameraTest, cullAABBTreeWithFrustumPlanes) {
+            Tree tree(BBox3(8192.0));
+            tree.addObject(BBox3(Vec3(100.0,   -8.0,   -8.0), Vec3(116.0,    8.0,    8.0)), 1); // in front
+            tree.addObject(BBox3(Vec3(-116.0,  -8.0,   -8.0), Vec3(-100.0,   8.0,    8.0)), 2); // behind
+            tree.addObject(BBox3(Vec3(100.0, 1000.0,   -8.0), Vec3(116.0, 1016.0,    8.0)), 3); // left of the frustum
+            tree.addObject(BBox3(Vec3(100.0,   -8.0, 1000.0), Vec3(116.0,    8.0, 1016.0)), 4); // above the frustum
+            tree.addObject(BBox3(Vec3(100.0,  -8.0, -1016.0), Vec3(116.0,    8.0, -1000.0)), 5); // below the frustum
+            tree.addObject(BBox3(Vec3(500.0, 1000.0,   -8.0), Vec3(2000.0, 1016.0,   8.0)), 6); // intersects the left plane
+            
+            PerspectiveCamera camera(90.0f, 1.0f, 8000.0f, Camera::Viewport(0, 0, 1024, 768), Vec3f::Null, Vec3f::PosX, Vec3f::PosZ);
+            
+            std::vector<int> expected;
+            expected.push_back(1);
+            expected.push_back(6);
+            ASSERT_EQ(expected, cull(tree, camera));
+            
+            // turning the camera around swaps what is visible
+            camera.setDirection(Vec3f::NegX, Vec3f::PosZ);
+            
+            expected.clear();
+            expected.push_back(2);
+            ASSERT_EQ(expected, cull(tree, camera));
+            
+            // boxes that move into the frustum are found once the tree is updated
+            tree.updateObject(BBox3(Vec3(-116.0, -8.0, 16.0), Vec3(-100.0, 8.0, 32.0)), 4);
+            
+            expected.push_back(4);
+            ASSERT_EQ(expected, cull(tree, camera));
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "View/CommandProcessor.h"
+#include "View/MapDocumentCommandFacade.h"
+#include "View/MapDocumentTest.h"
+#include "View/UndoableCommand.h"
+
+namespace TrenchBroom {
+    namespace View {
+        class CommandProcessorTest : public MapDocumentTest {};
+        
+        class TestCommand : public UndoableCommand {
+        public:
+            static const CommandType Type;
+        private:
+            size_t m_memorySize;
+        public:
+            TestCommand(const String& name, const size_t memorySize) :
+            UndoableCommand(Type, name),
+            m_memorySize(memorySize) {}
+        private:
+            bool doPerformDo(MapDocumentCommandFacade* document)   { return true; }
+            bool doPerformUndo(MapDocumentCommandFacade* document) { return true; }
+            bool doIsRepeatable(MapDocumentCommandFacade* document) const { return false; }
+            bool doCollateWith(UndoableCommand::Ptr command) { return false; }
+            size_t doGetMemorySize() const { return m_memorySize; }
+        };
+        
+        const Command::CommandType TestCommand::Type = Command::freeType();
+        
+        // keeps undo information only while it is done, like the commands which take snapshots
+        class SnapshotTestCommand : public UndoableCommand {
+        public:
+            static const CommandType Type;
+        private:
+            size_t m_snapshotSize;
+            size_t m_memorySize;
+        public:
+            SnapshotTestCommand(const String& name, const size_t snapshotSize) :
+            UndoableCommand(Type, name),
+            m_snapshotSize(snapshotSize),
+            m_memorySize(0) {}
+        private:
+            bool doPerformDo(MapDocumentCommandFacade* document)   { m_memorySize = m_snapshotSize; return true; }
+            bool doPerformUndo(MapDocumentCommandFacade* document) { m_memorySize = 0; return true; }
+            bool doIsRepeatable(MapDocumentCommandFacade* document) const { return false; }
+            
+            bool doCollateWith(UndoableCommand::Ptr command) {
+                const SnapshotTestCommand* other = static_cast<SnapshotTestCommand*>(command.get());
+                m_snapshotSize += other->m_snapshotSize;
+                m_memorySize += other->m_memorySize;
+                return true;
+            }
+            
+            size_t doGetMemorySize() const { return m_memorySize; }
+        };
+        
+        const Command::CommandType SnapshotTestCommand::Type = Command::freeType();
+        
+        class NoUndoInformationCommand : public UndoableCommand {
+        public:
+            static const CommandType Type;
+        public:
+            NoUndoInformationCommand() :
+            UndoableCommand(Type, "no undo information") {}
+        private:
+            bool doPerformDo(MapDocumentCommandFacade* document)   { return true; }
+            bool doPerformUndo(MapDocumentCommandFacade* document) { return true; }
+            bool doIsRepeatable(MapDocumentCommandFacade* document) const { return false; }
+            bool doCollateWith(UndoableCommand::Ptr command) { return false; }
+        };
+        
+        const Command::CommandType NoUndoInformationCommand::Type = Command::freeType();
+        
+        TEST_F(CommandProcessorTest, enforceMemoryBudget) {
+            CommandProcessor processor(static_cast<MapDocumentCommandFacade*>(document.get()));
+            processor.setMemoryBudget(1000);
+            
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("first", 400))));
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("second", 400))));
+            ASSERT_EQ(800u, processor.memoryUsage());
+            
+            // the oldest command is discarded
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("third", 400))));
+            ASSERT_EQ(800u, processor.memoryUsage());
+            ASSERT_EQ(String("third"), processor.lastCommandName());
+            
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_FALSE(processor.hasLastCommand());
+            ASSERT_EQ(800u, processor.memoryUsage());
+            
+            // the last command remains undoable even if it exceeds the budget on its own
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("huge", 5000))));
+            ASSERT_TRUE(processor.hasLastCommand());
+            ASSERT_EQ(5000u, processor.memoryUsage());
+        }
+        
+        TEST_F(CommandProcessorTest, enforceMemoryBudgetOnUndoStackOnly) {
+            CommandProcessor processor(static_cast<MapDocumentCommandFacade*>(document.get()));
+            
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("first", 400))));
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("second", 400))));
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("third", 400))));
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_TRUE(processor.undoLastCommand());
+            processor.setMemoryBudget(1000);
+            
+            // the commands on the redo stack do not cause commands to be discarded from the undo stack
+            ASSERT_TRUE(processor.redoNextCommand());
+            ASSERT_EQ(1200u, processor.memoryUsage());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_FALSE(processor.hasLastCommand());
+            
+            ASSERT_TRUE(processor.redoNextCommand());
+            ASSERT_TRUE(processor.redoNextCommand());
+            ASSERT_TRUE(processor.redoNextCommand());
+            ASSERT_EQ(800u, processor.memoryUsage());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_FALSE(processor.hasLastCommand());
+        }
+        
+        TEST_F(CommandProcessorTest, trackMemoryUsage) {
+            CommandProcessor processor(static_cast<MapDocumentCommandFacade*>(document.get()));
+            
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("first", 100))));
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new SnapshotTestCommand("second", 300))));
+            ASSERT_EQ(400u, processor.memoryUsage());
+            
+            // collating with the last command changes its memory size
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new SnapshotTestCommand("third", 200))));
+            ASSERT_EQ(String("second"), processor.lastCommandName());
+            ASSERT_EQ(600u, processor.memoryUsage());
+            
+            // an undone command releases its snapshot
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_EQ(100u, processor.memoryUsage());
+            
+            ASSERT_TRUE(processor.redoNextCommand());
+            ASSERT_EQ(600u, processor.memoryUsage());
+            
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_TRUE(processor.undoLastCommand());
+            ASSERT_EQ(100u, processor.memoryUsage());
+            
+            // submitting a command clears the redo stack
+            ASSERT_TRUE(processor.submitAndStoreCommand(UndoableCommand::Ptr(new TestCommand("fourth", 50))));
+            ASSERT_EQ(50u, processor.memoryUsage());
+            
+            processor.clear();
+            ASSERT_EQ(0u, processor.memoryUsage());
+        }
+        
+        TEST_F(CommandProcessorTest, commandWithoutUndoInformationUsesMemory) {
+            CommandProcessor processor(static_cast<MapDocumentCommandFacade*>(document.get()));
+            
+            const UndoableCommand::Ptr command(new NoUndoInformationCommand());
+            ASSERT_LT(0u, command->memorySize());
+            
+            ASSERT_TRUE(processor.submitAndStoreCommand(command));
+            ASSERT_EQ(command->memorySize(), processor.memoryUsage());
+        }
+    }
+}
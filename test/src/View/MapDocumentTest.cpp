@@ -24,6 +24,7 @@
 #include "Model/Brush.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushBuilder.h"
+#include "Model/Entity.h"
 #include "Model/MapFormat.h"
 #include "Model/TestGame.h"
 #include "Model/World.h"
@@ -135,5 +136,92 @@ namespace TrenchBroom {
             ASSERT_EQ(brush1ExpectedBounds, brush1->bounds());
             ASSERT_EQ(brush2ExpectedBounds, brush2->bounds());
         }
+        
+        TEST_F(MapDocumentTest, undoRotate) {
+            Model::BrushBuilder builder(document->world(), document->worldBounds());
+            Model::Brush* brush = builder.createCuboid(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(30.0, 31.0, 31.0)), "texture");
+            brush->faces().front()->setXOffset(8.0f);
+            document->addNode(brush, document->currentParent());
+            document->select(brush);
+            
+            Model::Brush* original = static_cast<Model::Brush*>(brush->clone(document->worldBounds()));
+            
+            document->rotateObjects(Vec3(7.0, 3.0, 0.0), Vec3::PosZ, Math::radians(33.0));
+            ASSERT_NE(original->bounds(), brush->bounds());
+            
+            document->undoLastCommand();
+            ASSERT_EQ(original->bounds(), brush->bounds());
+            ASSERT_EQ(original->faceCount(), brush->faceCount());
+            for (size_t i = 0; i < brush->faceCount(); ++i) {
+                const Model::BrushFace* originalFace = original->faces()[i];
+                const Model::BrushFace* face = brush->faces()[i];
+                for (size_t j = 0; j < 3; ++j)
+                    ASSERT_VEC_EQ(originalFace->points()[j], face->points()[j]);
+                ASSERT_EQ(originalFace->textureName(), face->textureName());
+                ASSERT_FLOAT_EQ(originalFace->xOffset(), face->xOffset());
+                ASSERT_FLOAT_EQ(originalFace->yOffset(), face->yOffset());
+                ASSERT_FLOAT_EQ(originalFace->rotation(), face->rotation());
+                ASSERT_VEC_EQ(originalFace->textureXAxis(), face->textureXAxis());
+                ASSERT_VEC_EQ(originalFace->textureYAxis(), face->textureYAxis());
+            }
+            
+            delete original;
+        }
+        
+        class SelectByBrushVolumeTest : public MapDocumentTest {
+        protected:
+            Model::Brush* volume;
+            Model::Brush* inside;
+            Model::Brush* touching;
+            Model::Brush* outside;
+            Model::Brush* entityBrush;
+            
+            void SetUp() {
+                MapDocumentTest::SetUp();
+                
+                Model::BrushBuilder builder(document->world(), document->worldBounds());
+                volume = builder.createCuboid(BBox3(Vec3(0.0, 0.0, 0.0), Vec3(64.0, 64.0, 64.0)), "texture");
+                inside = builder.createCuboid(BBox3(Vec3(16.0, 16.0, 16.0), Vec3(32.0, 32.0, 32.0)), "texture");
+                touching = builder.createCuboid(BBox3(Vec3(48.0, 48.0, 48.0), Vec3(80.0, 80.0, 80.0)), "texture");
+                outside = builder.createCuboid(BBox3(Vec3(128.0, 128.0, 128.0), Vec3(160.0, 160.0, 160.0)), "texture");
+                entityBrush = builder.createCuboid(BBox3(Vec3(60.0, 0.0, 0.0), Vec3(70.0, 8.0, 8.0)), "texture");
+                
+                document->addNode(volume, document->currentParent());
+                document->addNode(inside, document->currentParent());
+                document->addNode(touching, document->currentParent());
+                document->addNode(outside, document->currentParent());
+                
+                Model::Entity* entity = new Model::Entity();
+                document->addNode(entity, document->currentParent());
+                document->addNode(entityBrush, entity);
+                
+                document->select(volume);
+            }
+            
+            Model::BrushSet selectedBrushes() const {
+                const Model::BrushList& brushes = document->selectedNodes().brushes();
+                return Model::BrushSet(std::begin(brushes), std::end(brushes));
+            }
+        };
+        
+        TEST_F(SelectByBrushVolumeTest, selectTouching) {
+            document->selectTouching(false);
+            
+            Model::BrushSet expected;
+            expected.insert(inside);
+            expected.insert(touching);
+            expected.insert(entityBrush);
+            ASSERT_EQ(expected, selectedBrushes());
+            ASSERT_FALSE(volume->selected());
+        }
+        
+        TEST_F(SelectByBrushVolumeTest, selectInside) {
+            document->selectInside(false);
+            
+            Model::BrushSet expected;
+            expected.insert(inside);
+            ASSERT_EQ(expected, selectedBrushes());
+            ASSERT_FALSE(volume->selected());
+        }
     }
 }
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2010-2016 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/Hit.h"
+#include "Model/MapFormat.h"
+#include "Model/PickResult.h"
+#include "Model/World.h"
+#include "Renderer/PerspectiveCamera.h"
+#include "View/VertexHandleManager.h"
+#include "View/ViewTypes.h"
+
+namespace TrenchBroom {
+    namespace View {
+        static Model::Hit pickHandle(const VertexHandleManager& manager, const Renderer::Camera& camera, const Vec3& handlePosition, const Model::Hit::HitType type) {
+            const Vec3 origin(camera.position());
+            const Ray3 ray(origin, (handlePosition - origin).normalized());
+            
+            Model::PickResult pickResult;
+            manager.pick(ray, camera, pickResult, false);
+            return pickResult.query().type(type).first();
+        }
+        
+        static void assertHandleHit(const VertexHandleManager& manager, const Renderer::Camera& camera, const Vec3& handlePosition, const Model::Hit::HitType type) {
+            const Model::Hit hit = pickHandle(manager, camera, handlePosition, type);
+            ASSERT_TRUE(hit.isMatch());
+            ASSERT_VEC_EQ(handlePosition, hit.target<Vec3>());
+        }
+        
+        static void assertNoHandleHit(const VertexHandleManager& manager, const Renderer::Camera& camera, const Vec3& handlePosition, const Model::Hit::HitType type) {
+            ASSERT_FALSE(pickHandle(manager, camera, handlePosition, type).isMatch());
+        }
+        
+        class VertexHandleManagerTest : public ::testing::Test {
+        protected:
+            BBox3 worldBounds;
+            Model::World* world;
+            Model::Brush* brush;
+            Renderer::PerspectiveCamera camera;
+        protected:
+            void SetUp() {
+                worldBounds = BBox3(8192.0);
+                world = new Model::World(Model::MapFormat::Standard, NULL, worldBounds);
+                
+                // a cube with its vertices at +/-32
+                const Model::BrushBuilder builder(world, worldBounds);
+                brush = builder.createCube(64.0, "texture");
+                
+                camera.moveTo(Vec3f(128.0f, -256.0f, 96.0f));
+                camera.lookAt(Vec3f::Null, Vec3f::PosZ);
+            }
+            
+            void TearDown() {
+                delete brush;
+                delete world;
+            }
+        };
+        
+        TEST_F(VertexHandleManagerTest, pickHandles) {
+            VertexHandleManager manager((MapDocumentWPtr()));
+            manager.addBrush(brush);
+            
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            assertHandleHit(manager, camera, Vec3(0.0, -32.0, 0.0), VertexHandleManager::FaceHandleHit);
+            
+            // there is no vertex at an edge center
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::VertexHandleHit);
+        }
+        
+        TEST_F(VertexHandleManagerTest, pickSelectedHandles) {
+            VertexHandleManager manager((MapDocumentWPtr()));
+            manager.addBrush(brush);
+            
+            // selecting a vertex handle moves it to the selected handles and hides the unselected edge and face handles
+            manager.selectVertexHandle(Vec3(32.0, -32.0, 32.0));
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertHandleHit(manager, camera, Vec3(-32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(0.0, -32.0, 0.0), VertexHandleManager::FaceHandleHit);
+            
+            // and deselecting it moves it back
+            manager.deselectVertexHandle(Vec3(32.0, -32.0, 32.0));
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            
+            manager.selectEdgeHandle(Vec3(32.0, -32.0, 0.0));
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            manager.deselectAllHandles();
+            
+            manager.selectFaceHandle(Vec3(0.0, -32.0, 0.0));
+            assertHandleHit(manager, camera, Vec3(0.0, -32.0, 0.0), VertexHandleManager::FaceHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+        }
+        
+        TEST_F(VertexHandleManagerTest, pickRemovedHandles) {
+            VertexHandleManager manager((MapDocumentWPtr()));
+            manager.addBrush(brush);
+            manager.selectVertexHandle(Vec3(32.0, -32.0, 32.0));
+            manager.removeBrush(brush);
+            
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(-32.0, -32.0, 32.0), VertexHandleManager::VertexHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(0.0, -32.0, 0.0), VertexHandleManager::FaceHandleHit);
+        }
+        
+        TEST_F(VertexHandleManagerTest, pickMovedHandles) {
+            VertexHandleManager manager((MapDocumentWPtr()));
+            manager.addBrush(brush);
+            
+            manager.removeBrush(brush);
+            brush->transform(translationMatrix(Vec3(0.0, 0.0, 64.0)), false, worldBounds);
+            manager.addBrush(brush);
+            
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, -32.0), VertexHandleManager::VertexHandleHit);
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 96.0), VertexHandleManager::VertexHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(32.0, -32.0, 0.0), VertexHandleManager::EdgeHandleHit);
+            assertHandleHit(manager, camera, Vec3(32.0, -32.0, 64.0), VertexHandleManager::EdgeHandleHit);
+            assertNoHandleHit(manager, camera, Vec3(0.0, -32.0, 0.0), VertexHandleManager::FaceHandleHit);
+            assertHandleHit(manager, camera, Vec3(0.0, -32.0, 64.0), VertexHandleManager::FaceHandleHit);
+        }
+    }
+}